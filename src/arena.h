@@ -1,3 +1,6 @@
+#ifndef sql_arena
+#define sql_arena
+
 #include <stddef.h>
 
 #define MAX_ALIGN ((size_t)_Alignof(max_align_t))
@@ -18,4 +21,6 @@ struct ArenaAllocator arena_new(size_t size);
 void arena_free(struct ArenaAllocator *arena);
 void arena_reset(struct ArenaAllocator *arena);
 void *arena_alloc_aligned(struct ArenaAllocator *arena, size_t size, size_t alignment);
-void *arena_alloc_aligned_checked(struct ArenaAllocator *arena, size_t size, size_t alignment);
\ No newline at end of file
+void *arena_alloc_aligned_checked(struct ArenaAllocator *arena, size_t size, size_t alignment);
+
+#endif
@@ -37,6 +37,11 @@ void print_expr_binary_to_stderr(struct ExprBinary *binary, int padding) {
     print_expression_to_stderr(binary->left, padding + 8);
     fprintf(stderr, "%*sRight\n", padding + 4, "");
     print_expression_to_stderr(binary->right, padding + 8);
+
+    if (binary->upper != NULL) {
+        fprintf(stderr, "%*sUpper\n", padding + 4, "");
+        print_expression_to_stderr(binary->upper, padding + 8);
+    }
 }
 
 void print_expr_string_to_stderr(struct ExprString *string, int padding) {
@@ -125,6 +130,23 @@ void print_select_statement_to_stderr(struct SelectStatement *stmt, int padding)
         print_expression_list_to_stderr(stmt->where_list, padding + 4);
     }
 
+    if (stmt->group_by_list != NULL) {
+        fprintf(stderr, "%*sGroup By\n", padding, "");
+        print_expression_list_to_stderr(stmt->group_by_list, padding + 4);
+    }
+
+    if (stmt->order_by_list != NULL) {
+        fprintf(stderr, "%*sOrder By\n", padding, "");
+        for (size_t i = 0; i < stmt->order_by_list->count; i++) {
+            print_expression_to_stderr(&stmt->order_by_list->data[i], padding + 4);
+            fprintf(stderr, "%*s%s\n", padding + 4, "", stmt->order_by_sort->data[i] == SORT_DESC ? "DESC" : "ASC");
+        }
+    }
+
+    if (stmt->limit >= 0) {
+        fprintf(stderr, "%*sLimit %lld Offset %lld\n", padding, "", (long long)stmt->limit, (long long)stmt->offset);
+    }
+
     fprintf(stderr, "\n\nPrinting Complete\n\n");
 }
 
@@ -154,6 +176,9 @@ void get_column_from_expression(struct Expr *expr, struct HashMap *columns) {
         case EXPR_BINARY:
             get_column_from_expression(expr->binary.left, columns);
             get_column_from_expression(expr->binary.right, columns);
+            if (expr->binary.upper != NULL) {
+                get_column_from_expression(expr->binary.upper, columns);
+            }
             break;
 
         case EXPR_UNARY:
@@ -365,6 +390,18 @@ void print_new_binary_expr_to_stderr(struct NewExprBinary *binary, int padding)
             fprintf(stderr, "%*sOp: Greater\n", padding + 4, "");
             break;
 
+        case BIN_LESS_EQUAL:
+            fprintf(stderr, "%*sOp: Less Equal\n", padding + 4, "");
+            break;
+
+        case BIN_GREATER_EQUAL:
+            fprintf(stderr, "%*sOp: Greater Equal\n", padding + 4, "");
+            break;
+
+        case BIN_BETWEEN:
+            fprintf(stderr, "%*sOp: Between\n", padding + 4, "");
+            break;
+
         default:
             fprintf(stderr, "%*sOp: Unknown\n", padding + 4, "");
             exit(1);
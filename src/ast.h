@@ -43,7 +43,11 @@ struct ExprColumn {
 };
 
 enum AggType {
-    AGG_COUNT
+    AGG_COUNT,
+    AGG_SUM,
+    AGG_MIN,
+    AGG_MAX,
+    AGG_AVG
 };
 
 struct ExprFunction {
@@ -56,11 +60,15 @@ enum BinaryOp {
     BIN_EQUAL,
     BIN_LESS,
     BIN_GREATER,
+    BIN_LESS_EQUAL,
+    BIN_GREATER_EQUAL,
+    BIN_BETWEEN,
 };
 
 struct ExprBinary {
     struct Expr     *left;
     struct Expr     *right;
+    struct Expr     *upper;     // Only for BIN_BETWEEN: left BETWEEN right AND upper
     enum BinaryOp   op;
 };
 
@@ -90,6 +98,13 @@ struct Expr {
 DEFINE_VECTOR(struct Expr, ExprList, expr_list)
 DEFINE_VECTOR(struct ExprBinary, BinaryExprList, binary_expr_list)
 
+enum SortType {
+    SORT_ASC,
+    SORT_DESC
+};
+
+DEFINE_VECTOR(enum SortType, SortTypeList, sort_type_list)
+
 // Select Statement
 enum StatementType {
     STMT_SELECT
@@ -105,6 +120,11 @@ struct SelectStatement {
     char            *from_table;
     struct ExprList *select_list;
     struct ExprList *where_list;
+    struct ExprList *group_by_list;     // NULL without a GROUP BY
+    struct ExprList *order_by_list;     // NULL without an ORDER BY
+    struct SortTypeList *order_by_sort; // Direction of each ORDER BY term
+    int64_t         limit;              // -1 without a LIMIT
+    int64_t         offset;             // 0 without an OFFSET
 };
 
 // From statement
@@ -179,11 +199,6 @@ struct NewExprBind {
     bool tag;
 };
 
-enum SortType {
-    SORT_ASC,
-    SORT_DESC
-};
-
 enum CollationType {
     COLLATE_NONE
 };
@@ -0,0 +1,429 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "ast.h"
+#include "btree_cursor.h"
+#include "comparisons.h"
+#include "data_parsing/byte_reader.h"
+#include "data_parsing/page_parsing.h"
+#include "data_parsing/cell_parsing.h"
+#include "data_parsing/row_parsing.h"
+
+#define READAHEAD_BATCH_SIZE (32)
+
+// The frames from 0 to depth - 1 are the path from the root to the page under the cursor.
+// Every frame on the path holds a pin, so cells and payloads can be read in place.
+//
+// On interior frames index is the child currently being visited. For an index b-tree
+// the entry in interior cell i sits between child i and child i + 1, so when the cursor
+// climbs back out of child i it stops on cell i before moving on to child i + 1.
+
+static inline struct CursorFrame *top_frame(struct BTreeCursor *cursor) {
+    return &cursor->frames[cursor->depth - 1];
+}
+
+static inline bool is_interior_page(enum PageType page_type) {
+    return page_type == PAGE_INTERIOR_TABLE || page_type == PAGE_INTERIOR_INDEX;
+}
+
+static void push_frame(struct BTreeCursor *cursor, uint32_t page_number) {
+    if (cursor->depth == BTREE_MAX_DEPTH) {
+        fprintf(stderr, "push_frame: b-tree rooted at page %u is deeper than %d\n", cursor->root_page, BTREE_MAX_DEPTH);
+        exit(1);
+    }
+
+    if (page_number == 0 || page_number > cursor->pager->page_count) {
+        fprintf(stderr, "push_frame: page %u exceeds max %u.\n", page_number, cursor->pager->page_count);
+        exit(1);
+    }
+
+    struct CursorFrame *frame = &cursor->frames[cursor->depth];
+    page_view_open(cursor->pager, &frame->view, page_number);
+    frame->index            = 0;
+    frame->prefetched_index = 0;
+    cursor->depth++;
+
+    if (frame->view.header.page_type == PAGE_INVALID) {
+        fprintf(stderr, "push_frame: page %u is not a b-tree page.\n", page_number);
+        exit(1);
+    }
+}
+
+static void pop_frame(struct BTreeCursor *cursor) {
+    page_view_release(&top_frame(cursor)->view);
+    cursor->depth--;
+}
+
+static void reset_cursor(struct BTreeCursor *cursor) {
+    while (cursor->depth > 0) {
+        pop_frame(cursor);
+    }
+
+    cursor->valid = false;
+}
+
+static uint32_t child_page(struct CursorFrame *frame, uint16_t index) {
+    // Interior table and index cells both start with the left child pointer
+    if (index == frame->view.header.number_of_cells) {
+        return frame->view.header.right_most_pointer;
+    }
+
+    return read_u32_big_endian(frame->view.page->data, page_view_cell_offset(&frame->view, index));
+}
+
+static uint64_t table_cell_key(struct CursorFrame *frame, uint16_t index) {
+    // Interior cells hold the largest rowid in their left child, leaf cells their own rowid
+    const uint8_t *data = frame->view.page->data + page_view_cell_offset(&frame->view, index);
+    uint64_t bytes_read = 0;
+
+    if (frame->view.header.page_type == PAGE_INTERIOR_TABLE) {
+        return read_varint(data + 4, &bytes_read);
+    }
+
+    read_varint(data, &bytes_read); // Payload size
+    return read_varint(data, &bytes_read);
+}
+
+static void load_cell(struct BTreeCursor *cursor) {
+    struct CursorFrame *frame = top_frame(cursor);
+    read_view_cell(cursor->pager, &frame->view, &cursor->cell, frame->index);
+    cursor->valid = true;
+}
+
+static void prefetch_children(struct BTreeCursor *cursor, struct CursorFrame *frame) {
+    // Hand the readahead_pages children after the one being visited to the pager so the
+    // leaves are already loaded, or at least in the OS page cache, by the time the cursor
+    // reaches them. The cell count is used as the index of the right most pointer.
+    int number_of_cells = frame->view.header.number_of_cells;
+    int first_index = frame->index + 1;
+    int last_index = first_index + (int)cursor->pager->readahead_pages - 1;
+
+    if (last_index > number_of_cells) {
+        last_index = number_of_cells;
+    }
+
+    uint32_t children[READAHEAD_BATCH_SIZE];
+    uint32_t count = 0;
+
+    int index = first_index > frame->prefetched_index ? first_index : frame->prefetched_index;
+    for (; index <= last_index; index++) {
+        children[count++] = child_page(frame, (uint16_t)index);
+
+        if (count == READAHEAD_BATCH_SIZE) {
+            pager_prefetch_pages(cursor->pager, children, count);
+            count = 0;
+        }
+    }
+
+    if (count > 0) {
+        pager_prefetch_pages(cursor->pager, children, count);
+    }
+
+    if (index > frame->prefetched_index) {
+        frame->prefetched_index = (uint16_t)index;
+    }
+}
+
+static bool descend_to_first_entry(struct BTreeCursor *cursor) {
+    // Walk down the left edge of the subtree below the current child of the top frame
+    while (is_interior_page(top_frame(cursor)->view.header.page_type)) {
+        struct CursorFrame *frame = top_frame(cursor);
+
+        if (cursor->readahead && cursor->pager->readahead_pages > 0 && frame->view.header.page_type == PAGE_INTERIOR_TABLE) {
+            prefetch_children(cursor, frame);
+        }
+
+        push_frame(cursor, child_page(frame, frame->index));
+    }
+
+    if (top_frame(cursor)->view.header.number_of_cells == 0) {
+        if (cursor->depth > 1) {
+            fprintf(stderr, "descend_to_first_entry: Expected at least 1 cell on page %u\n", top_frame(cursor)->view.header.page_number);
+            exit(1);
+        }
+
+        // An empty table or index is a root leaf without cells
+        reset_cursor(cursor);
+        return false;
+    }
+
+    load_cell(cursor);
+    return true;
+}
+
+void btree_cursor_init(struct BTreeCursor *cursor, struct Pager *pager, uint32_t root_page) {
+    cursor->pager       = pager;
+    cursor->root_page   = root_page;
+    cursor->readahead   = false;
+    cursor->valid       = false;
+    cursor->depth       = 0;
+
+    row_buffer_init(&cursor->key_buffer);
+}
+
+void btree_cursor_close(struct BTreeCursor *cursor) {
+    reset_cursor(cursor);
+    row_buffer_free(&cursor->key_buffer);
+}
+
+bool btree_cursor_first(struct BTreeCursor *cursor) {
+    reset_cursor(cursor);
+    push_frame(cursor, cursor->root_page);
+    return descend_to_first_entry(cursor);
+}
+
+bool btree_cursor_next(struct BTreeCursor *cursor) {
+    if (!cursor->valid) {
+        return false;
+    }
+
+    struct CursorFrame *frame = top_frame(cursor);
+    frame->index++;
+
+    if (is_interior_page(frame->view.header.page_type)) {
+        // Resting on an index interior entry, the entries after it are in the next child
+        return descend_to_first_entry(cursor);
+    }
+
+    if (frame->index < frame->view.header.number_of_cells) {
+        load_cell(cursor);
+        return true;
+    }
+
+    // Leaf exhausted, climb until a page has something to the right of where we came from
+    while (cursor->depth > 1) {
+        pop_frame(cursor);
+        frame = top_frame(cursor);
+
+        if (frame->index >= frame->view.header.number_of_cells) {
+            // Came back from the right most child
+            continue;
+        }
+
+        if (frame->view.header.page_type == PAGE_INTERIOR_INDEX) {
+            load_cell(cursor);
+            return true;
+        }
+
+        frame->index++;
+        return descend_to_first_entry(cursor);
+    }
+
+    reset_cursor(cursor);
+    return false;
+}
+
+bool btree_cursor_skip(struct BTreeCursor *cursor, uint64_t count) {
+    // Moves a table cursor count rows forward. The rows left on a leaf are stepped over by
+    // its cell count, so only the cell the cursor lands on is read and no row is decoded.
+    while (count > 0 && cursor->valid) {
+        struct CursorFrame *frame = top_frame(cursor);
+        uint64_t rest_of_leaf = frame->view.header.number_of_cells - 1 - frame->index;
+
+        if (frame->view.header.page_type != PAGE_LEAF_TABLE) {
+            fprintf(stderr, "btree_cursor_skip: page %u is not a table leaf.\n", frame->view.header.page_number);
+            exit(1);
+        }
+
+        if (count <= rest_of_leaf) {
+            frame->index += (uint16_t)count;
+            load_cell(cursor);
+            return true;
+        }
+
+        // Onto the last cell, the next step lands on the first row of the next leaf
+        frame->index    = frame->view.header.number_of_cells - 1;
+        count          -= rest_of_leaf + 1;
+        btree_cursor_next(cursor);
+    }
+
+    return cursor->valid;
+}
+
+bool btree_cursor_seek_rowid(struct BTreeCursor *cursor, uint64_t rowid) {
+    // Positions the cursor on the first row with a rowid >= rowid
+    reset_cursor(cursor);
+    push_frame(cursor, cursor->root_page);
+
+    while (true) {
+        struct CursorFrame *frame = top_frame(cursor);
+        enum PageType page_type = frame->view.header.page_type;
+
+        if (page_type != PAGE_INTERIOR_TABLE && page_type != PAGE_LEAF_TABLE) {
+            fprintf(stderr, "btree_cursor_seek_rowid: page %u is not a table page.\n", frame->view.header.page_number);
+            exit(1);
+        }
+
+        // Binary search for the first cell with a key >= rowid
+        uint16_t lo = 0;
+        uint16_t hi = frame->view.header.number_of_cells;
+        while (lo < hi) {
+            uint16_t mid = lo + (hi - lo) / 2;
+
+            if (table_cell_key(frame, mid) >= rowid) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+
+        frame->index = lo;
+
+        if (page_type == PAGE_INTERIOR_TABLE) {
+            push_frame(cursor, child_page(frame, lo));
+            continue;
+        }
+
+        if (lo < frame->view.header.number_of_cells) {
+            load_cell(cursor);
+            return true;
+        }
+
+        if (frame->view.header.number_of_cells == 0) {
+            reset_cursor(cursor);
+            return false;
+        }
+
+        // Every row on this leaf is smaller, the answer is the first row of the next leaf
+        frame->index    = lo - 1;
+        cursor->valid   = true;
+        return btree_cursor_next(cursor);
+    }
+}
+
+bool btree_cursor_advance_to_rowid(struct BTreeCursor *cursor, uint64_t rowid) {
+    // For rowids looked up in ascending order. When rowid is on the leaf under the cursor
+    // the cursor moves along that leaf instead of seeking from the root, so a sorted batch
+    // of lookups searches each leaf once.
+    if (cursor->valid) {
+        struct CursorFrame *frame = top_frame(cursor);
+        uint16_t last = frame->view.header.number_of_cells - 1;
+
+        if (frame->view.header.page_type == PAGE_LEAF_TABLE && table_cell_key(frame, frame->index) <= rowid && table_cell_key(frame, last) >= rowid) {
+            uint16_t lo = frame->index;
+            uint16_t hi = last;
+            while (lo < hi) {
+                uint16_t mid = lo + (hi - lo) / 2;
+
+                if (table_cell_key(frame, mid) >= rowid) {
+                    hi = mid;
+                } else {
+                    lo = mid + 1;
+                }
+            }
+
+            frame->index = lo;
+            load_cell(cursor);
+            return true;
+        }
+    }
+
+    return btree_cursor_seek_rowid(cursor, rowid);
+}
+
+static int compare_entry_key(struct BTreeCursor *cursor, struct CursorFrame *frame, uint16_t index, struct Value *key, uint8_t key_count) {
+    struct Cell cell;
+    struct Row row;
+
+    read_view_cell(cursor->pager, &frame->view, &cell, index);
+    read_cell_into_row_buffer(cursor->pager, frame->view.page->data, &cell, &cursor->key_buffer, NULL, &row);
+
+    if (row.column_count < key_count) {
+        fprintf(stderr, "compare_entry_key: index entry has %llu columns, the key has %u.\n", (unsigned long long)row.column_count, key_count);
+        exit(1);
+    }
+
+    return compare_index_prefix(row.values, key, key_count);
+}
+
+bool btree_cursor_seek_key(struct BTreeCursor *cursor, struct Value *key, uint8_t key_count) {
+    // Positions the cursor on the first index entry whose first key_count columns are >= key
+    reset_cursor(cursor);
+    push_frame(cursor, cursor->root_page);
+
+    while (true) {
+        struct CursorFrame *frame = top_frame(cursor);
+        enum PageType page_type = frame->view.header.page_type;
+
+        if (page_type != PAGE_INTERIOR_INDEX && page_type != PAGE_LEAF_INDEX) {
+            fprintf(stderr, "btree_cursor_seek_key: page %u is not an index page.\n", frame->view.header.page_number);
+            exit(1);
+        }
+
+        uint16_t lo = 0;
+        uint16_t hi = frame->view.header.number_of_cells;
+        while (lo < hi) {
+            uint16_t mid = lo + (hi - lo) / 2;
+
+            if (compare_entry_key(cursor, frame, mid, key, key_count) >= 0) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+
+        frame->index = lo;
+
+        if (page_type == PAGE_INTERIOR_INDEX) {
+            // Equal keys can sit on both sides of cell lo, so the search continues left of it
+            push_frame(cursor, child_page(frame, lo));
+            continue;
+        }
+
+        if (lo < frame->view.header.number_of_cells) {
+            load_cell(cursor);
+            return true;
+        }
+
+        if (frame->view.header.number_of_cells == 0) {
+            reset_cursor(cursor);
+            return false;
+        }
+
+        // Nothing here is large enough, climbing out lands on the parent entry that bounded the search
+        frame->index    = lo - 1;
+        cursor->valid   = true;
+        return btree_cursor_next(cursor);
+    }
+}
+
+uint64_t btree_cursor_rowid(struct BTreeCursor *cursor) {
+    if (!cursor->valid) {
+        fprintf(stderr, "btree_cursor_rowid: cursor is not on an entry.\n");
+        exit(1);
+    }
+
+    if (cursor->cell.type == TABLE_LEAF_CELL) {
+        return cursor->cell.data.table_leaf_cell.row_id;
+    }
+
+    struct Row row;
+    btree_cursor_read_key(cursor, &row);
+    return row.rowid;
+}
+
+void btree_cursor_read_row(struct BTreeCursor *cursor, struct RowBuffer *buffer, const struct ColumnMask *mask, struct Row *row) {
+    if (!cursor->valid) {
+        fprintf(stderr, "btree_cursor_read_row: cursor is not on an entry.\n");
+        exit(1);
+    }
+
+    read_cell_into_row_buffer(cursor->pager, top_frame(cursor)->view.page->data, &cursor->cell, buffer, mask, row);
+}
+
+const uint8_t *btree_cursor_page_data(struct BTreeCursor *cursor) {
+    // The page holding the entry under the cursor, pinned until the cursor leaves it
+    if (!cursor->valid) {
+        fprintf(stderr, "btree_cursor_page_data: cursor is not on an entry.\n");
+        exit(1);
+    }
+
+    return top_frame(cursor)->view.page->data;
+}
+
+void btree_cursor_read_key(struct BTreeCursor *cursor, struct Row *row) {
+    // The row is only valid until the cursor decodes another index entry
+    btree_cursor_read_row(cursor, &cursor->key_buffer, NULL, row);
+}
@@ -0,0 +1,49 @@
+#ifndef sql_btree_cursor
+#define sql_btree_cursor
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "pager.h"
+#include "data_parsing/page_parsing.h"
+#include "data_parsing/cell_parsing.h"
+#include "data_parsing/row_parsing.h"
+
+// SQLite b-trees are no deeper than about 20 levels, even for huge databases
+#define BTREE_MAX_DEPTH (20)
+
+struct CursorFrame {
+    struct PageView     view;               // Keeps the page pinned while it is on the path
+    uint16_t            index;              // Cell under the cursor, on interior pages the child being visited with number_of_cells meaning the right most pointer
+    uint16_t            prefetched_index;   // Children before this index have already been prefetched
+};
+
+// A position in a table or index b-tree. The path from the root is kept in an inline
+// stack of pinned pages, so moving the cursor never allocates.
+// Index b-trees keep entries on interior pages too, so an index cursor can rest on an
+// interior page between the subtrees to either side of that entry.
+struct BTreeCursor {
+    struct Pager        *pager;
+    uint32_t            root_page;
+    bool                readahead;      // Prefetch upcoming children of interior table pages, for scans in rowid order
+    bool                valid;          // Positioned on an entry, cell is that entry
+    uint8_t             depth;
+    struct CursorFrame  frames[BTREE_MAX_DEPTH];
+    struct Cell         cell;
+    struct RowBuffer    key_buffer;     // Index entries are decoded here while seeking
+};
+
+void btree_cursor_init(struct BTreeCursor *cursor, struct Pager *pager, uint32_t root_page);
+void btree_cursor_close(struct BTreeCursor *cursor);
+bool btree_cursor_first(struct BTreeCursor *cursor);
+bool btree_cursor_next(struct BTreeCursor *cursor);
+bool btree_cursor_skip(struct BTreeCursor *cursor, uint64_t count);
+bool btree_cursor_seek_rowid(struct BTreeCursor *cursor, uint64_t rowid);
+bool btree_cursor_advance_to_rowid(struct BTreeCursor *cursor, uint64_t rowid);
+bool btree_cursor_seek_key(struct BTreeCursor *cursor, struct Value *key, uint8_t key_count);
+uint64_t btree_cursor_rowid(struct BTreeCursor *cursor);
+void btree_cursor_read_row(struct BTreeCursor *cursor, struct RowBuffer *buffer, const struct ColumnMask *mask, struct Row *row);
+const uint8_t *btree_cursor_page_data(struct BTreeCursor *cursor);
+void btree_cursor_read_key(struct BTreeCursor *cursor, struct Row *row);
+
+#endif
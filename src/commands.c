@@ -26,8 +26,10 @@ int command_tables(struct Pager *pager) {
     // @TODO: number of tables should be obtained by couting
     // cells on leaf pages
     
-    uint16_t number_of_tables = pager->schema_page_header->number_of_cells;
-    uint16_t *offsets = read_cell_pointer_array(pager, pager->schema_page_header);
+    struct PageView schema_view;
+    page_view_open(pager, &schema_view, 1);
+
+    uint16_t number_of_tables = schema_view.header.number_of_cells;
 
     // Read the cells
     for (int i = 0; i < number_of_tables; i++) {
@@ -36,9 +38,9 @@ int command_tables(struct Pager *pager) {
 
         read_cell_and_schema_record(
             pager,
-            pager->schema_page_header,
+            &schema_view.header,
             &cell,
-            offsets[i],
+            page_view_cell_offset(&schema_view, i),
             &schema_record
         );
 
@@ -46,12 +48,12 @@ int command_tables(struct Pager *pager) {
         free_schema_record(&schema_record);
     }
 
-    free(offsets);
+    page_view_release(&schema_view);
 
     return 0;
 }
 
-int command_sql(struct Pager *pager, const char *command) {
+int command_sql(struct Pager *pager, const char *command, struct PlanConfig *plan_config) {
     fprintf(stderr, "Parsing SQL statement\n");
 
     struct Parser parser;
@@ -69,8 +71,8 @@ int command_sql(struct Pager *pager, const char *command) {
 
     print_new_select_statement_to_stderr(select_stmt_new, 4);
 
-    struct Plan *plan = build_plan(pager, select_stmt);
-    plan_execute(pager, plan);
+    struct Plan *plan = build_plan(pager, select_stmt, plan_config);
+    plan_execute(pager, plan, plan_config);
 
     return 0;
 }
\ No newline at end of file
@@ -2,9 +2,10 @@
 #define sql_commands
 
 #include "pager.h"
+#include "planning/plan.h"
 
 int command_db_info(struct Pager *pager);
 int command_tables(struct Pager *pager);
-int command_sql(struct Pager *pager, const char *command);
+int command_sql(struct Pager *pager, const char *command, struct PlanConfig *plan_config);
 
 #endif
\ No newline at end of file
@@ -20,7 +20,7 @@ bool unterminated_string_equals(const struct UnterminatedString *a, const struct
 bool unterminated_string_less_than(const struct UnterminatedString *a, const struct UnterminatedString *b) {
     size_t length = (a->len <= b->len) ? a->len : b->len;
     int result = strncmp(a->start, b->start, length);
-    if (result != 0) return result;
+    if (result != 0) return result < 0;
     // If result is 0, strings might be equal but we didnt check full length
     // Return true if a is shorter than b
     return a->len < b->len;
@@ -29,7 +29,7 @@ bool unterminated_string_less_than(const struct UnterminatedString *a, const str
 bool unterminated_string_greater_than(const struct UnterminatedString *a, const struct UnterminatedString *b) {
     size_t length = (a->len <= b->len) ? a->len : b->len;
     int result = strncmp(a->start, b->start, length);
-    if (result != 0) return result;
+    if (result != 0) return result > 0;
     // If result is 0, strings might be equal but we didnt check full length
     // Return true if a is longer than b
     return a->len > b->len;
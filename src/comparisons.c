@@ -1,7 +1,19 @@
 #include "ast.h"
+#include "comparisons.h"
 #include "sql_utils.h"
 #include "data_parsing/row_parsing.h"
 
+enum BinaryOp mirror_binary_op(enum BinaryOp op) {
+    // value op column is the same predicate as column mirror_binary_op(op) value
+    switch (op) {
+        case BIN_LESS:          return BIN_GREATER;
+        case BIN_GREATER:       return BIN_LESS;
+        case BIN_LESS_EQUAL:    return BIN_GREATER_EQUAL;
+        case BIN_GREATER_EQUAL: return BIN_LESS_EQUAL;
+        default:                return op;
+    }
+}
+
 struct Value get_predicate_value(struct ExprBinary *predicate) {
     if (predicate->left->type == EXPR_COLUMN && predicate->right->type == EXPR_COLUMN) {
         fprintf(stderr, "get_predicate_value: Currently cannot handle multiple index.\n");
@@ -37,6 +49,9 @@ int compare_values(struct Value *left, struct Value *right) {
     switch (left->type) {
 
         case VALUE_INT:
+            if (right->type == VALUE_FLOAT) {
+                return -compare_values(right, left);
+            }
             if (left->int_value.value == right->int_value.value) return 0;
             if (left->int_value.value < right->int_value.value) return -1;
             return 1;
@@ -54,9 +69,11 @@ int compare_values(struct Value *left, struct Value *right) {
             // NULL == NULL
             return 0;
         
-        case VALUE_FLOAT:
-            fprintf(stderr, "Float currently unsupported.\n");
-            exit(1);
+        case VALUE_FLOAT: {
+            // Integers and floats compare as numbers
+            double other = right->type == VALUE_INT ? (double)right->int_value.value : right->float_value.value;
+            return (left->float_value.value > other) - (left->float_value.value < other);
+        }
 
         default:
             fprintf(stderr, "Unsupported type %d.\n", left->type);
@@ -64,44 +81,199 @@ int compare_values(struct Value *left, struct Value *right) {
     }
 }
 
-bool compare_index_predicate(struct ExprBinary *predicate, struct Value *column_value, struct Value *predicate_value) {
-    // For use with binary search
-    // Return true if hi should come down
-    // Return false if lo should go up
+static int value_type_rank(enum ValueType type) {
+    switch (type) {
+        case VALUE_NULL:    return 0;
+        case VALUE_INT:     return 1;
+        case VALUE_FLOAT:   return 1;
+        case VALUE_TEXT:    return 2;
+        default:            return 3;
+    }
+}
 
-    if (column_value->type != predicate_value->type) {
-        return false;
+int compare_index_key(struct Value *column, struct Value *key) {
+    // Index entries are ordered like SQLite orders them, NULLs first, then numbers, then text
+    int column_rank = value_type_rank(column->type);
+    int key_rank = value_type_rank(key->type);
+
+    if (column_rank != key_rank) {
+        return column_rank < key_rank ? -1 : 1;
+    }
+
+    return compare_values(column, key);
+}
+
+void key_range_init(struct KeyRange *range) {
+    range->lower = (struct KeyBound){ .present = false, .inclusive = false };
+    range->upper = (struct KeyBound){ .present = false, .inclusive = false };
+}
+
+static void tighten_lower(struct KeyRange *range, struct Value *value, bool inclusive) {
+    if (range->lower.present) {
+        int cmp = compare_index_key(value, &range->lower.value);
+        if (cmp < 0 || (cmp == 0 && inclusive)) {
+            return;
+        }
+    }
+
+    range->lower = (struct KeyBound){ .value = *value, .present = true, .inclusive = inclusive };
+}
+
+static void tighten_upper(struct KeyRange *range, struct Value *value, bool inclusive) {
+    if (range->upper.present) {
+        int cmp = compare_index_key(value, &range->upper.value);
+        if (cmp > 0 || (cmp == 0 && inclusive)) {
+            return;
+        }
     }
 
-    bool result = false;
-    int cmp_result = compare_values(column_value, predicate_value);
-    switch (predicate->op) {
+    range->upper = (struct KeyBound){ .value = *value, .present = true, .inclusive = inclusive };
+}
 
+bool key_range_apply(struct KeyRange *range, enum BinaryOp op, struct Value *value, struct Value *upper) {
+    // Narrows the range with "column op value", upper is the second operand of BETWEEN
+    switch (op) {
         case BIN_EQUAL:
-            if (cmp_result >= 0) result = true;
-            break;
+            tighten_lower(range, value, true);
+            tighten_upper(range, value, true);
+            return true;
 
         case BIN_LESS:
-            result = true;
-            break;
+            tighten_upper(range, value, false);
+            return true;
+
+        case BIN_LESS_EQUAL:
+            tighten_upper(range, value, true);
+            return true;
 
         case BIN_GREATER:
-            if (cmp_result <= 0) result = true;
+            tighten_lower(range, value, false);
+            return true;
+
+        case BIN_GREATER_EQUAL:
+            tighten_lower(range, value, true);
+            return true;
+
+        case BIN_BETWEEN:
+            tighten_lower(range, value, true);
+            tighten_upper(range, upper, true);
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+bool key_range_is_empty(struct KeyRange *range) {
+    if (!range->lower.present || !range->upper.present) {
+        return false;
+    }
+
+    int cmp = compare_index_key(&range->lower.value, &range->upper.value);
+    return cmp > 0 || (cmp == 0 && (!range->lower.inclusive || !range->upper.inclusive));
+}
+
+struct Value key_range_start(struct KeyRange *range) {
+    // Where a seek for the range begins. Comparisons only match values of the same type,
+    // so a range without a lower bound starts at the smallest value of the upper bound's type.
+    if (range->lower.present) {
+        return range->lower.value;
+    }
+
+    struct Value start = range->upper.value;
+    switch (start.type) {
+        case VALUE_INT:
+            start.int_value.value = INT64_MIN;
+            break;
+
+        case VALUE_TEXT:
+            start.text_value.text.len = 0;
             break;
 
         default:
-            fprintf(stderr, "compare_index_predicate: Op unsupported %d.\n", predicate->op);
-            exit(1);
+            break;
+    }
+
+    return start;
+}
+
+bool key_below_range(struct KeyRange *range, struct Value *column) {
+    if (range->lower.present) {
+        int cmp = compare_index_key(column, &range->lower.value);
+        return cmp < 0 || (cmp == 0 && !range->lower.inclusive);
+    }
+
+    if (range->upper.present) {
+        return value_type_rank(column->type) < value_type_rank(range->upper.value.type);
+    }
+
+    return false;
+}
+
+bool key_above_range(struct KeyRange *range, struct Value *column) {
+    if (range->upper.present) {
+        int cmp = compare_index_key(column, &range->upper.value);
+        return cmp > 0 || (cmp == 0 && !range->upper.inclusive);
+    }
+
+    if (range->lower.present) {
+        return value_type_rank(column->type) > value_type_rank(range->lower.value.type);
+    }
+
+    return false;
+}
+
+bool key_range_is_point(struct KeyRange *range) {
+    // True when the range holds exactly one key, i.e. it came from an equality
+    return range->lower.present && range->upper.present
+        && range->lower.inclusive && range->upper.inclusive
+        && compare_index_key(&range->lower.value, &range->upper.value) == 0;
+}
+
+int compare_index_prefix(struct Value *columns, struct Value *key, uint8_t key_count) {
+    // Compares the first key_count columns of an index entry with key, column by column
+    for (uint8_t i = 0; i < key_count; i++) {
+        int cmp = compare_index_key(&columns[i], &key[i]);
+        if (cmp != 0) {
+            return cmp;
+        }
+    }
+
+    return 0;
+}
+
+uint8_t index_key_range_start(struct IndexKeyRange *range, struct Value *key) {
+    // Fills key with the seek key for the range and returns its column count
+    for (uint8_t i = 0; i < range->prefix_count; i++) {
+        key[i] = range->prefix[i];
+    }
+
+    if (!range->next.lower.present && !range->next.upper.present) {
+        return range->prefix_count;
+    }
+
+    key[range->prefix_count] = key_range_start(&range->next);
+    return range->prefix_count + 1;
+}
+
+int index_key_range_position(struct IndexKeyRange *range, struct Value *columns) {
+    // -1 when the entry sorts before the range, 1 when after it and 0 when inside
+    int cmp = compare_index_prefix(columns, range->prefix, range->prefix_count);
+    if (cmp != 0) {
+        return cmp < 0 ? -1 : 1;
+    }
+
+    struct Value *column = &columns[range->prefix_count];
 
+    if (key_below_range(&range->next, column)) {
+        return -1;
     }
 
-    if (result) {
-        // fprintf(stderr, "Search to left Comparison result: %d, predicate result: %d\n", cmp_result, result);
-    } else {
-        // fprintf(stderr, "Search to right Comparison result: %d, predicate result: %d\n", cmp_result, result);
+    if (key_above_range(&range->next, column)) {
+        return 1;
     }
 
-    return result;
+    return 0;
 }
 
 // I need a function that will take index constraints
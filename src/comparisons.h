@@ -2,11 +2,50 @@
 #define sql_comparisons
 
 #include "memory.h"
+#include "ast.h"
 #include "data_parsing/row_parsing.h"
 
+// One end of a range of index keys, an absent end is unbounded
+struct KeyBound {
+    struct Value    value;
+    bool            present;
+    bool            inclusive;
+};
+
+// The keys an index range scan visits, ordered like compare_index_key
+struct KeyRange {
+    struct KeyBound lower;
+    struct KeyBound upper;
+};
+
+// Index seeks compare at most this many leading columns
+#define INDEX_KEY_MAX_COLUMNS (8)
+
+// The entries of a composite index a scan visits: equalities on the first prefix_count
+// index columns, then a range on the column after them
+struct IndexKeyRange {
+    struct Value    prefix[INDEX_KEY_MAX_COLUMNS];
+    uint8_t         prefix_count;
+    struct KeyRange next;
+    bool            empty;
+};
+
+enum BinaryOp mirror_binary_op(enum BinaryOp op);
 struct Value get_predicate_value(struct ExprBinary *predicate);
-bool compare_index_predicate(struct ExprBinary *predicate, struct Value *column_value, struct Value *predicate_value);
 int compare_values(struct Value *left, struct Value *right);
+int compare_index_key(struct Value *column, struct Value *key);
+
+void key_range_init(struct KeyRange *range);
+bool key_range_apply(struct KeyRange *range, enum BinaryOp op, struct Value *value, struct Value *upper);
+bool key_range_is_empty(struct KeyRange *range);
+struct Value key_range_start(struct KeyRange *range);
+bool key_below_range(struct KeyRange *range, struct Value *column);
+bool key_above_range(struct KeyRange *range, struct Value *column);
+bool key_range_is_point(struct KeyRange *range);
+
+int compare_index_prefix(struct Value *columns, struct Value *key, uint8_t key_count);
+uint8_t index_key_range_start(struct IndexKeyRange *range, struct Value *key);
+int index_key_range_position(struct IndexKeyRange *range, struct Value *columns);
 
 enum CMP_VALUE_TYPE {
     CMP_COLUMN,
@@ -142,9 +142,8 @@ static void read_index_interior_cell(struct Pager *pager, const uint8_t *data, s
     }
 }
 
-void read_cell(struct Pager *pager, struct PageHeader *page_header, struct Cell *cell, uint16_t cell_offset) {
-    struct Page *page = get_page(pager, page_header->page_number);
-    uint8_t *data = page->data + cell_offset;
+static void parse_cell(struct Pager *pager, struct PageHeader *page_header, const uint8_t *page_data, struct Cell *cell, uint16_t cell_offset) {
+    const uint8_t *data = page_data + cell_offset;
     cell->page_number = page_header->page_number;
     cell->cell_offset = cell_offset;
 
@@ -173,6 +172,15 @@ void read_cell(struct Pager *pager, struct PageHeader *page_header, struct Cell
             fprintf(stderr, "Unknown page type\n");
             exit(1);
     }
+}
 
+void read_cell(struct Pager *pager, struct PageHeader *page_header, struct Cell *cell, uint16_t cell_offset) {
+    struct Page *page = get_page(pager, page_header->page_number);
+    parse_cell(pager, page_header, page->data, cell, cell_offset);
     pager_release_page(page);
-}
\ No newline at end of file
+}
+
+void read_view_cell(struct Pager *pager, struct PageView *view, struct Cell *cell, uint16_t index) {
+    // The view already holds a pin, so the page is not looked up again
+    parse_cell(pager, &view->header, view->page->data, cell, page_view_cell_offset(view, index));
+}
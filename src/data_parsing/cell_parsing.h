@@ -58,4 +58,10 @@ void read_cell(
     struct Cell *cell, 
     uint16_t cell_offset);
 
+void read_view_cell(
+    struct Pager *pager,
+    struct PageView *view,
+    struct Cell *cell,
+    uint16_t index);
+
 #endif
\ No newline at end of file
@@ -30,12 +30,8 @@ static enum PageType byte_to_page_type(uint8_t byte) {
     }
 }
 
-void read_page_header(struct Pager *pager, struct PageHeader *page_header, uint32_t page_number) {
-    // fprintf(stderr, "Reading page number: %d\n", page_number);
-    struct Page *page = get_page(pager, page_number);
+static void parse_page_header(struct PageHeader *page_header, const uint8_t *data, uint32_t page_number) {
     page_header->page_number = page_number;
-    uint8_t *data = page->data;
-
     page_header->start_of_cell_pointer_array = 0;
 
     if (page_number == 1) { // Skip database header if on the first page
@@ -62,37 +58,32 @@ void read_page_header(struct Pager *pager, struct PageHeader *page_header, uint3
     }
 
     page_header->start_of_cell_pointer_array += page_header->header_size;
+}
 
+void read_page_header(struct Pager *pager, struct PageHeader *page_header, uint32_t page_number) {
+    // fprintf(stderr, "Reading page number: %d\n", page_number);
+    struct Page *page = get_page(pager, page_number);
+    parse_page_header(page_header, page->data, page_number);
     pager_release_page(page);
 }
 
-// @TODO: should maybe get passed a pointer to write to instead of malloc in function
-uint16_t *read_cell_pointer_array(struct Pager *pager, struct PageHeader *page_header) {
-    struct Page *page = get_page(pager, page_header->page_number);
+void page_view_open(struct Pager *pager, struct PageView *view, uint32_t page_number) {
+    view->page = get_page(pager, page_number);
 
-    if (!page) {
-        fprintf(stderr, "get_page failed\n");
+    if (!view->page) {
+        fprintf(stderr, "page_view_open: get_page failed\n");
         exit(1);
     }
 
-    uint8_t *data = page->data + page_header->start_of_cell_pointer_array;
-
-    uint16_t *offsets = malloc(page_header->number_of_cells * sizeof(uint16_t));
+    parse_page_header(&view->header, view->page->data, page_number);
+    view->cell_pointers = view->page->data + view->header.start_of_cell_pointer_array;
+}
 
-    if (!offsets) {
-        fprintf(stderr, "read_cell_pointer_array: offsets malloc failed\n");
-        exit(1);
+void page_view_release(struct PageView *view) {
+    if (view->page != NULL) {
+        pager_release_page(view->page);
     }
 
-    for (int i = 0; i < page_header->number_of_cells; i++) {
-        offsets[i] = read_u16_big_endian(data, i * 2);
-    }
-    
-    pager_release_page(page);
-    return offsets;
+    view->page          = NULL;
+    view->cell_pointers = NULL;
 }
-
-uint16_t *read_page_header_and_cell_pointer_array(struct Pager *pager, struct PageHeader *page_header, uint32_t page_number) {
-    read_page_header(pager, page_header, page_number);
-    return read_cell_pointer_array(pager, page_header);
-}
\ No newline at end of file
@@ -34,8 +34,22 @@ struct PageHeader {
     uint64_t            start_of_cell_pointer_array;
 };
 
+// A pinned page and its parsed header. Cell offsets are read in place by index
+// instead of being copied out, so looking at a page allocates nothing.
+// The page stays pinned until page_view_release.
+struct PageView {
+    struct Page         *page;
+    struct PageHeader   header;
+    const uint8_t       *cell_pointers;     // Start of the cell pointer array within page->data
+};
+
 void read_page_header(struct Pager *pager, struct PageHeader *page_header, uint32_t page_number);
-uint16_t *read_cell_pointer_array(struct Pager *pager, struct PageHeader *page_header);
-uint16_t *read_page_header_and_cell_pointer_array(struct Pager *pager, struct PageHeader *page_header, uint32_t page_number);
+void page_view_open(struct Pager *pager, struct PageView *view, uint32_t page_number);
+void page_view_release(struct PageView *view);
+
+static inline uint16_t page_view_cell_offset(const struct PageView *view, uint16_t index) {
+    const uint8_t *pointer = view->cell_pointers + (size_t)index * 2;
+    return (uint16_t)((pointer[0] << 8) | pointer[1]);
+}
 
 #endif
\ No newline at end of file
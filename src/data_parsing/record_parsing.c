@@ -11,9 +11,12 @@
 #include "record_parsing.h"
 #include "row_parsing.h"
 
+// A record's payload, borrowed from its pinned page when it has no overflow pages and
+// copied into a malloc'd block only when it does
 struct PayloadBuffer {
-    uint8_t *data;
-    size_t  size;
+    uint8_t     *data;
+    size_t      size;
+    struct Page *page;      // Pinned page data points into, NULL when data is malloc'd
 };
 
 // @TODO: does this overlap with another function?
@@ -31,7 +34,7 @@ static uint64_t read_root_page(uint8_t *data, uint64_t serial_type) {
     }
 }
 
-static struct PayloadInfo get_payload_info_from_cell(struct Cell *cell) {
+struct PayloadInfo get_payload_info_from_cell(struct Cell *cell) {
     struct PayloadInfo payload_info;
 
     switch (cell->type) {
@@ -76,39 +79,146 @@ static void read_payload_overflow(struct Pager *pager, struct PayloadInfo *paylo
     }
 }
 
+void copy_cell_payload(struct Pager *pager, const uint8_t *page_data, struct PayloadInfo *payload_info, uint8_t *buffer) {
+    // Only the local bytes are on the cell's page, the rest comes from the overflow chain
+    memcpy(buffer, page_data + payload_info->payload_offset, payload_info->local_bytes);
+
+    if (payload_info->overflow_page != 0) {
+        read_payload_overflow(pager, payload_info, buffer);
+    }
+}
+
+void overflow_chain_init(struct OverflowChain *chain) {
+    chain->first_page       = 0;
+    chain->pages            = NULL;
+    chain->page_count       = 0;
+    chain->page_capacity    = 0;
+}
+
+void overflow_chain_free(struct OverflowChain *chain) {
+    free(chain->pages);
+    overflow_chain_init(chain);
+}
+
+static uint32_t overflow_chain_page(struct Pager *pager, struct PayloadInfo *payload_info, struct OverflowChain *chain, uint64_t index) {
+    // The chain is a linked list, reaching page index means reading the link of every page before it
+    if (chain->first_page != payload_info->overflow_page) {
+        chain->first_page = payload_info->overflow_page;
+        chain->page_count = 0;
+    }
+
+    while (chain->page_count <= index) {
+        uint32_t page_number;
+
+        if (chain->page_count == 0) {
+            page_number = payload_info->overflow_page;
+        } else {
+            struct Page *page = get_page(pager, chain->pages[chain->page_count - 1]);
+            page_number = read_u32_big_endian(page->data, 0);
+            pager_release_page(page);
+        }
+
+        if (page_number == 0) {
+            fprintf(stderr, "overflow_chain_page: chain from page %u ends before overflow page %llu\n", payload_info->overflow_page, (unsigned long long)index);
+            exit(1);
+        }
+
+        if (chain->page_count == chain->page_capacity) {
+            uint64_t capacity = chain->page_capacity > 0 ? chain->page_capacity * 2 : 8;
+            uint32_t *pages = realloc(chain->pages, capacity * sizeof(uint32_t));
+            if (!pages) {
+                fprintf(stderr, "overflow_chain_page: pages realloc failed\n");
+                exit(1);
+            }
+
+            chain->pages            = pages;
+            chain->page_capacity    = capacity;
+        }
+
+        chain->pages[chain->page_count++] = page_number;
+    }
+
+    return chain->pages[index];
+}
+
+void copy_payload_range(struct Pager *pager, const uint8_t *page_data, struct PayloadInfo *payload_info, struct OverflowChain *chain, uint64_t offset, uint64_t size, uint8_t *buffer) {
+    // Copies payload bytes [offset, offset + size) to buffer, reading only the overflow pages
+    // that hold them. Each overflow page starts with the next page number, then its share of the payload.
+    uint64_t overflow_capacity = pager->page_size - pager->database_header->reserved_space - 4;
+
+    if (offset + size > payload_info->payload_size) {
+        fprintf(stderr, "copy_payload_range: bytes %llu to %llu are past the payload size %llu\n",
+            (unsigned long long)offset, (unsigned long long)(offset + size), (unsigned long long)payload_info->payload_size);
+        exit(1);
+    }
+
+    if (offset < payload_info->local_bytes) {
+        uint64_t local_size = payload_info->local_bytes - offset;
+        local_size = local_size > size ? size : local_size;
+
+        memcpy(buffer, page_data + payload_info->payload_offset + offset, local_size);
+        buffer  += local_size;
+        offset  += local_size;
+        size    -= local_size;
+    }
+
+    while (size > 0) {
+        uint64_t overflow_offset    = offset - payload_info->local_bytes;
+        uint64_t page_offset        = overflow_offset % overflow_capacity;
+        uint64_t bytes_to_read      = overflow_capacity - page_offset;
+        bytes_to_read = bytes_to_read > size ? size : bytes_to_read;
+
+        struct Page *page = get_page(pager, overflow_chain_page(pager, payload_info, chain, overflow_offset / overflow_capacity));
+        memcpy(buffer, page->data + 4 + page_offset, bytes_to_read);
+        pager_release_page(page);
+
+        buffer  += bytes_to_read;
+        offset  += bytes_to_read;
+        size    -= bytes_to_read;
+    }
+}
+
 static struct PayloadBuffer read_full_payload(struct Pager *pager, struct Cell *cell) {
     struct Page *page = get_page(pager, cell->page_number);
     struct PayloadBuffer payload_buffer;
     struct PayloadInfo payload_info = get_payload_info_from_cell(cell);
-    
-    uint32_t header_offset = payload_info.payload_offset;
-    uint8_t *data = page->data + header_offset;
 
-    payload_buffer.data = malloc(payload_info.payload_size);
     payload_buffer.size = payload_info.payload_size;
 
+    if (payload_info.overflow_page == 0) {
+        // The page stays pinned until the buffer is freed
+        payload_buffer.data = page->data + payload_info.payload_offset;
+        payload_buffer.page = page;
+        return payload_buffer;
+    }
+
+    payload_buffer.data = malloc(payload_info.payload_size);
+    payload_buffer.page = NULL;
+
     if (!payload_buffer.data) {
         fprintf(stderr, "read_full_payload: failed to malloc payload_buffer.data\n");
         exit(1);
     }
 
-    memcpy(payload_buffer.data, data, payload_info.payload_size);
-    
-    if (payload_info.overflow_page != 0) {
-        read_payload_overflow(pager, &payload_info, payload_buffer.data);
-    }
+    copy_cell_payload(pager, page->data, &payload_info, payload_buffer.data);
 
     pager_release_page(page);
     return payload_buffer;
 }
 
 static void free_payload_buffer(struct PayloadBuffer *payload_buffer) {
-    free(payload_buffer->data);
+    if (payload_buffer->page != NULL) {
+        pager_release_page(payload_buffer->page);
+    } else {
+        free(payload_buffer->data);
+    }
+
     payload_buffer->data = NULL;
     payload_buffer->size = 0;
+    payload_buffer->page = NULL;
 }
 
-static struct ContentType serial_type_to_content_type(uint64_t serial_type) {
+struct ContentType serial_type_to_content_type(uint64_t serial_type) {
     struct ContentType content_type;
 
     switch(serial_type) {
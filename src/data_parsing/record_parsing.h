@@ -73,6 +73,30 @@ struct SchemaRecord {
     struct SchemaRecordBody     body;
 };
 
+// Page numbers of an overflow chain, filled in as far as a read has followed it. Reads
+// of later columns of the same record start from here instead of the head of the chain.
+struct OverflowChain {
+    uint32_t    first_page;     // Chain the pages belong to, 0 when empty
+    uint32_t    *pages;
+    uint64_t    page_count;
+    uint64_t    page_capacity;
+};
+
+void overflow_chain_init(struct OverflowChain *chain);
+void overflow_chain_free(struct OverflowChain *chain);
+
+struct PayloadInfo get_payload_info_from_cell(struct Cell *cell);
+struct ContentType serial_type_to_content_type(uint64_t serial_type);
+void copy_cell_payload(struct Pager *pager, const uint8_t *page_data, struct PayloadInfo *payload_info, uint8_t *buffer);
+void copy_payload_range(
+    struct Pager *pager,
+    const uint8_t *page_data,
+    struct PayloadInfo *payload_info,
+    struct OverflowChain *chain,
+    uint64_t offset,
+    uint64_t size,
+    uint8_t *buffer);
+
 void free_schema_record(struct SchemaRecord *schema_record);
 void free_record(struct Record *record);
 
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <string.h>
 
 #include "byte_reader.h"
 #include "row_parsing.h"
@@ -12,7 +13,7 @@ void free_row(struct Row *row) {
     free(row->values);
 }
 
-static void decode_column(const uint8_t *data, struct ContentType type, struct Value *value) {
+void decode_value(const uint8_t *data, struct ContentType type, struct Value *value) {
 
     switch (type.type_name) {
 
@@ -51,9 +52,13 @@ static void decode_column(const uint8_t *data, struct ContentType type, struct V
             value->int_value.value      = (int64_t)read_u64_big_endian(data, 0);
             break;
 
-        case SQL_64FLOAT:
-            fprintf(stderr, "Should not be decoding SQL_RESERVED.\n");
-            exit(1);    
+        case SQL_64FLOAT: {
+            // Stored as the big-endian bits of an IEEE 754 double
+            uint64_t bits = read_u64_big_endian(data, 0);
+            value->type = VALUE_FLOAT;
+            memcpy(&value->float_value.value, &bits, sizeof bits);
+            break;
+        }
 
         case SQL_0:
             value->type             = VALUE_INT;
@@ -83,7 +88,7 @@ static void decode_column(const uint8_t *data, struct ContentType type, struct V
             exit(1);
 
         default:
-            fprintf(stderr, "decode_column: Unknown type %d.\n", type.type_name);
+            fprintf(stderr, "decode_value: Unknown type %d.\n", type.type_name);
             exit(1);
             
     }
@@ -102,7 +107,7 @@ void read_row_from_record(struct Record *record, struct Row *row, struct Cell *c
 
 
     for (uint64_t i = 0; i < record->header.number_of_columns; i++) {
-        decode_column(record->body.column_pointers[i], record->header.columns[i], &row->values[i]);
+        decode_value((const uint8_t *)record->body.column_pointers[i], record->header.columns[i], &row->values[i]);
     }
 
     switch (cell->type) {
@@ -142,19 +147,247 @@ void read_cell_offset_into_row(struct Pager *pager, struct Row *row, struct Page
     read_row_from_record(&record, row, &cell);
 }
 
+void column_mask_init(struct ColumnMask *mask, uint64_t column_count) {
+    mask->bits = calloc((column_count + 63) / 64 + 1, sizeof(uint64_t));
+    if (!mask->bits) {
+        fprintf(stderr, "column_mask_init: bits calloc failed\n");
+        exit(1);
+    }
+
+    mask->column_count  = column_count;
+    mask->decode_count  = 0;
+}
+
+void column_mask_free(struct ColumnMask *mask) {
+    free(mask->bits);
+    mask->bits          = NULL;
+    mask->column_count  = 0;
+    mask->decode_count  = 0;
+}
+
+void column_mask_set(struct ColumnMask *mask, uint64_t column) {
+    assert(column < mask->column_count);
+
+    mask->bits[column / 64] |= (uint64_t)1 << (column % 64);
+    if (column >= mask->decode_count) {
+        mask->decode_count = column + 1;
+    }
+}
+
+void column_mask_set_all(struct ColumnMask *mask) {
+    for (uint64_t i = 0; i < mask->column_count; i++) {
+        column_mask_set(mask, i);
+    }
+}
+
+bool column_mask_has(const struct ColumnMask *mask, uint64_t column) {
+    return column < mask->column_count && (mask->bits[column / 64] >> (column % 64)) & 1;
+}
+
+void row_buffer_init(struct RowBuffer *buffer) {
+    buffer->values              = NULL;
+    buffer->value_capacity      = 0;
+    buffer->payload             = NULL;
+    buffer->payload_capacity    = 0;
+    overflow_chain_init(&buffer->overflow_chain);
+}
+
+void row_buffer_free(struct RowBuffer *buffer) {
+    free(buffer->values);
+    free(buffer->payload);
+    overflow_chain_free(&buffer->overflow_chain);
+    row_buffer_init(buffer);
+}
+
+static void row_buffer_reserve(struct RowBuffer *buffer, uint64_t payload_size, uint64_t value_count) {
+    if (payload_size > buffer->payload_capacity) {
+        uint64_t capacity = buffer->payload_capacity > 0 ? buffer->payload_capacity : 256;
+        while (capacity < payload_size) {
+            capacity *= 2;
+        }
+
+        uint8_t *payload = realloc(buffer->payload, capacity);
+        if (!payload) {
+            fprintf(stderr, "row_buffer_reserve: payload realloc failed\n");
+            exit(1);
+        }
+
+        buffer->payload             = payload;
+        buffer->payload_capacity    = capacity;
+    }
+
+    if (value_count > buffer->value_capacity) {
+        struct Value *values = realloc(buffer->values, value_count * sizeof(struct Value));
+        if (!values) {
+            fprintf(stderr, "row_buffer_reserve: values realloc failed\n");
+            exit(1);
+        }
+
+        buffer->values          = values;
+        buffer->value_capacity  = value_count;
+    }
+}
+
+void record_reader_open(struct RecordReader *reader, struct Pager *pager, const uint8_t *page_data, struct Cell *cell, struct RowBuffer *buffer) {
+    // The header is read in place unless it runs past the local bytes onto the overflow chain
+    reader->pager           = pager;
+    reader->page_data       = page_data;
+    reader->payload_info    = get_payload_info_from_cell(cell);
+    reader->buffer          = buffer;
+    reader->header_offset   = 0;
+
+    struct PayloadInfo *payload_info = &reader->payload_info;
+    const uint8_t *local = page_data + payload_info->payload_offset;
+    reader->header_size = read_varint(local, &reader->header_offset);
+
+    if (reader->header_size > payload_info->payload_size || reader->header_size < reader->header_offset) {
+        fprintf(stderr, "record_reader_open: Bad record header size %llu on page %u\n", (unsigned long long)reader->header_size, cell->page_number);
+        exit(1);
+    }
+
+    reader->column_offset   = reader->header_size;
+    reader->next_offset     = reader->header_size;
+    reader->header          = local;
+
+    if (payload_info->overflow_page != 0) {
+        // Columns copied off the overflow chain keep their payload offsets, so the buffer
+        // never moves under values decoded earlier in the row
+        row_buffer_reserve(buffer, payload_info->payload_size, 0);
+    }
+
+    if (reader->header_size > payload_info->local_bytes) {
+        copy_payload_range(pager, page_data, payload_info, &buffer->overflow_chain, 0, reader->header_size, buffer->payload);
+        reader->header = buffer->payload;
+    }
+}
+
+bool record_reader_next(struct RecordReader *reader) {
+    // Moves to the next column, false once the header has no more
+    if (reader->header_offset >= reader->header_size) {
+        return false;
+    }
+
+    reader->type            = serial_type_to_content_type(read_varint(reader->header, &reader->header_offset));
+    reader->column_offset   = reader->next_offset;
+    reader->next_offset     += reader->type.content_size;
+    return true;
+}
+
+const uint8_t *record_reader_data(struct RecordReader *reader) {
+    // A column in the local bytes is read in place, one reaching into the overflow chain is
+    // copied to its own offset in the payload buffer, touching only the overflow pages it spans
+    struct PayloadInfo *payload_info = &reader->payload_info;
+    uint64_t offset = reader->column_offset;
+    uint64_t size   = reader->type.content_size;
+
+    if (offset + size <= payload_info->local_bytes) {
+        return reader->page_data + payload_info->payload_offset + offset;
+    }
+
+    copy_payload_range(reader->pager, reader->page_data, payload_info, &reader->buffer->overflow_chain, offset, size, reader->buffer->payload + offset);
+    return reader->buffer->payload + offset;
+}
+
+void read_cell_into_row_buffer(struct Pager *pager, const uint8_t *page_data, struct Cell *cell, struct RowBuffer *buffer, const struct ColumnMask *mask, struct Row *row) {
+    // Same result as read_cell_offset_into_row, but the record is decoded straight from
+    // the payload into the buffer instead of through a freshly allocated struct Record.
+    // Text values point into the page, so the row is only valid while the page is pinned.
+    // With a mask only the columns in it are decoded, a NULL mask decodes them all, and
+    // overflow pages are only read for decoded columns that lie on them.
+    struct RecordReader reader;
+    record_reader_open(&reader, pager, page_data, cell, buffer);
+
+    // Every column takes at least one byte of the header
+    uint64_t value_count = reader.header_size - reader.header_offset;
+    if (mask != NULL && mask->column_count > value_count) {
+        value_count = mask->column_count;
+    }
+    row_buffer_reserve(buffer, 0, value_count);
+
+    uint64_t column_count = 0;
+    uint64_t decode_count = mask != NULL ? mask->decode_count : UINT64_MAX;
+
+    while (column_count < decode_count && record_reader_next(&reader)) {
+        if (mask == NULL || column_mask_has(mask, column_count)) {
+            decode_value(record_reader_data(&reader), reader.type, &buffer->values[column_count]);
+        } else {
+            buffer->values[column_count] = (struct Value){ .type = VALUE_NULL };
+        }
+
+        column_count++;
+    }
+
+    if (mask != NULL) {
+        // Columns after the last one the query reads, and any a short record leaves out
+        for (; column_count < mask->column_count; column_count++) {
+            buffer->values[column_count] = (struct Value){ .type = VALUE_NULL };
+        }
+    }
+
+    row->column_count   = column_count;
+    row->values         = buffer->values;
+
+    switch (cell->type) {
+        case TABLE_LEAF_CELL:
+            row->rowid = cell->data.table_leaf_cell.row_id;
+            break;
+
+        case INDEX_INTERIOR_CELL:
+        case INDEX_LEAF_CELL:
+            // Index records end with the rowid of the row they point at, a mask would cut it off
+            if (mask != NULL) {
+                fprintf(stderr, "read_cell_into_row_buffer: Column masks only apply to table rows, page %u is an index page\n", cell->page_number);
+                exit(1);
+            }
+
+            if (column_count == 0 || row->values[column_count - 1].type != VALUE_INT) {
+                fprintf(stderr, "read_cell_into_row_buffer: Index record on page %u has no rowid\n", cell->page_number);
+                exit(1);
+            }
+            row->rowid = row->values[column_count - 1].int_value.value;
+            break;
+
+        default:
+            fprintf(stderr, "Cannot read record using page type: %d\n", cell->type);
+            exit(1);
+    }
+}
+
+static void format_float(double value, char *text, size_t size) {
+    // Like sqlite, 15 significant digits and a .0 on whole numbers and whole mantissas, and
+    // no sign on a negative zero
+    snprintf(text, size, "%.15g", value == 0.0 ? 0.0 : value);
+
+    char *exponent = strchr(text, 'e');
+
+    if (strpbrk(text, ".ni") != NULL) {
+        return;
+    }
+
+    if (exponent == NULL) {
+        strncat(text, ".0", size - strlen(text) - 1);
+    } else if (strlen(text) + 2 < size) {
+        memmove(exponent + 2, exponent, strlen(exponent) + 1);
+        memcpy(exponent, ".0", 2);
+    }
+}
+
 void print_value(struct Value *value) {
+    char text[32];
+
     switch (value->type) {
 
         case VALUE_NULL:
-            printf("NULL");
+            // Nothing, as the sqlite3 shell prints it
             break;
 
         case VALUE_INT:
-            printf("%zu", value->int_value.value);
+            printf("%lld", (long long)value->int_value.value);
             break;
 
         case VALUE_FLOAT:
-            printf("%f", value->float_value.value);
+            format_float(value->float_value.value, text, sizeof text);
+            printf("%s", text);
             break;
 
         case VALUE_TEXT:
@@ -168,6 +401,8 @@ void print_value(struct Value *value) {
 }
 
 void print_value_to_stderr(struct Value *value) {
+    char text[32];
+
     if (value == NULL) {
         fprintf(stderr, "struct Value pointer is NULL.\n");
         exit(1);
@@ -180,11 +415,12 @@ void print_value_to_stderr(struct Value *value) {
             break;
 
         case VALUE_INT:
-            fprintf(stderr, "%zu", value->int_value.value);
+            fprintf(stderr, "%lld", (long long)value->int_value.value);
             break;
 
         case VALUE_FLOAT:
-            fprintf(stderr, "%f", value->float_value.value);
+            format_float(value->float_value.value, text, sizeof text);
+            fprintf(stderr, "%s", text);
             break;
 
         case VALUE_TEXT:
@@ -2,6 +2,7 @@
 #define sql_row_parsing
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "../common.h"
 #include "../pager.h"
@@ -25,7 +26,7 @@ struct IntValue {
 };
 
 struct FloatValue {
-    float value;
+    double value;
 };
 
 struct TextValue {
@@ -49,7 +50,64 @@ struct Row {
     struct Value    *values;
 };
 
+// Storage rows are decoded into, reused from one row to the next. Both arrays grow to
+// fit the largest row seen, after that decoding a row allocates nothing.
+// Text values point into the cell's page, or into payload when they continue on overflow
+// pages, so a row is only valid until the buffer is reused and while the page is pinned.
+struct RowBuffer {
+    struct Value    *values;
+    uint64_t        value_capacity;
+    uint8_t         *payload;           // Only used for records with overflow pages
+    uint64_t        payload_capacity;
+    struct OverflowChain overflow_chain;    // Overflow pages of the last record that needed them
+};
+
+// Table columns a query reads, one bit per column. Decoding with a mask skips the other
+// columns by the size of their serial type and leaves them NULL, columns after the last
+// one in the mask are not even looked up in the record header.
+struct ColumnMask {
+    uint64_t        *bits;
+    uint64_t        column_count;
+    uint64_t        decode_count;   // One past the last column in the mask
+};
+
+// Walks the columns of one record in order. The bytes of a column are only read when
+// asked for, in place on the page or gathered into the buffer from overflow pages.
+struct RecordReader {
+    struct Pager        *pager;
+    const uint8_t       *page_data;
+    struct PayloadInfo  payload_info;
+    struct RowBuffer    *buffer;
+    const uint8_t       *header;
+    uint64_t            header_size;
+    uint64_t            header_offset;      // Next serial type in the header
+    uint64_t            column_offset;      // Payload offset of the current column
+    uint64_t            next_offset;
+    struct ContentType  type;               // Type of the current column
+};
+
 void free_row(struct Row *row);
+void decode_value(const uint8_t *data, struct ContentType type, struct Value *value);
+
+void record_reader_open(struct RecordReader *reader, struct Pager *pager, const uint8_t *page_data, struct Cell *cell, struct RowBuffer *buffer);
+bool record_reader_next(struct RecordReader *reader);
+const uint8_t *record_reader_data(struct RecordReader *reader);
+
+void column_mask_init(struct ColumnMask *mask, uint64_t column_count);
+void column_mask_free(struct ColumnMask *mask);
+void column_mask_set(struct ColumnMask *mask, uint64_t column);
+void column_mask_set_all(struct ColumnMask *mask);
+bool column_mask_has(const struct ColumnMask *mask, uint64_t column);
+
+void row_buffer_init(struct RowBuffer *buffer);
+void row_buffer_free(struct RowBuffer *buffer);
+void read_cell_into_row_buffer(
+    struct Pager *pager,
+    const uint8_t *page_data,
+    struct Cell *cell,
+    struct RowBuffer *buffer,
+    const struct ColumnMask *mask,
+    struct Row *row);
 
 void read_row_from_record(struct Record *record, struct Row *row, struct Cell *cell);
 
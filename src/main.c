@@ -1,4 +1,6 @@
 #include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "commands.h"
@@ -6,15 +8,67 @@
 #include "pager.h"
 
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
-        fprintf(stderr, "Usage: ./your_program.sh <database path> <command>\n");
+    struct PagerConfig config = pager_default_config();
+    struct PlanConfig plan_config = plan_default_config();
+
+    // Options come before the database path
+    int arg = 1;
+    while (arg < argc && strncmp(argv[arg], "--", 2) == 0) {
+        if (strcmp(argv[arg], "--mmap") == 0) {
+            config.mode = PAGER_MODE_MMAP;
+        } else if (strncmp(argv[arg], "--cache-policy=", 15) == 0) {
+            if (!replacement_policy_from_name(argv[arg] + 15, &config.policy)) {
+                fprintf(stderr, "Unknown cache policy %s, expected lru, clock or 2q\n", argv[arg] + 15);
+                return 1;
+            }
+        } else if (strcmp(argv[arg], "--io=sync") == 0) {
+            config.io = PAGER_IO_SYNC;
+        } else if (strcmp(argv[arg], "--io=uring") == 0) {
+            config.io = PAGER_IO_URING;
+        } else if (strncmp(argv[arg], "--readahead=", 12) == 0) {
+            char *end;
+            unsigned long readahead_pages = strtoul(argv[arg] + 12, &end, 10);
+            if (end == argv[arg] + 12 || *end != '\0' || readahead_pages > UINT16_MAX) {
+                fprintf(stderr, "Invalid readahead %s, expected a page count\n", argv[arg] + 12);
+                return 1;
+            }
+            config.readahead_pages = (uint32_t)readahead_pages;
+        } else if (strncmp(argv[arg], "--threads=", 10) == 0) {
+            char *end;
+            unsigned long scan_threads = strtoul(argv[arg] + 10, &end, 10);
+            if (end == argv[arg] + 10 || *end != '\0' || scan_threads == 0 || scan_threads > 256) {
+                fprintf(stderr, "Invalid threads %s, expected 1 to 256\n", argv[arg] + 10);
+                return 1;
+            }
+            plan_config.scan_threads = (uint32_t)scan_threads;
+        } else if (strncmp(argv[arg], "--sort-memory=", 14) == 0) {
+            char *end;
+            unsigned long sort_memory_mb = strtoul(argv[arg] + 14, &end, 10);
+            if (end == argv[arg] + 14 || *end != '\0' || sort_memory_mb == 0 || sort_memory_mb > SIZE_MAX / (1024 * 1024)) {
+                fprintf(stderr, "Invalid sort memory %s, expected a size in MiB\n", argv[arg] + 14);
+                return 1;
+            }
+            plan_config.sort_memory = (size_t)sort_memory_mb * 1024 * 1024;
+        } else if (strcmp(argv[arg], "--exec=row") == 0) {
+            plan_config.batch_execution = false;
+        } else if (strcmp(argv[arg], "--exec=batch") == 0) {
+            plan_config.batch_execution = true;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[arg]);
+            return 1;
+        }
+        arg++;
+    }
+
+    if (argc - arg != 2) {
+        fprintf(stderr, "Usage: ./your_program.sh [--mmap] [--cache-policy=lru|clock|2q] [--readahead=N] [--io=sync|uring] [--threads=N] [--exec=row|batch] [--sort-memory=MiB] <database path> <command>\n");
         return 1;
     }
 
-    const char *database_file_path = argv[1];
-    const char *command = argv[2];
+    const char *database_file_path = argv[arg];
+    const char *command = argv[arg + 1];
 
-    struct Pager *pager = pager_open(database_file_path);
+    struct Pager *pager = pager_open(database_file_path, &config);
 
     int result = 0;
 
@@ -28,13 +82,14 @@ int main(int argc, char *argv[]) {
 
     } else if (strncmp(command, ".", 1) != 0) {
         fprintf(stderr, "Received SQL statement\n");
-        result = command_sql(pager, command);
+        result = command_sql(pager, command, &plan_config);
 
     } else {
         fprintf(stderr, "Unknown command %s\n", command);
         result = 1;
     }
 
+    pager_print_stats_to_stderr(pager);
     pager_close(pager);
     return result;
 }
\ No newline at end of file
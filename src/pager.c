@@ -3,7 +3,21 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 #include "pager.h"
+#include "replacement_policy.h"
+#include "utilities/page_table.h"
+#include "utilities/io_ring.h"
 #include "data_parsing/byte_reader.h"
 #include "data_parsing/page_parsing.h"
 #include "sql_utils.h"
@@ -67,7 +81,158 @@ static void read_database_header(FILE *file, struct DatabaseHeader *database_hea
     database_header->default_page_cache_size = read_next_four_bytes_as_big_endian(file);
 }
 
-struct Pager *pager_open(const char *database_file_path) {
+static void map_database_file(struct Pager *pager) {
+    // Map the whole file read-only, pages are then just offsets into the mapping
+    // and reads are served straight from the OS page cache
+#ifdef _WIN32
+    HANDLE file_handle = (HANDLE)_get_osfhandle(_fileno(pager->file));
+    LARGE_INTEGER file_size;
+
+    if (!GetFileSizeEx(file_handle, &file_size)) {
+        fprintf(stderr, "map_database_file: GetFileSizeEx failed\n");
+        exit(1);
+    }
+
+    HANDLE mapping = CreateFileMappingA(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        fprintf(stderr, "map_database_file: CreateFileMappingA failed\n");
+        exit(1);
+    }
+
+    void *map = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!map) {
+        fprintf(stderr, "map_database_file: MapViewOfFile failed\n");
+        exit(1);
+    }
+
+    pager->map_handle   = mapping;
+    pager->map_size     = (size_t)file_size.QuadPart;
+#else
+    struct stat file_stat;
+
+    if (fstat(fileno(pager->file), &file_stat) != 0) {
+        fprintf(stderr, "map_database_file: fstat failed\n");
+        exit(1);
+    }
+
+    void *map = mmap(NULL, (size_t)file_stat.st_size, PROT_READ, MAP_SHARED, fileno(pager->file), 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "map_database_file: mmap failed\n");
+        exit(1);
+    }
+
+    pager->map_handle   = NULL;
+    pager->map_size     = (size_t)file_stat.st_size;
+#endif
+
+    pager->map = map;
+}
+
+static void unmap_database_file(struct Pager *pager) {
+#ifdef _WIN32
+    UnmapViewOfFile(pager->map);
+    CloseHandle((HANDLE)pager->map_handle);
+#else
+    munmap(pager->map, pager->map_size);
+#endif
+
+    pager->map          = NULL;
+    pager->map_size     = 0;
+    pager->map_handle   = NULL;
+}
+
+static void read_page_data(struct Pager *pager, uint32_t page_number, uint8_t *data) {
+    // Positional reads leave the file offset alone, so concurrent misses do not race on it
+    uint64_t offset = (uint64_t)pager->page_size * (page_number - 1);
+
+#ifdef _WIN32
+    HANDLE file_handle = (HANDLE)_get_osfhandle(_fileno(pager->file));
+    OVERLAPPED overlapped = { .Offset = (DWORD)offset, .OffsetHigh = (DWORD)(offset >> 32) };
+    DWORD bytes_read = 0;
+
+    if (!ReadFile(file_handle, data, pager->page_size, &bytes_read, &overlapped) || bytes_read != pager->page_size) {
+        fprintf(stderr, "read_page_data: ReadFile of page %u failed\n", page_number);
+        exit(1);
+    }
+#else
+    if (pread(fileno(pager->file), data, pager->page_size, (off_t)offset) != (ssize_t)pager->page_size) {
+        fprintf(stderr, "read_page_data: pread of page %u failed\n", page_number);
+        exit(1);
+    }
+#endif
+}
+
+static uint32_t choose_partition_count(uint32_t cache_capacity, uint32_t requested) {
+    // A power of two no larger than requested that still leaves every partition enough slots
+    uint32_t limit = requested != 0 ? requested : PAGER_MAX_PARTITIONS;
+    uint32_t count = 1;
+
+    while (count * 2 <= limit && cache_capacity / (count * 2) >= MIN_PARTITION_CAPACITY) {
+        count *= 2;
+    }
+
+    return count;
+}
+
+static inline struct PagePartition *partition_for_page(struct Pager *pager, uint32_t page_number) {
+    // Fibonacci hashing so neighbouring pages of a scan land in different partitions
+    return &pager->partitions[((page_number * 2654435761u) >> 16) & pager->partition_mask];
+}
+
+static void init_partitions(struct Pager *pager, enum ReplacementPolicyType policy, uint32_t requested) {
+    pager->partition_count  = choose_partition_count(pager->cache_capacity, requested);
+    pager->partition_mask   = pager->partition_count - 1;
+    pager->partitions       = calloc(pager->partition_count, sizeof(struct PagePartition));
+
+    if (!pager->partitions) {
+        fprintf(stderr, "init_partitions: pager->partitions calloc failed\n");
+        exit(1);
+    }
+
+    uint32_t first_slot = 0;
+    for (uint32_t i = 0; i < pager->partition_count; i++) {
+        struct PagePartition *partition = &pager->partitions[i];
+
+        if (mtx_init(&partition->lock, mtx_plain) != thrd_success) {
+            fprintf(stderr, "init_partitions: mtx_init failed\n");
+            exit(1);
+        }
+
+        partition->slots_used = 0;
+        partition->page_table = (struct PageTable){ .keys = NULL, .values = NULL, .mask = 0, .count = 0 };
+
+        if (pager->mode == PAGER_MODE_MMAP) {
+            // Mapped pages are never evicted, the partition is only used for its lock and stats
+            partition->pages    = NULL;
+            partition->capacity = 0;
+            replacement_state_init(&partition->replacement, POLICY_LRU, 0);
+            continue;
+        }
+
+        // The first partitions take the slots left over by the division
+        partition->capacity = pager->cache_capacity / pager->partition_count + (i < pager->cache_capacity % pager->partition_count ? 1 : 0);
+        partition->pages    = pager->pages + first_slot;
+        first_slot         += partition->capacity;
+
+        page_table_init(&partition->page_table, partition->capacity);
+        replacement_state_init(&partition->replacement, policy, partition->capacity);
+    }
+}
+
+struct PagerConfig pager_default_config(void) {
+    struct PagerConfig config = {
+        .mode               = PAGER_MODE_BUFFERED,
+        .policy             = POLICY_LRU,
+        .io                 = PAGER_IO_SYNC,
+        .cache_capacity     = 0,
+        .readahead_pages    = DEFAULT_READAHEAD_PAGES,
+        .partitions         = 0
+    };
+
+    return config;
+}
+
+struct Pager *pager_open(const char *database_file_path, const struct PagerConfig *config) {
     FILE *database_file;
     fopen_s(&database_file, database_file_path, "rb");
     
@@ -98,21 +263,75 @@ struct Pager *pager_open(const char *database_file_path) {
     }
 
     pager->file                 = database_file;
+    pager->mode                 = config->mode;
     pager->page_size            = database_header->page_size;
     pager->page_count           = database_header->page_count;
+    pager->readahead_pages      = config->readahead_pages;
+    pager->async_io             = false;
+    pager->io_ring              = (struct IoRing){ .ring_fd = -1 };
 
-    pager->cache_capacity       = database_header->default_page_cache_size < MIN_CACHE_CAPACITY ? MIN_CACHE_CAPACITY : database_header->default_page_cache_size;
-    pager->pages                = calloc(pager->cache_capacity, sizeof(struct Page));
-    pager->data                 = calloc(pager->cache_capacity, pager->page_size);
-    pager->clock                = 0;
+    atomic_init(&pager->prefetches, 0);
+
+    if (mtx_init(&pager->io_lock, mtx_plain) != thrd_success) {
+        fprintf(stderr, "pager_open: mtx_init failed\n");
+        exit(1);
+    }
+
+    pager->map                  = NULL;
+    pager->map_size             = 0;
+    pager->map_handle           = NULL;
 
     pager->database_header      = database_header;
     pager->schema_page_header   = schema_page_header;
 
-    struct Page *page;
-    for (uint32_t i = 0; i < pager->cache_capacity; i++) {
-        page = &pager->pages[i];
-        page->data = pager->data + pager->page_size * i;
+    if (pager->mode == PAGER_MODE_MMAP) {
+        map_database_file(pager);
+
+        // Every page in the file gets a slot, slot data is set when the page is first requested
+        pager->cache_capacity   = (uint32_t)(pager->map_size / pager->page_size);
+        pager->pages            = calloc(pager->cache_capacity, sizeof(struct Page));
+        pager->data             = NULL;
+
+        if (!pager->pages) {
+            fprintf(stderr, "pager_open: pager->pages calloc failed\n");
+            exit(1);
+        }
+
+        init_partitions(pager, POLICY_LRU, config->partitions);
+
+    } else {
+        uint32_t cache_capacity = config->cache_capacity != 0 ? config->cache_capacity : database_header->default_page_cache_size;
+        pager->cache_capacity   = cache_capacity < MIN_CACHE_CAPACITY ? MIN_CACHE_CAPACITY : cache_capacity;
+        pager->pages            = calloc(pager->cache_capacity, sizeof(struct Page));
+        pager->data             = calloc(pager->cache_capacity, pager->page_size);
+
+        if (!pager->pages || !pager->data) {
+            fprintf(stderr, "pager_open: page cache calloc failed\n");
+            exit(1);
+        }
+
+        struct Page *page;
+        for (uint32_t i = 0; i < pager->cache_capacity; i++) {
+            page = &pager->pages[i];
+            page->data      = pager->data + (size_t)pager->page_size * i;
+            page->lru_prev  = PAGE_SLOT_EMPTY;
+            page->lru_next  = PAGE_SLOT_EMPTY;
+            page->queue     = QUEUE_NONE;
+        }
+
+        init_partitions(pager, config->policy, config->partitions);
+
+        if (config->io == PAGER_IO_URING) {
+            pager->async_io = io_ring_init(&pager->io_ring, PAGER_IO_RING_ENTRIES);
+            if (!pager->async_io) {
+                fprintf(stderr, "pager_open: io_uring is not available, falling back to blocking reads\n");
+            }
+        }
+
+        // Readahead now takes cache slots, pages read too far ahead would be evicted again before they are used
+        if (pager->async_io && pager->readahead_pages > pager->cache_capacity / 4) {
+            pager->readahead_pages = pager->cache_capacity / 4;
+        }
     }
 
     read_page_header(pager, schema_page_header, 1);
@@ -121,89 +340,352 @@ struct Pager *pager_open(const char *database_file_path) {
 }
 
 void pager_close(struct Pager *pager) {
+    if (pager->async_io) {
+        // The kernel may still be writing into the cache
+        while (pager->io_ring.in_flight + pager->io_ring.queued > 0) {
+            pager_reap_reads(pager, true);
+        }
+        io_ring_free(&pager->io_ring);
+    }
+
+    if (pager->mode == PAGER_MODE_MMAP) {
+        unmap_database_file(pager);
+    }
+
+    for (uint32_t i = 0; i < pager->partition_count; i++) {
+        struct PagePartition *partition = &pager->partitions[i];
+
+        if (partition->page_table.keys != NULL) {
+            page_table_free(&partition->page_table);
+        }
+
+        replacement_state_free(&partition->replacement);
+        mtx_destroy(&partition->lock);
+    }
+
+    mtx_destroy(&pager->io_lock);
     fclose(pager->file);
+    free(pager->partitions);
     free(pager->pages);
     free(pager->data);
     free(pager->database_header);
     free(pager->schema_page_header);
 }
 
-static void evict_cache_entry(struct Pager *pager, uint32_t cache_index) {
-    struct Page *page = &pager->pages[cache_index];
-    page->valid = false;
-}
+struct PolicyStats pager_stats(struct Pager *pager) {
+    struct PolicyStats total = { .hits = 0, .misses = 0, .evictions = 0 };
 
-static uint32_t find_suitable_cache_index(struct Pager *pager) {
-    bool cache_valid = false;
-    uint32_t cache_index = 0;
-    uint64_t oldest = UINT64_MAX;
+    for (uint32_t i = 0; i < pager->partition_count; i++) {
+        struct PagePartition *partition = &pager->partitions[i];
 
-    for (uint32_t i = 0; i < pager->cache_capacity; i++) {
-        struct Page *page = &pager->pages[i];
-        if (!page->valid) {
-            return i;
-        }
+        mtx_lock(&partition->lock);
+        total.hits      += partition->replacement.stats.hits;
+        total.misses    += partition->replacement.stats.misses;
+        total.evictions += partition->replacement.stats.evictions;
+        mtx_unlock(&partition->lock);
+    }
 
-        if (page->pin_count > 0) {
-            continue;
-        }
+    return total;
+}
 
-        if (page->last_used <= oldest) {
-            cache_index = i;
-            oldest = page->last_used;
-            cache_valid = true;
-        }
+void pager_print_stats_to_stderr(struct Pager *pager) {
+    struct PolicyStats stats = pager_stats(pager);
+    uint64_t requests = stats.hits + stats.misses;
+
+    fprintf(stderr, "Pager %s%s cache (%s): %u slots in %u partitions, %llu hits, %llu misses, %llu evictions, %llu prefetches, hit rate %.2f%%\n",
+        pager->mode == PAGER_MODE_MMAP ? "mmap" : "buffered",
+        pager->async_io ? " io_uring" : "",
+        pager->partitions[0].replacement.policy->name,
+        pager->cache_capacity,
+        pager->partition_count,
+        (unsigned long long)stats.hits,
+        (unsigned long long)stats.misses,
+        (unsigned long long)stats.evictions,
+        (unsigned long long)atomic_load(&pager->prefetches),
+        requests > 0 ? 100.0 * (double)stats.hits / (double)requests : 0.0);
+}
+
+static uint32_t find_suitable_cache_index(struct PagePartition *partition) {
+    // Slots are handed out in order until the partition is full
+    if (partition->slots_used < partition->capacity) {
+        return partition->slots_used++;
     }
 
-    if (!cache_valid) {
+    // Then the replacement policy picks an unpinned victim
+    struct ReplacementState *replacement = &partition->replacement;
+    uint32_t cache_index = replacement->policy->choose_victim(partition);
+
+    if (cache_index == PAGE_SLOT_EMPTY) {
         fprintf(stderr, "Pager failed to find suitable cache_index.\n");
         exit(1);
     }
 
-    evict_cache_entry(pager, cache_index);
+    struct Page *page = &partition->pages[cache_index];
+    page_table_remove(&partition->page_table, page->page_no);
+    page->valid = false;
+    replacement->stats.evictions++;
+
     return cache_index;
 }
 
-static void read_new_page(struct Pager *pager, uint32_t page_number, uint32_t cache_index) {
-    struct Page *page = &pager->pages[cache_index];
+static struct Page *claim_page_slot(struct PagePartition *partition, uint32_t page_number) {
+    // Called with the partition locked. The page is published in the page table straight
+    // away, pinned and marked loading, so the read itself can happen outside the lock.
+    uint32_t cache_index = find_suitable_cache_index(partition);
+    struct Page *page = &partition->pages[cache_index];
 
-    if (fseek(pager->file, pager->page_size * (page_number - 1), SEEK_SET) != 0) {
-        fprintf(stderr, "read_new_page: fseek failed\n");
-        exit(1);
+    page->page_no = page_number;
+    page->valid = true;
+    atomic_store_explicit(&page->loading, true, memory_order_relaxed);
+    atomic_fetch_add(&page->pin_count, 1);
+
+    page_table_insert(&partition->page_table, page_number, cache_index);
+    partition->replacement.policy->on_insert(partition, cache_index);
+
+    return page;
+}
+
+static inline void finish_page_load(struct Page *page) {
+    // Publishes page->data to readers waiting in wait_for_page
+    atomic_store_explicit(&page->loading, false, memory_order_release);
+}
+
+static void wait_for_page(struct Pager *pager, struct Page *page) {
+    // Another thread, or an async read, is still filling in the page
+    while (atomic_load_explicit(&page->loading, memory_order_acquire)) {
+        if (pager_reap_reads(pager, false) == 0) {
+            thrd_yield();
+        }
     }
+}
 
-    if (fread(page->data, 1, pager->page_size, pager->file) != pager->page_size) {
-        fprintf(stderr, "read_new_page: fread failed\n");
+void pager_release_page(struct Page *page) {
+    int pin_count = atomic_load(&page->pin_count);
+    while (pin_count > 0 && !atomic_compare_exchange_weak(&page->pin_count, &pin_count, pin_count - 1)) {
+    }
+}
+
+static struct Page *get_mapped_page(struct Pager *pager, uint32_t page_number) {
+    if (page_number == 0 || page_number > pager->cache_capacity) {
+        fprintf(stderr, "get_mapped_page: page %u outside of mapping with %u pages\n", page_number, pager->cache_capacity);
         exit(1);
     }
 
-    page->page_no = page_number;
-    page->valid = true;
-    page->last_used = pager->clock++;
-    page->pin_count++;
-}
+    struct PagePartition *partition = partition_for_page(pager, page_number);
+    struct Page *page = &pager->pages[page_number - 1];
 
-void pager_release_page(struct Page *page) {
-    if (page->pin_count > 0) {
-        page->pin_count--;
+    mtx_lock(&partition->lock);
+
+    if (!page->valid) {
+        page->data      = pager->map + (size_t)pager->page_size * (page_number - 1);
+        page->page_no   = page_number;
+        page->valid     = true;
+        partition->replacement.stats.misses++;
+    } else {
+        partition->replacement.stats.hits++;
     }
+
+    // Pins are only bookkeeping, mapped pages are never evicted
+    atomic_fetch_add(&page->pin_count, 1);
+
+    mtx_unlock(&partition->lock);
+    return page;
 }
 
 struct Page *get_page(struct Pager *pager, uint32_t page_number) {
+    if (pager->mode == PAGER_MODE_MMAP) {
+        return get_mapped_page(pager, page_number);
+    }
+
+    struct PagePartition *partition = partition_for_page(pager, page_number);
+    mtx_lock(&partition->lock);
+
     // 1. Check cache
-    for (uint32_t i = 0; i < pager->cache_capacity; i++) {
-        struct Page *page = &pager->pages[i];
-        if (page->page_no == page_number && page->valid) {
-            page->last_used = pager->clock++;
-            return page;
-        }
+    uint32_t cache_index = page_table_find(&partition->page_table, page_number);
+    if (cache_index != PAGE_TABLE_NOT_FOUND) {
+        struct Page *page = &partition->pages[cache_index];
+
+        atomic_fetch_add(&page->pin_count, 1);
+        partition->replacement.stats.hits++;
+        partition->replacement.policy->on_hit(partition, cache_index);
+        mtx_unlock(&partition->lock);
+
+        // Requested before the read that loads it finished
+        wait_for_page(pager, page);
+        return page;
     }
 
-    // 2. Not found, find slot
-    uint32_t cache_index = find_suitable_cache_index(pager);
+    partition->replacement.stats.misses++;
+
+    // 2. Not found, claim a slot
+    struct Page *page = claim_page_slot(partition, page_number);
+    mtx_unlock(&partition->lock);
 
     // 3. Load page
-    read_new_page(pager, page_number, cache_index);
+    read_page_data(pager, page_number, page->data);
+    finish_page_load(page);
+
+    return page;
+}
+
+static void prefetch_hint(struct Pager *pager, uint32_t page_number) {
+    // Only a hint to the OS, the page is still read by get_page when it is needed.
+    // By then the read should be served from the OS page cache instead of the disk.
+    if (page_number == 0 || page_number > pager->page_count) {
+        return;
+    }
+
+    struct PagePartition *partition = partition_for_page(pager, page_number);
+    size_t offset = (size_t)pager->page_size * (page_number - 1);
+
+    if (pager->mode == PAGER_MODE_MMAP) {
+        mtx_lock(&partition->lock);
+        bool cached = page_number > pager->cache_capacity || pager->pages[page_number - 1].valid;
+        mtx_unlock(&partition->lock);
+
+        if (cached) {
+            return;
+        }
+
+#ifdef _WIN32
+        WIN32_MEMORY_RANGE_ENTRY range = { .VirtualAddress = pager->map + offset, .NumberOfBytes = pager->page_size };
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+        // madvise needs an address aligned to the OS page, which can be larger than a database page
+        size_t os_page_size = (size_t)sysconf(_SC_PAGESIZE);
+        size_t aligned_offset = offset - offset % os_page_size;
+        madvise(pager->map + aligned_offset, offset - aligned_offset + pager->page_size, MADV_WILLNEED);
+#endif
+
+    } else {
+        mtx_lock(&partition->lock);
+        bool cached = page_table_find(&partition->page_table, page_number) != PAGE_TABLE_NOT_FOUND;
+        mtx_unlock(&partition->lock);
+
+        if (cached) {
+            return;
+        }
+
+#if defined(POSIX_FADV_WILLNEED)
+        posix_fadvise(fileno(pager->file), (off_t)offset, (off_t)pager->page_size, POSIX_FADV_WILLNEED);
+#else
+        // No readahead hint for buffered reads on this platform
+        return;
+#endif
+    }
+
+    atomic_fetch_add(&pager->prefetches, 1);
+}
+
+static uint32_t reap_reads_locked(struct Pager *pager, bool wait) {
+    struct IoCompletion completions[PAGER_IO_RING_ENTRIES];
+    uint32_t count = io_ring_reap(&pager->io_ring, completions, PAGER_IO_RING_ENTRIES, wait);
 
-    return &pager->pages[cache_index];
-}
\ No newline at end of file
+    for (uint32_t i = 0; i < count; i++) {
+        struct Page *page = &pager->pages[completions[i].user_data];
+
+        if (completions[i].result != (int32_t)pager->page_size) {
+            fprintf(stderr, "pager_reap_reads: read of page %u failed with %d\n", page->page_no, completions[i].result);
+            exit(1);
+        }
+
+        finish_page_load(page);
+        pager_release_page(page);
+    }
+
+    return count;
+}
+
+static void queue_page_read(struct Pager *pager, struct Page *page) {
+    // In-flight pages are pinned, so leave at least half the cache for eviction
+    uint32_t max_in_flight = pager->cache_capacity / 2 < pager->io_ring.entries ? pager->cache_capacity / 2 : pager->io_ring.entries;
+
+    mtx_lock(&pager->io_lock);
+
+    while (pager->io_ring.in_flight + pager->io_ring.queued >= max_in_flight) {
+        reap_reads_locked(pager, true);
+    }
+
+    // The slot index goes through the kernel as user_data and comes back with the completion
+    uint64_t offset = (uint64_t)pager->page_size * (page->page_no - 1);
+    uint64_t cache_index = (uint64_t)(page - pager->pages);
+
+    if (!io_ring_queue_read(&pager->io_ring, fileno(pager->file), page->data, pager->page_size, offset, cache_index)) {
+        fprintf(stderr, "queue_page_read: submission queue full\n");
+        exit(1);
+    }
+
+    mtx_unlock(&pager->io_lock);
+}
+
+uint32_t pager_submit_reads(struct Pager *pager, const uint32_t *page_numbers, uint32_t count) {
+    // Starts loading every page that is not cached yet. With io_uring the reads are
+    // submitted together and complete in the background, get_page waits for a page
+    // that is still loading. Otherwise each page is read before returning.
+    if (pager->mode == PAGER_MODE_MMAP) {
+        return 0;
+    }
+
+    uint32_t started = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t page_number = page_numbers[i];
+
+        if (page_number == 0 || page_number > pager->page_count) {
+            continue;
+        }
+
+        struct PagePartition *partition = partition_for_page(pager, page_number);
+        mtx_lock(&partition->lock);
+
+        if (page_table_find(&partition->page_table, page_number) != PAGE_TABLE_NOT_FOUND) {
+            mtx_unlock(&partition->lock);
+            continue;
+        }
+
+        struct Page *page = claim_page_slot(partition, page_number);
+        mtx_unlock(&partition->lock);
+
+        if (pager->async_io) {
+            queue_page_read(pager, page);
+        } else {
+            read_page_data(pager, page_number, page->data);
+            finish_page_load(page);
+            pager_release_page(page);
+        }
+
+        started++;
+    }
+
+    if (pager->async_io) {
+        mtx_lock(&pager->io_lock);
+        io_ring_submit(&pager->io_ring);
+        mtx_unlock(&pager->io_lock);
+    }
+
+    return started;
+}
+
+uint32_t pager_reap_reads(struct Pager *pager, bool wait) {
+    if (!pager->async_io) {
+        return 0;
+    }
+
+    mtx_lock(&pager->io_lock);
+    uint32_t count = reap_reads_locked(pager, wait);
+    mtx_unlock(&pager->io_lock);
+
+    return count;
+}
+
+void pager_prefetch_pages(struct Pager *pager, const uint32_t *page_numbers, uint32_t count) {
+    // With io_uring the pages are read into the cache in the background,
+    // otherwise the OS is asked to read them into its page cache
+    if (pager->async_io) {
+        atomic_fetch_add(&pager->prefetches, pager_submit_reads(pager, page_numbers, count));
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        prefetch_hint(pager, page_numbers[i]);
+    }
+}
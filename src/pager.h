@@ -4,9 +4,39 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdatomic.h>
+#include <threads.h>
+
+#include "replacement_policy.h"
+#include "utilities/page_table.h"
+#include "utilities/io_ring.h"
 
 #define MIN_CACHE_CAPACITY (16)
 #define MAGIC_STRING_LENGTH (16)
+#define PAGE_SLOT_EMPTY (UINT32_MAX)
+#define DEFAULT_READAHEAD_PAGES (8)
+#define PAGER_IO_RING_ENTRIES (64)
+#define PAGER_MAX_PARTITIONS (16)
+#define MIN_PARTITION_CAPACITY (64)
+
+enum PagerMode {
+    PAGER_MODE_BUFFERED,    // Pages are copied into a fixed size cache with positional reads
+    PAGER_MODE_MMAP         // Pages point straight into a read-only mapping of the file
+};
+
+enum PagerIo {
+    PAGER_IO_SYNC,          // Every read blocks until the page is in the cache
+    PAGER_IO_URING          // Batches of reads are kept in flight with io_uring, falls back to PAGER_IO_SYNC when unavailable
+};
+
+struct PagerConfig {
+    enum PagerMode              mode;
+    enum ReplacementPolicyType  policy;
+    enum PagerIo                io;
+    uint32_t                    cache_capacity; // 0 uses the suggested cache size from the database header
+    uint32_t                    readahead_pages; // Child pages a table scan prefetches ahead of itself, 0 disables readahead
+    uint32_t                    partitions;     // Upper bound on cache partitions, 0 picks one from the cache size
+};
 
 struct DatabaseHeader {
     uint8_t     reserved_space;
@@ -15,32 +45,75 @@ struct DatabaseHeader {
     uint32_t    default_page_cache_size;
 };
 
+// Pages are read-only once loaded, so a pin doubles as a shared latch on the data:
+// a pinned page is never evicted and nobody writes to it.
+// Everything else in here is owned by the partition lock.
 struct Page {
-    int         pin_count;
+    atomic_int  pin_count;
     uint32_t    page_no;
     uint8_t     *data;
     bool        valid;
-    uint64_t    last_used;
+    atomic_bool loading;    // A read into data is in flight, the reader holds a pin until it completes
+
+    // Replacement policy bookkeeping
+    uint32_t    lru_prev;
+    uint32_t    lru_next;
+    uint8_t     queue;
+    bool        referenced;
+    uint64_t    loaded_at;
 };
 
+// One slice of the page cache with its own lock, page table and replacement state.
+// Page numbers are hashed to partitions so readers on different pages rarely share a lock.
+struct PagePartition {
+    mtx_t                   lock;
+    struct Page             *pages;         // The slots owned by this partition
+    uint32_t                capacity;
+    uint32_t                slots_used;
+    struct PageTable        page_table;     // Page number -> slot within the partition
+    struct ReplacementState replacement;
+};
+
+// A pager can be shared by any number of reader threads.
 struct Pager {
-    FILE        *file;
-    uint32_t    page_size;
-    uint32_t    page_count;
+    FILE            *file;
+    enum PagerMode  mode;
+    uint32_t        page_size;
+    uint32_t        page_count;
 
-    struct Page *pages;
-    uint8_t     *data;
-    uint32_t    cache_capacity;
+    struct Page     *pages;
+    uint8_t         *data;
+    uint32_t        cache_capacity;
+    uint32_t        readahead_pages;
+    atomic_uint_least64_t prefetches;
+
+    struct PagePartition    *partitions;
+    uint32_t                partition_count;
+    uint32_t                partition_mask;
+
+    // Only used by PAGER_IO_URING, the ring itself is guarded by io_lock
+    bool            async_io;
+    mtx_t           io_lock;
+    struct IoRing   io_ring;
 
-    uint64_t    clock;
+    // Only used by PAGER_MODE_MMAP
+    uint8_t         *map;
+    size_t          map_size;
+    void            *map_handle;
 
     struct DatabaseHeader *database_header;
     struct PageHeader     *schema_page_header;
 };
 
-struct Pager *pager_open(const char *database_file_path);
+struct PagerConfig pager_default_config(void);
+struct Pager *pager_open(const char *database_file_path, const struct PagerConfig *config);
 void pager_close(struct Pager *pager);
+struct PolicyStats pager_stats(struct Pager *pager);
+void pager_print_stats_to_stderr(struct Pager *pager);
 struct Page *get_page(struct Pager *pager, uint32_t page_number);
+void pager_prefetch_pages(struct Pager *pager, const uint32_t *page_numbers, uint32_t count);
+uint32_t pager_submit_reads(struct Pager *pager, const uint32_t *page_numbers, uint32_t count);
+uint32_t pager_reap_reads(struct Pager *pager, bool wait);
 void pager_release_page(struct Page *page);
 
 #endif
\ No newline at end of file
@@ -131,6 +131,7 @@ static struct Token *peek(struct Parser *parser, struct Scanner *scanner, size_t
 }
 
 static struct ExprList *parse_comma_separated_expression_list(struct Parser *parser, struct Scanner *scanner);
+int64_t string_to_int(const char *str, size_t len);
 
 static char *get_token_string(struct Token *token) {
     char *buffer = malloc(token->length + 1);
@@ -181,18 +182,30 @@ static struct Expr *make_string_expr(struct Parser *parser) {
     return expr;
 }
 
+static struct Expr *make_integer_expr(struct Parser *parser) {
+    struct Expr *expr   = new_expr(EXPR_INTEGER);
+    expr->integer.value = string_to_int(parser->current.start, parser->current.length);
+    return expr;
+}
+
 static struct Expr *make_binary_expr(enum BinaryOp op, struct Expr* left_expr) {
     struct Expr *expr   = new_expr(EXPR_BINARY);
     expr->binary.op     = op;
     expr->binary.left   = left_expr;
     expr->binary.right  = NULL; // Will add later
+    expr->binary.upper  = NULL;
     return expr;
 }
 
 static struct SelectStatement *make_select_statement(
     char *from_table, 
     struct ExprList *select_list,
-    struct ExprList *where_list
+    struct ExprList *where_list,
+    struct ExprList *group_by_list,
+    struct ExprList *order_by_list,
+    struct SortTypeList *order_by_sort,
+    int64_t limit,
+    int64_t offset
 ) {
     struct SelectStatement *stmt = malloc(sizeof(struct SelectStatement));
     if (!stmt) {
@@ -203,6 +216,11 @@ static struct SelectStatement *make_select_statement(
     stmt->from_table    = from_table;
     stmt->select_list   = select_list;
     stmt->where_list    = where_list;
+    stmt->group_by_list = group_by_list;
+    stmt->order_by_list = order_by_list;
+    stmt->order_by_sort = order_by_sort;
+    stmt->limit         = limit;
+    stmt->offset        = offset;
     return stmt;
 }
 
@@ -262,8 +280,17 @@ static struct Expr *parse_term(struct Parser *parser, struct Scanner *scanner) {
             struct Token *previous = previous_token(parser);
             return make_column_expr(previous->start, previous->length);
 
-        case TOKEN_STRING:
-            return make_string_expr(parser);
+        case TOKEN_STRING: {
+            struct Expr *expr = make_string_expr(parser);
+            advance(parser, scanner);
+            return expr;
+        }
+
+        case TOKEN_NUMBER: {
+            struct Expr *expr = make_integer_expr(parser);
+            advance(parser, scanner);
+            return expr;
+        }
 
         default:
             error_at_current(parser, "Expected expression.");
@@ -291,6 +318,18 @@ static struct Expr *parse_expression(struct Parser *parser, struct Scanner *scan
             binary_expr = make_binary_expr(BIN_GREATER, expr_left);
             break;
 
+        case TOKEN_LESS_EQUAL:
+            binary_expr = make_binary_expr(BIN_LESS_EQUAL, expr_left);
+            break;
+
+        case TOKEN_GREATER_EQUAL:
+            binary_expr = make_binary_expr(BIN_GREATER_EQUAL, expr_left);
+            break;
+
+        case TOKEN_BETWEEN:
+            binary_expr = make_binary_expr(BIN_BETWEEN, expr_left);
+            break;
+
         default: {
             struct Token *previous = previous_token(parser);
             expr_left->text = (struct UnterminatedString){ .start = start, .len = (size_t)(previous->start + previous->length - start)};
@@ -303,6 +342,12 @@ static struct Expr *parse_expression(struct Parser *parser, struct Scanner *scan
     struct Expr *expr_right = parse_term(parser, scanner);
 
     binary_expr->binary.right = expr_right;
+
+    if (binary_expr->binary.op == BIN_BETWEEN) {
+        // The AND belongs to the BETWEEN, not to the list of predicates
+        consume(parser, scanner, TOKEN_AND, "Expected 'AND'.");
+        binary_expr->binary.upper = parse_term(parser, scanner);
+    }
     struct Token *previous = previous_token(parser);
     binary_expr->text = (struct UnterminatedString){ .start = start, .len = (size_t)(previous->start + previous->length - start)};
     return binary_expr;
@@ -334,6 +379,44 @@ static struct ExprList *parse_and_separated_expression_list(struct Parser *parse
     return parse_expression_list(parser, scanner, TOKEN_AND);
 }
 
+static struct ExprList *parse_order_by_list(struct Parser *parser, struct Scanner *scanner, struct SortTypeList *sort) {
+    // Terms are ascending unless followed by DESC
+    struct ExprList *expr_list = vector_expr_list_new();
+
+    while (true) {
+        struct Expr *expr = parse_expression(parser, scanner);
+        vector_expr_list_push(expr_list, *expr);
+
+        enum SortType sort_type = SORT_ASC;
+        if (parser->current.type == TOKEN_ASC) {
+            advance(parser, scanner);
+        } else if (parser->current.type == TOKEN_DESC) {
+            advance(parser, scanner);
+            sort_type = SORT_DESC;
+        }
+        vector_sort_type_list_push(sort, sort_type);
+
+        if (parser->current.type != TOKEN_COMMA) {
+            break;
+        }
+
+        advance(parser, scanner);
+    }
+
+    return expr_list;
+}
+
+static int64_t parse_limit_value(struct Parser *parser, struct Scanner *scanner) {
+    // LIMIT and OFFSET take integer literals
+    if (parser->current.type != TOKEN_NUMBER) {
+        error_at_current(parser, "Expected a number.");
+    }
+
+    int64_t value = string_to_int(parser->current.start, parser->current.length);
+    advance(parser, scanner);
+    return value;
+}
+
 static struct SelectStatement *parse_select(struct Parser *parser, struct Scanner *scanner) {
     consume(parser, scanner, TOKEN_SELECT, "Expected 'SELECT'.");
     struct ExprList *select_expr_list = parse_comma_separated_expression_list(parser, scanner);
@@ -347,14 +430,52 @@ static struct SelectStatement *parse_select(struct Parser *parser, struct Scanne
     struct ExprList *where_expr_list = NULL;
     if (parser->current.type == TOKEN_WHERE) {
         advance(parser, scanner);
-        where_expr_list = parse_comma_separated_expression_list(parser, scanner);
+        where_expr_list = parse_and_separated_expression_list(parser, scanner);
         fprintf(stderr, "Where has %d expression\n", (int)where_expr_list->count);
     }
+
+    struct ExprList *group_by_expr_list = NULL;
+    if (parser->current.type == TOKEN_GROUP) {
+        advance(parser, scanner);
+        consume(parser, scanner, TOKEN_BY, "Expected 'BY'.");
+        group_by_expr_list = parse_comma_separated_expression_list(parser, scanner);
+    }
+
+    struct ExprList *order_by_expr_list = NULL;
+    struct SortTypeList *order_by_sort = NULL;
+    if (parser->current.type == TOKEN_ORDER) {
+        advance(parser, scanner);
+        consume(parser, scanner, TOKEN_BY, "Expected 'BY'.");
+        order_by_sort = vector_sort_type_list_new();
+        order_by_expr_list = parse_order_by_list(parser, scanner, order_by_sort);
+    }
+
+    int64_t limit = -1;
+    int64_t offset = 0;
+    if (parser->current.type == TOKEN_LIMIT) {
+        advance(parser, scanner);
+        limit = parse_limit_value(parser, scanner);
+
+        if (parser->current.type == TOKEN_OFFSET) {
+            advance(parser, scanner);
+            offset = parse_limit_value(parser, scanner);
+        } else if (parser->current.type == TOKEN_COMMA) {
+            // LIMIT offset, count
+            advance(parser, scanner);
+            offset = limit;
+            limit = parse_limit_value(parser, scanner);
+        }
+    }
     
     return make_select_statement(
         from_table,
         select_expr_list,
-        where_expr_list
+        where_expr_list,
+        group_by_expr_list,
+        order_by_expr_list,
+        order_by_sort,
+        limit,
+        offset
     );
 }
 
@@ -905,6 +1026,7 @@ static struct NewExprFunctionArgs *parse_function_arguments(struct Parser *parse
         // empty
     } else if (parser->current.type == TOKEN_STAR) {
         temp.star = true;
+        advance(parser, scanner);
     } else {
 
         // Expr
@@ -1178,6 +1300,7 @@ static struct NewExprFunction *parse_function(struct Parser *parser, struct Scan
     };
 
     temp.name = unterminated_string_from_current_token(parser);
+    advance(parser, scanner);
 
     consume(parser, scanner, TOKEN_LEFT_PAREN, "Expected '('.");
     temp.args = parse_function_arguments(parser, scanner);
@@ -2103,6 +2226,14 @@ static struct NewExprBinary *parse_binary_expr(struct Parser *parser, struct Sca
             temp.op = BIN_LESS;
             break;
 
+        case TOKEN_GREATER_EQUAL:
+            temp.op = BIN_GREATER_EQUAL;
+            break;
+
+        case TOKEN_LESS_EQUAL:
+            temp.op = BIN_LESS_EQUAL;
+            break;
+
         default:
             error_at_current(parser, "Expected binary operator");
     }
@@ -2200,9 +2331,17 @@ static struct NewExprBinary *parse_new_binary_expr(struct Parser *parser, struct
         case TOKEN_GREATER:
             temp.op = BIN_GREATER;
             break;
+
+        case TOKEN_LESS_EQUAL:
+            temp.op = BIN_LESS_EQUAL;
+            break;
+
+        case TOKEN_GREATER_EQUAL:
+            temp.op = BIN_GREATER_EQUAL;
+            break;
         
         default:
-            error_at_current(parser, "Expected '=', '<' or '>'.");
+            error_at_current(parser, "Expected '=', '<', '>', '<=' or '>='.");
     }
 
     advance(parser, scanner);
@@ -0,0 +1,311 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "accumulator.h"
+#include "../comparisons.h"
+
+// Text used as a number, like sqlite: a whole integer stays one, anything else is a float
+#define MAX_NUMERIC_TEXT (64)
+
+static size_t store_text(struct ArenaAllocator *arena, struct UnterminatedString *text) {
+    char *copy = arena_alloc_aligned_checked(arena, text->len > 0 ? text->len : 1, 1);
+    memcpy(copy, text->start, text->len);
+    return (size_t)((unsigned char *)copy - arena->buffer);
+}
+
+void stored_value_set(struct ArenaAllocator *arena, struct StoredValue *stored, struct Value *value) {
+    // Text reuses the bytes of the value stored before it when it fits, so a MIN or MAX
+    // that keeps changing does not keep taking arena space
+    switch (value->type) {
+        case VALUE_NULL:
+            stored->type = VALUE_NULL;
+            break;
+
+        case VALUE_INT:
+            stored->type        = VALUE_INT;
+            stored->int_value   = value->int_value.value;
+            break;
+
+        case VALUE_FLOAT:
+            stored->type        = VALUE_FLOAT;
+            stored->float_value = value->float_value.value;
+            break;
+
+        case VALUE_TEXT: {
+            struct UnterminatedString *text = &value->text_value.text;
+            if (text->len > UINT32_MAX) {
+                fprintf(stderr, "stored_value_set: text of %zu bytes is too long\n", text->len);
+                exit(1);
+            }
+
+            if (stored->type == VALUE_TEXT && text->len <= stored->text_len) {
+                memcpy(arena->buffer + stored->text_offset, text->start, text->len);
+            } else {
+                stored->text_offset = store_text(arena, text);
+            }
+
+            stored->type        = VALUE_TEXT;
+            stored->text_len    = (uint32_t)text->len;
+            break;
+        }
+    }
+}
+
+void stored_value_get(struct ArenaAllocator *arena, struct StoredValue *stored, struct Value *value) {
+    // Text points into the arena, valid until the arena next grows
+    value->type = (enum ValueType)stored->type;
+
+    switch (value->type) {
+        case VALUE_NULL:
+            value->null_value.null_ptr = NULL;
+            break;
+
+        case VALUE_INT:
+            value->int_value.value = stored->int_value;
+            break;
+
+        case VALUE_FLOAT:
+            value->float_value.value = stored->float_value;
+            break;
+
+        case VALUE_TEXT:
+            value->text_value.text = (struct UnterminatedString){ .start = (const char *)arena->buffer + stored->text_offset, .len = stored->text_len };
+            break;
+    }
+}
+
+bool float_as_int(double value, int64_t *as_int) {
+    // True for a double holding a whole number in the range of an int64, which is the same
+    // group key as that integer
+    if (!(value >= -9223372036854775808.0 && value < 9223372036854775808.0)) {
+        return false;
+    }
+
+    *as_int = (int64_t)value;
+    return (double)*as_int == value;
+}
+
+bool stored_value_equals(struct ArenaAllocator *arena, struct StoredValue *stored, struct Value *value) {
+    // Group keys are equal when they have the same value, numbers compare as numbers whatever
+    // their type and NULLs form one group
+    int64_t as_int;
+
+    if (stored->type == VALUE_INT && value->type == VALUE_FLOAT) {
+        return float_as_int(value->float_value.value, &as_int) && as_int == stored->int_value;
+    }
+
+    if (stored->type == VALUE_FLOAT && value->type == VALUE_INT) {
+        return float_as_int(stored->float_value, &as_int) && as_int == value->int_value.value;
+    }
+
+    if (stored->type != value->type) {
+        return false;
+    }
+
+    switch (value->type) {
+        case VALUE_NULL:
+            return true;
+
+        case VALUE_INT:
+            return stored->int_value == value->int_value.value;
+
+        case VALUE_FLOAT:
+            return stored->float_value == value->float_value.value;
+
+        case VALUE_TEXT:
+            return stored->text_len == value->text_value.text.len
+                && memcmp(arena->buffer + stored->text_offset, value->text_value.text.start, stored->text_len) == 0;
+    }
+
+    return false;
+}
+
+bool aggregate_argument(struct Expr *aggregate, size_t *column) {
+    // Row position of the column an aggregate reads, false for COUNT(*)
+    struct ExprList *args = aggregate->function.args;
+
+    if (args == NULL || args->count != 1) {
+        fprintf(stderr, "aggregate_argument: %s takes one argument\n", aggregate->function.name);
+        exit(1);
+    }
+
+    switch (args->data[0].type) {
+        case EXPR_STAR:
+            if (aggregate->function.agg_type != AGG_COUNT) {
+                fprintf(stderr, "aggregate_argument: only count takes *\n");
+                exit(1);
+            }
+            return false;
+
+        case EXPR_COLUMN:
+            *column = args->data[0].column.idx;
+            return true;
+
+        default:
+            fprintf(stderr, "aggregate_argument: %s only takes a column\n", aggregate->function.name);
+            exit(1);
+    }
+}
+
+void accumulator_init(struct Accumulator *accumulator) {
+    memset(accumulator, 0, sizeof *accumulator);
+    accumulator->extreme.type = VALUE_NULL;
+}
+
+static int compare_stored(struct ArenaAllocator *arena, struct StoredValue *stored, struct Value *value) {
+    struct Value other;
+    stored_value_get(arena, stored, &other);
+    return compare_index_key(value, &other);
+}
+
+static void add_text_to_sum(struct Accumulator *accumulator, struct UnterminatedString *text) {
+    char number[MAX_NUMERIC_TEXT];
+    char *end;
+
+    size_t len = text->len < MAX_NUMERIC_TEXT - 1 ? text->len : MAX_NUMERIC_TEXT - 1;
+    memcpy(number, text->start, len);
+    number[len] = '\0';
+
+    errno = 0;
+    long long int_value = strtoll(number, &end, 10);
+    if (len > 0 && *end == '\0' && errno == 0 && len == text->len) {
+        struct Value value = { .type = VALUE_INT, .int_value.value = int_value };
+        accumulator_add(accumulator, NULL, AGG_SUM, &value);
+        return;
+    }
+
+    double float_value = strtod(number, &end);
+    accumulator->sum.float_sum  += len > 0 && *end == '\0' && len == text->len ? float_value : 0.0;
+    accumulator->sum.is_float   = true;
+    accumulator->count++;
+}
+
+void accumulator_add(struct Accumulator *accumulator, struct ArenaAllocator *arena, enum AggType type, struct Value *value) {
+    // The arena holds the text of MIN and MAX, no other aggregate uses it
+    if (value->type == VALUE_NULL) {
+        return;
+    }
+
+    switch (type) {
+        case AGG_COUNT:
+            accumulator->count++;
+            break;
+
+        case AGG_SUM:
+        case AGG_AVG:
+            if (value->type == VALUE_INT) {
+                if (__builtin_add_overflow(accumulator->sum.int_sum, value->int_value.value, &accumulator->sum.int_sum)) {
+                    fprintf(stderr, "accumulator_add: integer overflow\n");
+                    exit(1);
+                }
+                accumulator->count++;
+            } else if (value->type == VALUE_FLOAT) {
+                accumulator->sum.float_sum  += value->float_value.value;
+                accumulator->sum.is_float   = true;
+                accumulator->count++;
+            } else {
+                add_text_to_sum(accumulator, &value->text_value.text);
+            }
+            break;
+
+        case AGG_MIN:
+        case AGG_MAX: {
+            int cmp = accumulator->extreme.type == VALUE_NULL ? 0 : compare_stored(arena, &accumulator->extreme, value);
+            if (accumulator->extreme.type == VALUE_NULL || (type == AGG_MIN ? cmp < 0 : cmp > 0)) {
+                stored_value_set(arena, &accumulator->extreme, value);
+            }
+            accumulator->count++;
+            break;
+        }
+
+        default:
+            fprintf(stderr, "accumulator_add: unknown aggregate %d\n", type);
+            exit(1);
+    }
+}
+
+void accumulator_add_ints(struct Accumulator *accumulator, struct ArenaAllocator *arena, enum AggType type, struct IntSummary *summary) {
+    // Adds every integer of a batch column at once. The values that are not integers are
+    // only counted here, other aggregates have to add them one at a time.
+    switch (type) {
+        case AGG_COUNT:
+            accumulator->count += summary->int_count + summary->other_count;
+            break;
+
+        case AGG_SUM:
+        case AGG_AVG: {
+            __int128 sum = (__int128)accumulator->sum.int_sum + summary->sum;
+            if (sum > INT64_MAX || sum < INT64_MIN) {
+                fprintf(stderr, "accumulator_add_ints: integer overflow\n");
+                exit(1);
+            }
+
+            accumulator->sum.int_sum    = (int64_t)sum;
+            accumulator->count          += summary->int_count;
+            break;
+        }
+
+        case AGG_MIN:
+        case AGG_MAX:
+            if (summary->int_count > 0) {
+                struct Value value = { .type = VALUE_INT, .int_value.value = type == AGG_MIN ? summary->min : summary->max };
+                accumulator_add(accumulator, arena, type, &value);
+            }
+            break;
+
+        default:
+            fprintf(stderr, "accumulator_add_ints: unknown aggregate %d\n", type);
+            exit(1);
+    }
+}
+
+void accumulator_add_rows(struct Accumulator *accumulator, int64_t count) {
+    // COUNT(*)
+    accumulator->count += count;
+}
+
+void accumulator_result(struct Accumulator *accumulator, struct ArenaAllocator *arena, enum AggType type, struct Value *result) {
+    switch (type) {
+        case AGG_COUNT:
+            result->type            = VALUE_INT;
+            result->int_value.value = accumulator->count;
+            break;
+
+        case AGG_SUM:
+            if (accumulator->count == 0) {
+                result->type = VALUE_NULL;
+            } else if (accumulator->sum.is_float) {
+                result->type                = VALUE_FLOAT;
+                result->float_value.value   = (double)accumulator->sum.int_sum + accumulator->sum.float_sum;
+            } else {
+                result->type            = VALUE_INT;
+                result->int_value.value = accumulator->sum.int_sum;
+            }
+            break;
+
+        case AGG_AVG:
+            if (accumulator->count == 0) {
+                result->type = VALUE_NULL;
+            } else {
+                result->type                = VALUE_FLOAT;
+                result->float_value.value   = ((double)accumulator->sum.int_sum + accumulator->sum.float_sum) / (double)accumulator->count;
+            }
+            break;
+
+        case AGG_MIN:
+        case AGG_MAX:
+            stored_value_get(arena, &accumulator->extreme, result);
+            break;
+
+        default:
+            fprintf(stderr, "accumulator_result: unknown aggregate %d\n", type);
+            exit(1);
+    }
+
+    if (result->type == VALUE_NULL) {
+        result->null_value.null_ptr = NULL;
+    }
+}
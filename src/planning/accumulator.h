@@ -0,0 +1,57 @@
+#ifndef sql_accumulator
+#define sql_accumulator
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../arena.h"
+#include "../ast.h"
+#include "../data_parsing/row_parsing.h"
+
+// A value kept in an arena. Text is copied into the arena and found by its offset, the
+// arena moves when it grows so a pointer into it would not stay valid.
+struct StoredValue {
+    uint8_t     type;           // enum ValueType
+    uint32_t    text_len;
+    union {
+        int64_t int_value;
+        double  float_value;
+        size_t  text_offset;
+    };
+};
+
+// Running state of one aggregate. COUNT(*) counts rows, every other aggregate skips NULLs.
+struct Accumulator {
+    int64_t                 count;      // Values added
+    union {
+        struct {
+            int64_t         int_sum;
+            double          float_sum;
+            bool            is_float;   // Set once a value is not an integer
+        } sum;                          // SUM and AVG
+        struct StoredValue  extreme;    // MIN and MAX, VALUE_NULL until a value is added
+    };
+};
+
+// The integers of one column of a batch, folded by the batch kernels in aggregate_kernels.c
+struct IntSummary {
+    int64_t     int_count;
+    int64_t     other_count;    // Values that are neither NULL nor integers
+    __int128    sum;            // Wide enough that a batch cannot overflow it
+    int64_t     min;            // INT64_MAX without integers
+    int64_t     max;            // INT64_MIN without integers
+};
+
+void stored_value_set(struct ArenaAllocator *arena, struct StoredValue *stored, struct Value *value);
+void stored_value_get(struct ArenaAllocator *arena, struct StoredValue *stored, struct Value *value);
+bool float_as_int(double value, int64_t *as_int);
+bool stored_value_equals(struct ArenaAllocator *arena, struct StoredValue *stored, struct Value *value);
+
+bool aggregate_argument(struct Expr *aggregate, size_t *column);
+void accumulator_init(struct Accumulator *accumulator);
+void accumulator_add(struct Accumulator *accumulator, struct ArenaAllocator *arena, enum AggType type, struct Value *value);
+void accumulator_add_ints(struct Accumulator *accumulator, struct ArenaAllocator *arena, enum AggType type, struct IntSummary *summary);
+void accumulator_add_rows(struct Accumulator *accumulator, int64_t count);
+void accumulator_result(struct Accumulator *accumulator, struct ArenaAllocator *arena, enum AggType type, struct Value *result);
+
+#endif
@@ -5,8 +5,31 @@
 #include "../ast.h"
 #include "plan.h"
 #include "../data_parsing/row_parsing.h"
+#include "column_batch.h"
+#include "aggregate_kernels.h"
 
+#define INITIAL_TEXT_ARENA_CAPACITY (1024)
 
+static void collect_summary_columns(struct Aggregate *aggregate) {
+    // Aggregates over the same column share one summary, so SUM(a), MIN(a) and MAX(a)
+    // read the column once per batch
+    for (size_t i = 0; i < aggregate->aggregates->count; i++) {
+        if (!aggregate->has_column[i]) {
+            continue;
+        }
+
+        size_t position = 0;
+        while (position < aggregate->summary_count && aggregate->summary_columns[position] != aggregate->columns[i]) {
+            position++;
+        }
+
+        if (position == aggregate->summary_count) {
+            aggregate->summary_columns[aggregate->summary_count++] = aggregate->columns[i];
+        }
+
+        aggregate->summary_of[i] = position;
+    }
+}
 
 struct Plan *make_aggregate(struct Plan *plan, struct ExprList *aggregates) {
     struct Aggregate *aggregate = malloc(sizeof(struct Aggregate));
@@ -15,63 +38,156 @@ struct Plan *make_aggregate(struct Plan *plan, struct ExprList *aggregates) {
         exit(1);
     }
 
+    size_t count = aggregates->count;
+
     memset(aggregate, 0, sizeof *aggregate);
     aggregate->base.type            = PLAN_AGGREGATE;
     aggregate->child                = plan;
     aggregate->done                 = false;
     aggregate->aggregates           = aggregates;
+    aggregate->accumulators         = malloc(count * sizeof(struct Accumulator));
+    aggregate->text_arena           = arena_new(INITIAL_TEXT_ARENA_CAPACITY);
+    aggregate->columns              = malloc(count * sizeof(size_t));
+    aggregate->has_column           = malloc(count * sizeof(bool));
+    aggregate->summary_of           = malloc(count * sizeof(size_t));
+    aggregate->summary_columns      = malloc(count * sizeof(size_t));
+    aggregate->summaries            = malloc(count * sizeof(struct IntSummary));
+    aggregate->results              = malloc(count * sizeof(struct Value));
+
+    if (!aggregate->accumulators || !aggregate->text_arena.buffer || !aggregate->columns || !aggregate->has_column
+        || !aggregate->summary_of || !aggregate->summary_columns || !aggregate->summaries || !aggregate->results) {
+        fprintf(stderr, "make_aggregate: malloc failed\n");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        if (aggregates->data[i].type != EXPR_FUNCTION) {
+            fprintf(stderr, "Aggregate should be function.\n");
+            exit(1);
+        }
+
+        aggregate->has_column[i] = aggregate_argument(&aggregates->data[i], &aggregate->columns[i]);
+        accumulator_init(&aggregate->accumulators[i]);
+    }
+
+    collect_summary_columns(aggregate);
     return &aggregate->base;
 }
 
+static void finish(struct Aggregate *aggregate, struct Row *row) {
+    // results belongs to the aggregate from here on, like rows from a scan belong to the scan
+    for (size_t i = 0; i < aggregate->aggregates->count; i++) {
+        accumulator_result(
+            &aggregate->accumulators[i],
+            &aggregate->text_arena,
+            aggregate->aggregates->data[i].function.agg_type,
+            &aggregate->results[i]
+        );
+    }
+
+    aggregate->done     = true;
+    row->rowid          = 0;
+    row->column_count   = aggregate->aggregates->count;
+    row->values         = aggregate->results;
+}
+
 bool aggregate_next(struct Pager *pager, struct Aggregate *aggregate, struct Row *row) {
     // Keep consuming rows until aggregation complete
     if (aggregate->done) {
         return false;
     }
 
-    struct Value *results = malloc(sizeof(struct Value) * aggregate->aggregates->count);
-    if (!results) {
-        fprintf(stderr, "aggregate_next: *results malloc failed\n");
-        exit(1);
+    while (plan_next(pager, aggregate->child, row)) {
+        for (size_t i = 0; i < aggregate->aggregates->count; i++) {
+            if (!aggregate->has_column[i]) {
+                accumulator_add_rows(&aggregate->accumulators[i], 1);
+                continue;
+            }
+
+            accumulator_add(
+                &aggregate->accumulators[i],
+                &aggregate->text_arena,
+                aggregate->aggregates->data[i].function.agg_type,
+                &row->values[aggregate->columns[i]]
+            );
+        }
     }
 
-    for (size_t i = 0; i < aggregate->aggregates->count; i++) {
-        results[i].type                 = VALUE_NULL;
-        results[i].null_value.null_ptr  = NULL;
+    finish(aggregate, row);
+    return true;
+}
+
+static void add_other_values(struct Aggregate *aggregate, size_t index, struct ColumnBatch *input, bool with_ints) {
+    // The values of a column that are neither NULL nor integers, one at a time, or with
+    // with_ints every value that is not NULL
+    struct ColumnVector *vector = input->columns[aggregate->columns[index]];
+    uint8_t skipped = with_ints ? VALUE_NULL : VALUE_INT;
+
+    for (uint32_t i = 0; i < input->selected_count; i++) {
+        uint16_t position = input->selection[i];
+        if (vector->types[position] <= skipped) {
+            continue;
+        }
+
+        struct Value value;
+        column_batch_get_value(input, (uint32_t)aggregate->columns[index], position, &value);
+        accumulator_add(&aggregate->accumulators[index], &aggregate->text_arena, aggregate->aggregates->data[index].function.agg_type, &value);
     }
-    
-    while (plan_next(pager, aggregate->child, row)) {
+}
 
-        for (size_t i = 0; i < aggregate->aggregates->count; i++) {
-            struct Expr *current_aggregate = &aggregate->aggregates->data[i];
-            if (current_aggregate->type != EXPR_FUNCTION) {
-                fprintf(stderr, "Aggregate should be function.\n");
-                exit(1);
-            }
+static void add_batch(struct Aggregate *aggregate, struct ColumnBatch *input) {
+    for (size_t i = 0; i < aggregate->summary_count; i++) {
+        summarise_batch_ints(input, (uint32_t)aggregate->summary_columns[i], &aggregate->summaries[i]);
+    }
+
+    for (size_t i = 0; i < aggregate->aggregates->count; i++) {
+        struct Accumulator *accumulator = &aggregate->accumulators[i];
+        enum AggType type = aggregate->aggregates->data[i].function.agg_type;
 
-            struct Value *value = &results[i];
-            switch (current_aggregate->function.agg_type) {
+        if (!aggregate->has_column[i]) {
+            accumulator_add_rows(accumulator, input->selected_count);
+            continue;
+        }
 
-                case AGG_COUNT:
-                    value->type = VALUE_INT;
-                    value->int_value.value++;
-                    break;
+        struct IntSummary *summary = &aggregate->summaries[aggregate->summary_of[i]];
 
-                default:
-                    fprintf(stderr, "Do not recognise aggregate %d.\n", current_aggregate->function.agg_type);
-                    exit(1);
-            }
+        // MIN and MAX keep the first of equal values, an integer and a float holding the same
+        // number, so a column with other values is taken in row order
+        if (summary->other_count > 0 && (type == AGG_MIN || type == AGG_MAX)) {
+            add_other_values(aggregate, i, input, true);
+            continue;
         }
 
+        accumulator_add_ints(accumulator, &aggregate->text_arena, type, summary);
+
+        // COUNT already counted them
+        if (summary->other_count > 0 && type != AGG_COUNT) {
+            add_other_values(aggregate, i, input, false);
+        }
+    }
+}
+
+bool aggregate_next_batch(struct Pager *pager, struct Aggregate *aggregate, struct ColumnBatch **batch) {
+    // Consumes every batch of the child, then hands out one batch holding the single result row
+    if (aggregate->done) {
+        return false;
     }
 
-    aggregate->done = true;
+    struct ColumnBatch *input;
+    while (plan_next_batch(pager, aggregate->child, &input)) {
+        add_batch(aggregate, input);
+    }
 
-    free(row->values);
-    row->column_count   = aggregate->aggregates->count;
-    row->values         = results;
+    struct Row row;
+    finish(aggregate, &row);
 
-    // @TODO: Aggregate results need to be written somewhere
+    if (aggregate->base.batch == NULL) {
+        aggregate->base.batch = column_batch_new((uint32_t)aggregate->aggregates->count);
+    }
+
+    column_batch_reset(aggregate->base.batch);
+    column_batch_append_row(aggregate->base.batch, &row, NULL);
 
+    *batch = aggregate->base.batch;
     return true;
-}
\ No newline at end of file
+}
@@ -2,15 +2,30 @@
 #define sql_aggregate
 
 #include "plan.h"
+#include "../arena.h"
+#include "accumulator.h"
 
+// Aggregates without a GROUP BY, one row out. In batch execution the integers of each
+// argument column are summarised once per batch and every aggregate over that column
+// takes the summary, values of other types are added one at a time.
 struct Aggregate {
-    struct Plan     base;
-    struct Plan     *child;
-    bool            done;
-    struct ExprList *aggregates;
+    struct Plan             base;
+    struct Plan             *child;
+    bool                    done;
+    struct ExprList         *aggregates;
+    struct Accumulator      *accumulators;
+    struct ArenaAllocator   text_arena;     // Text of MIN and MAX
+    size_t                  *columns;       // Column each aggregate reads, unused for COUNT(*)
+    bool                    *has_column;
+    size_t                  *summary_of;    // Position in summary_columns of the column each aggregate reads
+    size_t                  *summary_columns;   // Distinct columns the aggregates read
+    size_t                  summary_count;
+    struct IntSummary       *summaries;
+    struct Value            *results;
 };
 
 struct Plan *make_aggregate(struct Plan *plan, struct ExprList *aggregates);
 bool aggregate_next(struct Pager *pager, struct Aggregate *aggregate, struct Row *row);
+bool aggregate_next_batch(struct Pager *pager, struct Aggregate *aggregate, struct ColumnBatch **batch);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "aggregate_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86
+#include <immintrin.h>
+#endif
+
+// Below this magnitude BATCH_SIZE values cannot overflow a 64-bit lane of partial sums
+#define LANE_SAFE_MAGNITUDE (INT64_MAX / BATCH_SIZE)
+
+static void summary_init(struct IntSummary *summary) {
+    summary->int_count      = 0;
+    summary->other_count    = 0;
+    summary->sum            = 0;
+    summary->min            = INT64_MAX;
+    summary->max            = INT64_MIN;
+}
+
+// Scalar kernel, the fallback on every CPU and the tail of the vector kernel. Written
+// without branches on the values, so a column mixing NULLs and integers costs the same.
+// The sum wraps in 64 bits like the vector lanes and is only taken in 128 bits when a
+// value is large enough to overflow it.
+
+static __int128 exact_sum(const uint8_t *types, const int64_t *values, uint32_t start, uint32_t count) {
+    __int128 sum = 0;
+    for (uint32_t i = start; i < count; i++) {
+        sum += types[i] == VALUE_INT ? values[i] : 0;
+    }
+    return sum;
+}
+
+static void summarise_ints_tail(const uint8_t *types, const int64_t *values, uint32_t start, uint32_t count, struct IntSummary *summary) {
+    uint64_t sum = 0;
+    int64_t int_count = 0;
+    int64_t other_count = 0;
+    int64_t min = INT64_MAX;
+    int64_t max = INT64_MIN;
+
+    for (uint32_t i = start; i < count; i++) {
+        int64_t is_int = types[i] == VALUE_INT;
+        int64_t value = values[i];
+
+        sum         += (uint64_t)(value & -is_int);
+        int_count   += is_int;
+        other_count += types[i] > VALUE_INT;
+        min         = is_int && value < min ? value : min;
+        max         = is_int && value > max ? value : max;
+    }
+
+    bool sum_exact = int_count == 0 || (min >= -LANE_SAFE_MAGNITUDE && max <= LANE_SAFE_MAGNITUDE);
+
+    summary->sum            += sum_exact ? (__int128)(int64_t)sum : exact_sum(types, values, start, count);
+    summary->int_count      += int_count;
+    summary->other_count    += other_count;
+    summary->min            = min < summary->min ? min : summary->min;
+    summary->max            = max > summary->max ? max : summary->max;
+}
+
+static void summarise_ints_scalar(const uint8_t *types, const int64_t *values, uint32_t count, struct IntSummary *summary) {
+    summary_init(summary);
+    summarise_ints_tail(types, values, 0, count, summary);
+}
+
+#ifdef KERNELS_X86
+
+// AVX2 kernel, four 64-bit lanes. Each lane keeps its own sum, count, minimum and maximum,
+// folded together after the loop. Lane sums wrap on overflow, so when a value is large
+// enough for that to be possible the sum is taken again in 128 bits.
+
+__attribute__((target("avx2")))
+static void summarise_ints_avx2(const uint8_t *types, const int64_t *values, uint32_t count, struct IntSummary *summary) {
+    __m256i int_type    = _mm256_set1_epi64x(VALUE_INT);
+    __m256i null_type   = _mm256_set1_epi64x(VALUE_NULL);
+    __m256i sums        = _mm256_setzero_si256();
+    __m256i ints        = _mm256_setzero_si256();
+    __m256i nulls       = _mm256_setzero_si256();
+    __m256i mins        = _mm256_set1_epi64x(INT64_MAX);
+    __m256i maxs        = _mm256_set1_epi64x(INT64_MIN);
+    uint32_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        int32_t packed_types;
+        memcpy(&packed_types, types + i, sizeof packed_types);
+
+        __m256i lane_types  = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(packed_types));
+        __m256i is_int      = _mm256_cmpeq_epi64(lane_types, int_type);
+        __m256i v           = _mm256_loadu_si256((const __m256i *)(values + i));
+
+        sums    = _mm256_add_epi64(sums, _mm256_and_si256(v, is_int));
+        ints    = _mm256_sub_epi64(ints, is_int);
+        nulls   = _mm256_sub_epi64(nulls, _mm256_cmpeq_epi64(lane_types, null_type));
+
+        // Lanes that are not integers compare with the current extreme in place of v
+        __m256i low     = _mm256_blendv_epi8(mins, v, is_int);
+        __m256i high    = _mm256_blendv_epi8(maxs, v, is_int);
+        mins    = _mm256_blendv_epi8(mins, low, _mm256_cmpgt_epi64(mins, low));
+        maxs    = _mm256_blendv_epi8(maxs, high, _mm256_cmpgt_epi64(high, maxs));
+    }
+
+    int64_t lane_sums[4], lane_ints[4], lane_nulls[4], lane_mins[4], lane_maxs[4];
+    _mm256_storeu_si256((__m256i *)lane_sums, sums);
+    _mm256_storeu_si256((__m256i *)lane_ints, ints);
+    _mm256_storeu_si256((__m256i *)lane_nulls, nulls);
+    _mm256_storeu_si256((__m256i *)lane_mins, mins);
+    _mm256_storeu_si256((__m256i *)lane_maxs, maxs);
+
+    summary_init(summary);
+    int64_t null_count = 0;
+
+    for (int lane = 0; lane < 4; lane++) {
+        summary->sum        += lane_sums[lane];
+        summary->int_count  += lane_ints[lane];
+        null_count          += lane_nulls[lane];
+        summary->min        = lane_mins[lane] < summary->min ? lane_mins[lane] : summary->min;
+        summary->max        = lane_maxs[lane] > summary->max ? lane_maxs[lane] : summary->max;
+    }
+
+    summary->other_count = (int64_t)i - summary->int_count - null_count;
+
+    if (summary->int_count > 0 && (summary->min < -LANE_SAFE_MAGNITUDE || summary->max > LANE_SAFE_MAGNITUDE)) {
+        summary->sum = exact_sum(types, values, 0, i);
+    }
+
+    summarise_ints_tail(types, values, i, count, summary);
+}
+
+#endif
+
+static const struct AggregateKernels KERNELS[] = {
+    [KERNEL_SCALAR] = { KERNEL_SCALAR, "scalar", summarise_ints_scalar },
+#ifdef KERNELS_X86
+    // SSE4.2 has no 64-bit blend or minimum worth the lane shuffling, it keeps the scalar kernel
+    [KERNEL_SSE42]  = { KERNEL_SSE42, "scalar", summarise_ints_scalar },
+    [KERNEL_AVX2]   = { KERNEL_AVX2, "avx2", summarise_ints_avx2 },
+#endif
+};
+
+const struct AggregateKernels *aggregate_kernels(void) {
+    // The filter kernels have already asked the CPU which level it runs
+    return &KERNELS[filter_kernels()->level];
+}
+
+const struct AggregateKernels *aggregate_kernels_for_level(enum KernelLevel level) {
+    return filter_kernels_for_level(level) != NULL ? &KERNELS[level] : NULL;
+}
+
+void summarise_batch_ints(struct ColumnBatch *batch, uint32_t column, struct IntSummary *summary) {
+    // A batch nothing filtered is summarised in place, the selected rows of any other are
+    // gathered into a dense copy first
+    struct ColumnVector *vector = batch->columns[column];
+
+    if (batch->selected_count == batch->row_count) {
+        aggregate_kernels()->summarise_ints(vector->types, vector->ints, batch->row_count, summary);
+        return;
+    }
+
+    uint8_t types[BATCH_SIZE];
+    int64_t values[BATCH_SIZE];
+
+    for (uint32_t i = 0; i < batch->selected_count; i++) {
+        uint16_t r = batch->selection[i];
+        types[i]    = vector->types[r];
+        values[i]   = vector->ints[r];
+    }
+
+    aggregate_kernels()->summarise_ints(types, values, batch->selected_count, summary);
+}
@@ -0,0 +1,24 @@
+#ifndef sql_aggregate_kernels
+#define sql_aggregate_kernels
+
+#include <stdint.h>
+
+#include "accumulator.h"
+#include "column_batch.h"
+#include "filter_kernels.h"
+
+// Reductions of a column of a batch, every aggregate over the column is answered from the
+// one summary. The levels are the same as the filter kernels'.
+struct AggregateKernels {
+    enum KernelLevel    level;
+    const char          *name;
+    // The first count rows of a column, count is at most BATCH_SIZE
+    void                (*summarise_ints)(const uint8_t *types, const int64_t *values, uint32_t count, struct IntSummary *summary);
+};
+
+const struct AggregateKernels *aggregate_kernels(void);
+const struct AggregateKernels *aggregate_kernels_for_level(enum KernelLevel level);
+
+void summarise_batch_ints(struct ColumnBatch *batch, uint32_t column, struct IntSummary *summary);
+
+#endif
@@ -0,0 +1,253 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "column_batch.h"
+
+#define INITIAL_BATCH_BYTES (4096)
+
+static void column_batch_grow(struct ColumnBatch *batch, uint32_t column_count) {
+    // Vectors start out all NULL, columns a mask leaves out are never written and stay that way
+    if (column_count > batch->column_capacity) {
+        struct ColumnVector **columns = realloc(batch->columns, column_count * sizeof(struct ColumnVector *));
+        if (!columns) {
+            fprintf(stderr, "column_batch_grow: columns realloc failed\n");
+            exit(1);
+        }
+
+        batch->columns          = columns;
+        batch->column_capacity  = column_count;
+    }
+
+    for (uint32_t i = batch->column_count; i < column_count; i++) {
+        batch->columns[i] = batch->is_view ? NULL : calloc(1, sizeof(struct ColumnVector));
+        if (!batch->is_view && !batch->columns[i]) {
+            fprintf(stderr, "column_batch_grow: vector calloc failed\n");
+            exit(1);
+        }
+    }
+
+    batch->column_count = column_count;
+}
+
+static struct ColumnBatch *column_batch_alloc(uint32_t column_count, bool is_view) {
+    struct ColumnBatch *batch = malloc(sizeof(struct ColumnBatch));
+    if (!batch) {
+        fprintf(stderr, "column_batch_alloc: *batch malloc failed\n");
+        exit(1);
+    }
+
+    memset(batch, 0, sizeof *batch);
+    batch->is_view      = is_view;
+    batch->selection    = batch->selection_storage;
+    batch->rowids       = batch->rowid_storage;
+
+    column_batch_grow(batch, column_count);
+    return batch;
+}
+
+struct ColumnBatch *column_batch_new(uint32_t column_count) {
+    return column_batch_alloc(column_count, false);
+}
+
+struct ColumnBatch *column_batch_new_view(uint32_t column_count) {
+    // The owner of the view points its columns, selection and rowids at another batch
+    return column_batch_alloc(column_count, true);
+}
+
+void column_batch_free(struct ColumnBatch *batch) {
+    if (!batch->is_view) {
+        for (uint32_t i = 0; i < batch->column_count; i++) {
+            free(batch->columns[i]);
+        }
+    }
+
+    free(batch->columns);
+    free(batch->bytes);
+    free(batch);
+}
+
+void column_batch_reset(struct ColumnBatch *batch) {
+    batch->row_count        = 0;
+    batch->selected_count   = 0;
+    batch->byte_count       = 0;
+}
+
+bool column_batch_is_full(struct ColumnBatch *batch) {
+    return batch->row_count == BATCH_SIZE;
+}
+
+static void rebase_texts(struct ColumnBatch *batch, const char *old_bytes, char *new_bytes) {
+    // Every text in the batch lies in the old byte buffer, which is still allocated, and
+    // keeps its offset in the new one
+    for (uint32_t i = 0; i < batch->column_count; i++) {
+        struct ColumnVector *vector = batch->columns[i];
+
+        for (uint32_t r = 0; r < batch->row_count; r++) {
+            if (vector->types[r] == VALUE_TEXT) {
+                vector->texts[r].start = new_bytes + (vector->texts[r].start - old_bytes);
+            }
+        }
+    }
+}
+
+static const char *copy_text(struct ColumnBatch *batch, struct UnterminatedString *text) {
+    if (batch->byte_count + text->len > batch->byte_capacity) {
+        size_t capacity = batch->byte_capacity > 0 ? batch->byte_capacity : INITIAL_BATCH_BYTES;
+        while (capacity < batch->byte_count + text->len) {
+            capacity *= 2;
+        }
+
+        // Not a realloc, the text already copied is rebased before the old buffer is freed
+        char *bytes = malloc(capacity);
+        if (!bytes) {
+            fprintf(stderr, "copy_text: bytes malloc failed\n");
+            exit(1);
+        }
+
+        if (batch->bytes != NULL) {
+            memcpy(bytes, batch->bytes, batch->byte_count);
+            rebase_texts(batch, batch->bytes, bytes);
+            free(batch->bytes);
+        }
+
+        batch->bytes            = bytes;
+        batch->byte_capacity    = capacity;
+    }
+
+    char *copy = batch->bytes + batch->byte_count;
+    memcpy(copy, text->start, text->len);
+    batch->byte_count += text->len;
+    return copy;
+}
+
+static void store_value(struct ColumnBatch *batch, struct ColumnVector *vector, uint16_t position, struct Value *value) {
+    // The type is set last, a text only counts once it points into the batch's bytes
+    switch (value->type) {
+        case VALUE_NULL:
+            break;
+
+        case VALUE_INT:
+            vector->ints[position] = value->int_value.value;
+            break;
+
+        case VALUE_FLOAT:
+            vector->floats[position] = value->float_value.value;
+            break;
+
+        case VALUE_TEXT:
+            vector->texts[position].len     = value->text_value.text.len;
+            vector->texts[position].start   = copy_text(batch, &value->text_value.text);
+            break;
+    }
+
+    vector->types[position] = (uint8_t)value->type;
+}
+
+static uint16_t add_row(struct ColumnBatch *batch, uint64_t rowid, uint64_t column_count) {
+    // New rows start out selected
+    assert(!batch->is_view);
+    assert(batch->row_count < BATCH_SIZE);
+
+    if (column_count > batch->column_count) {
+        column_batch_grow(batch, (uint32_t)column_count);
+    }
+
+    uint16_t position = (uint16_t)batch->row_count++;
+    batch->rowids[position]                     = rowid;
+    batch->selection[batch->selected_count++]   = position;
+
+    // Every column is NULL until stored, none is left holding a text of an earlier batch
+    for (uint32_t i = 0; i < batch->column_count; i++) {
+        batch->columns[i]->types[position] = VALUE_NULL;
+    }
+
+    return position;
+}
+
+void column_batch_append_row(struct ColumnBatch *batch, struct Row *row, const struct ColumnMask *mask) {
+    // Copies the columns in mask, every column without one
+    uint16_t position = add_row(batch, row->rowid, row->column_count);
+    struct Value null_value = { .type = VALUE_NULL };
+
+    for (uint32_t i = 0; i < batch->column_count; i++) {
+        if (mask != NULL && !column_mask_has(mask, i)) {
+            continue;
+        }
+
+        store_value(batch, batch->columns[i], position, i < row->column_count ? &row->values[i] : &null_value);
+    }
+}
+
+void column_batch_append_cell(struct ColumnBatch *batch, struct Pager *pager, const uint8_t *page_data, struct Cell *cell, struct RowBuffer *buffer, const struct ColumnMask *mask) {
+    // Decodes a table row straight into the columns, without building a struct Row first.
+    // Only the columns in mask are decoded, they are all decoded without one.
+    if (cell->type != TABLE_LEAF_CELL) {
+        fprintf(stderr, "column_batch_append_cell: cell on page %u is not a table row\n", cell->page_number);
+        exit(1);
+    }
+
+    uint16_t position = add_row(batch, cell->data.table_leaf_cell.row_id, mask != NULL ? mask->column_count : 0);
+    uint64_t decode_count = mask != NULL ? mask->decode_count : UINT64_MAX;
+    uint32_t column = 0;
+
+    struct RecordReader reader;
+    record_reader_open(&reader, pager, page_data, cell, buffer);
+
+    while (column < decode_count && record_reader_next(&reader)) {
+        if (column >= batch->column_count) {
+            column_batch_grow(batch, column + 1);
+        }
+
+        if (mask == NULL || column_mask_has(mask, column)) {
+            struct Value value;
+            decode_value(record_reader_data(&reader), reader.type, &value);
+            store_value(batch, batch->columns[column], position, &value);
+        }
+
+        column++;
+    }
+
+    // A short record leaves out its last columns
+    for (; column < batch->column_count; column++) {
+        if (mask == NULL || column_mask_has(mask, column)) {
+            batch->columns[column]->types[position] = VALUE_NULL;
+        }
+    }
+}
+
+void column_batch_get_value(struct ColumnBatch *batch, uint32_t column, uint16_t position, struct Value *value) {
+    struct ColumnVector *vector = batch->columns[column];
+    value->type = (enum ValueType)vector->types[position];
+
+    switch (value->type) {
+        case VALUE_NULL:
+            value->null_value.null_ptr = NULL;
+            break;
+
+        case VALUE_INT:
+            value->int_value.value = vector->ints[position];
+            break;
+
+        case VALUE_FLOAT:
+            value->float_value.value = vector->floats[position];
+            break;
+
+        case VALUE_TEXT:
+            value->text_value.text = vector->texts[position];
+            break;
+    }
+}
+
+void column_batch_get_row(struct ColumnBatch *batch, uint16_t position, struct Value *values, struct Row *row) {
+    // Gathers one row back out of the columns, values needs room for column_count values
+    for (uint32_t i = 0; i < batch->column_count; i++) {
+        column_batch_get_value(batch, i, position, &values[i]);
+    }
+
+    row->rowid          = batch->rowids[position];
+    row->column_count   = batch->column_count;
+    row->values         = values;
+}
@@ -0,0 +1,59 @@
+#ifndef sql_column_batch
+#define sql_column_batch
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../data_parsing/row_parsing.h"
+
+#define BATCH_SIZE (1024)
+
+// One column of a batch. Values are stored in the array for their type, types says which
+// array holds row r, so a kernel over integers reads ints as one dense array.
+struct ColumnVector {
+    uint8_t                     types[BATCH_SIZE];     // enum ValueType
+    int64_t                     ints[BATCH_SIZE];
+    double                      floats[BATCH_SIZE];
+    struct UnterminatedString   texts[BATCH_SIZE];
+};
+
+// Rows moved between operators by plan_next_batch, in column order. selection lists the
+// positions of the rows still in play in ascending order, filters narrow it instead of
+// moving values. A batch belongs to the operator that produced it and is valid until
+// that operator's next plan_next_batch, like a row from plan_next.
+// A view shares the vectors of another batch, a projection only picks different columns.
+struct ColumnBatch {
+    uint32_t            row_count;          // Rows filled in, selected or not
+    uint32_t            selected_count;
+    uint16_t            *selection;
+    uint64_t            *rowids;
+    uint32_t            column_count;
+    struct ColumnVector **columns;
+    bool                is_view;
+
+    // Storage of a batch that is not a view
+    uint32_t            column_capacity;
+    uint16_t            selection_storage[BATCH_SIZE];
+    uint64_t            rowid_storage[BATCH_SIZE];
+    char                *bytes;             // Text copied out of pages, which are unpinned as a scan moves on
+    size_t              byte_count;
+    size_t              byte_capacity;
+};
+
+struct ColumnBatch *column_batch_new(uint32_t column_count);
+struct ColumnBatch *column_batch_new_view(uint32_t column_count);
+void column_batch_free(struct ColumnBatch *batch);
+void column_batch_reset(struct ColumnBatch *batch);
+bool column_batch_is_full(struct ColumnBatch *batch);
+void column_batch_append_row(struct ColumnBatch *batch, struct Row *row, const struct ColumnMask *mask);
+void column_batch_append_cell(
+    struct ColumnBatch *batch,
+    struct Pager *pager,
+    const uint8_t *page_data,
+    struct Cell *cell,
+    struct RowBuffer *buffer,
+    const struct ColumnMask *mask);
+void column_batch_get_value(struct ColumnBatch *batch, uint32_t column, uint16_t position, struct Value *value);
+void column_batch_get_row(struct ColumnBatch *batch, uint16_t position, struct Value *values, struct Row *row);
+
+#endif
@@ -0,0 +1,85 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "count_scan.h"
+#include "../data_parsing/byte_reader.h"
+#include "../data_parsing/page_parsing.h"
+
+static uint64_t count_table_cells(struct Pager *pager, uint32_t root_page) {
+    // Depth first over the interior pages, only the header of each leaf is read. The children
+    // of an interior page are handed to the pager as one prefetch before they are visited.
+    struct PageNumberVec stack;
+    vector_page_number_vec_init(&stack);
+    vector_page_number_vec_push(&stack, root_page);
+
+    uint64_t count = 0;
+
+    while (stack.count > 0) {
+        uint32_t page_number = stack.data[--stack.count];
+        struct PageView view;
+        page_view_open(pager, &view, page_number);
+
+        switch (view.header.page_type) {
+
+            case PAGE_LEAF_TABLE:
+                count += view.header.number_of_cells;
+                break;
+
+            case PAGE_INTERIOR_TABLE: {
+                // Pushed right to left so the leaves are visited in file order
+                size_t first_child = stack.count;
+                vector_page_number_vec_push(&stack, view.header.right_most_pointer);
+                for (int cell = view.header.number_of_cells - 1; cell >= 0; cell--) {
+                    vector_page_number_vec_push(&stack, read_u32_big_endian(view.page->data, page_view_cell_offset(&view, (uint16_t)cell)));
+                }
+
+                if (pager->readahead_pages > 0) {
+                    pager_prefetch_pages(pager, &stack.data[first_child], (uint32_t)(stack.count - first_child));
+                }
+                break;
+            }
+
+            default:
+                fprintf(stderr, "count_table_cells: page %u is not a table page.\n", page_number);
+                exit(1);
+        }
+
+        page_view_release(&view);
+    }
+
+    vector_page_number_vec_free(&stack);
+    return count;
+}
+
+struct Plan *make_count_scan(struct Pager *pager, uint32_t root_page) {
+    struct CountScan *count_scan = malloc(sizeof(struct CountScan));
+    if (!count_scan) {
+        fprintf(stderr, "make_count_scan: *count_scan malloc failed\n");
+        exit(1);
+    }
+
+    memset(count_scan, 0, sizeof *count_scan);
+    count_scan->base.type   = PLAN_COUNT_SCAN;
+    count_scan->pager       = pager;
+    count_scan->root_page   = root_page;
+    count_scan->done        = false;
+    return &count_scan->base;
+}
+
+bool count_scan_next(struct CountScan *count_scan, struct Row *row) {
+    // One row holding the count, laid out like the row an Aggregate produces
+    if (count_scan->done) {
+        return false;
+    }
+
+    count_scan->done    = true;
+    count_scan->result  = (struct Value){ .type = VALUE_INT, .int_value = { .value = (int64_t)count_table_cells(count_scan->pager, count_scan->root_page) } };
+
+    row->rowid          = 0;
+    row->column_count   = 1;
+    row->values         = &count_scan->result;
+    return true;
+}
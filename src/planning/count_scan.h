@@ -0,0 +1,19 @@
+#ifndef sql_count_scan
+#define sql_count_scan
+
+#include "plan.h"
+
+// SELECT COUNT(*) over a whole table. Every row of a table b-tree is a cell on a leaf page,
+// so the count is the sum of the leaf pages' cell counts and no record is ever decoded.
+struct CountScan {
+    struct Plan     base;
+    struct Pager    *pager;
+    uint32_t        root_page;
+    bool            done;
+    struct Value    result;
+};
+
+struct Plan *make_count_scan(struct Pager *pager, uint32_t root_page);
+bool count_scan_next(struct CountScan *count_scan, struct Row *row);
+
+#endif
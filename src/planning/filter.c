@@ -6,6 +6,9 @@
 #include "../sql_utils.h"
 #include "../data_parsing/row_parsing.h"
 #include "plan.h"
+#include "column_batch.h"
+#include "filter_kernels.h"
+#include "../comparisons.h"
 
 
 
@@ -146,6 +149,24 @@ static bool evaluate_predicate(struct Expr *predicate, struct Row *row) {
             result = value_is_greater(&left_value, &right_value);
             break;
 
+        case BIN_LESS_EQUAL:
+            result = !value_is_greater(&left_value, &right_value) && left_value.type != VALUE_NULL;
+            break;
+
+        case BIN_GREATER_EQUAL:
+            result = !value_is_less(&left_value, &right_value) && left_value.type != VALUE_NULL;
+            break;
+
+        case BIN_BETWEEN: {
+            struct Value upper_value = expr_to_value(predicate->binary.upper, row);
+            if (left_value.type != upper_value.type || left_value.type == VALUE_NULL) {
+                return false;
+            }
+
+            result = !value_is_less(&left_value, &right_value) && !value_is_greater(&left_value, &upper_value);
+            break;
+        }
+
         default:
             fprintf(stderr, "evaluate_predicate: Op unsupported %d.\n", predicate->binary.op);
             exit(1);
@@ -171,26 +192,224 @@ struct Plan *make_filter(struct Plan *plan, struct ExprList *predicates) {
 }
 
 
+bool filter_row_matches(struct ExprList *predicates, struct Row *row) {
+    // True when the row passes every predicate, safe to call from several threads at once
+    for (size_t i = 0; i < predicates->count; i++) {
+        struct Expr *predicate = &predicates->data[i];
+        if (!evaluate_predicate(predicate, row)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 bool filter_next(struct Pager *pager, struct Filter *filter, struct Row *row) {
     // Filter rows based on predicate
     // @TODO: doesnt need to filter rows already filtered by index
     while (plan_next(pager, filter->child, row)) {
         // fprintf(stderr, "Filter\n");
-        bool predicate_success = true;
+        if (filter_row_matches(filter->predicates, row)) {
+            return true;
+        }
+    }
 
-        for (size_t i = 0; i < filter->predicates->count; i++) {
+    return false;
+}
 
-            struct Expr *predicate = &filter->predicates->data[i];
-            if (!evaluate_predicate(predicate, row)) {
-                predicate_success = false;
-                break;
-            }
+// Batch kernels. A predicate comparing a column with literals narrows the selection in one
+// pass over the column's typed array, anything else is evaluated a row at a time.
+// Integer comparisons and text equality run the SIMD kernels in filter_kernels.c.
+
+static bool is_literal(struct Expr *expr) {
+    return expr->type == EXPR_INTEGER || expr->type == EXPR_STRING;
+}
+
+static bool get_column_comparison(struct Expr *predicate, uint32_t *column, enum BinaryOp *op, struct Value *value, struct Value *upper) {
+    // column op literal, literal op column, or column BETWEEN literal AND literal
+    if (predicate->type != EXPR_BINARY) {
+        return false;
+    }
+
+    struct ExprBinary *binary = &predicate->binary;
+
+    if (binary->op == BIN_BETWEEN) {
+        if (binary->left->type != EXPR_COLUMN || !is_literal(binary->right) || !is_literal(binary->upper)) {
+            return false;
         }
 
-        if (predicate_success) {
+        *column = (uint32_t)binary->left->column.idx;
+        *op     = BIN_BETWEEN;
+        *value  = expr_to_value(binary->right, NULL);
+        *upper  = expr_to_value(binary->upper, NULL);
+        return value->type == upper->type;
+    }
+
+    if (binary->left->type == EXPR_COLUMN && is_literal(binary->right)) {
+        *column = (uint32_t)binary->left->column.idx;
+        *op     = binary->op;
+        *value  = expr_to_value(binary->right, NULL);
+        return true;
+    }
+
+    if (is_literal(binary->left) && binary->right->type == EXPR_COLUMN) {
+        *column = (uint32_t)binary->right->column.idx;
+        *op     = mirror_binary_op(binary->op);
+        *value  = expr_to_value(binary->left, NULL);
+        return true;
+    }
+
+    return false;
+}
+
+static void combine_bitmaps(uint64_t *matches, const uint64_t *bitmap, bool negate) {
+    for (size_t i = 0; i < BITMAP_WORDS; i++) {
+        matches[i] &= negate ? ~bitmap[i] : bitmap[i];
+    }
+}
+
+static uint32_t select_ints(struct ColumnBatch *batch, struct ColumnVector *vector, enum BinaryOp op, int64_t value, int64_t upper) {
+    // The kernels compare the whole column at once, the bitmap of rows that are integers
+    // and match is then applied to the selection. <= and >= are the negation of > and <.
+    const struct FilterKernels *kernels = filter_kernels();
+    uint64_t matches[BITMAP_WORDS];
+    uint64_t bitmap[BITMAP_WORDS];
+
+    kernels->match_types(vector->types, batch->row_count, VALUE_INT, matches);
+
+    switch (op) {
+        case BIN_EQUAL:
+        case BIN_LESS:
+        case BIN_GREATER:
+            kernels->compare_ints(vector->ints, batch->row_count, op, value, bitmap);
+            combine_bitmaps(matches, bitmap, false);
+            break;
+
+        case BIN_LESS_EQUAL:
+            kernels->compare_ints(vector->ints, batch->row_count, BIN_GREATER, value, bitmap);
+            combine_bitmaps(matches, bitmap, true);
+            break;
+
+        case BIN_GREATER_EQUAL:
+            kernels->compare_ints(vector->ints, batch->row_count, BIN_LESS, value, bitmap);
+            combine_bitmaps(matches, bitmap, true);
+            break;
+
+        case BIN_BETWEEN:
+            kernels->compare_ints(vector->ints, batch->row_count, BIN_LESS, value, bitmap);
+            combine_bitmaps(matches, bitmap, true);
+            kernels->compare_ints(vector->ints, batch->row_count, BIN_GREATER, upper, bitmap);
+            combine_bitmaps(matches, bitmap, true);
+            break;
+
+        default:
+            fprintf(stderr, "select_ints: Op unsupported %d.\n", op);
+            exit(1);
+    }
+
+    return bitmap_select(matches, batch->selection, batch->selected_count);
+}
+
+static uint32_t select_equal_texts(struct ColumnBatch *batch, struct ColumnVector *vector, struct UnterminatedString *value) {
+    uint64_t matches[BITMAP_WORDS];
+    text_equal_bitmap(vector, batch->row_count, value, matches);
+    return bitmap_select(matches, batch->selection, batch->selected_count);
+}
+
+static uint32_t select_texts(struct ColumnVector *vector, uint16_t *selection, uint32_t count, enum BinaryOp op, struct UnterminatedString *value, struct UnterminatedString *upper) {
+    uint32_t kept = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t r = selection[i];
+        if (vector->types[r] != VALUE_TEXT) {
+            continue;
+        }
+
+        struct UnterminatedString *text = &vector->texts[r];
+        bool matches;
+
+        switch (op) {
+            case BIN_EQUAL:         matches = unterminated_string_equals(text, value); break;
+            case BIN_LESS:          matches = unterminated_string_less_than(text, value); break;
+            case BIN_GREATER:       matches = unterminated_string_greater_than(text, value); break;
+            case BIN_LESS_EQUAL:    matches = !unterminated_string_greater_than(text, value); break;
+            case BIN_GREATER_EQUAL: matches = !unterminated_string_less_than(text, value); break;
+            case BIN_BETWEEN:       matches = !unterminated_string_less_than(text, value) && !unterminated_string_greater_than(text, upper); break;
+
+            default:
+                fprintf(stderr, "select_texts: Op unsupported %d.\n", op);
+                exit(1);
+        }
+
+        if (matches) {
+            selection[kept++] = r;
+        }
+    }
+
+    return kept;
+}
+
+static uint32_t select_rows(struct Filter *filter, struct Expr *predicate, struct ColumnBatch *batch) {
+    // Same result as evaluate_predicate on every selected row, a row only matches a literal of its own type
+    uint32_t column;
+    enum BinaryOp op;
+    struct Value value;
+    struct Value upper = { .type = VALUE_NULL };
+
+    if (get_column_comparison(predicate, &column, &op, &value, &upper)) {
+        struct ColumnVector *vector = batch->columns[column];
+
+        if (value.type == VALUE_INT) {
+            return select_ints(batch, vector, op, value.int_value.value, upper.int_value.value);
+        }
+
+        if (value.type == VALUE_TEXT && op == BIN_EQUAL) {
+            return select_equal_texts(batch, vector, &value.text_value.text);
+        }
+
+        if (value.type == VALUE_TEXT) {
+            return select_texts(vector, batch->selection, batch->selected_count, op, &value.text_value.text, &upper.text_value.text);
+        }
+    }
+
+    if (batch->column_count > filter->row_value_capacity) {
+        struct Value *values = realloc(filter->row_values, batch->column_count * sizeof(struct Value));
+        if (!values) {
+            fprintf(stderr, "select_rows: row_values realloc failed\n");
+            exit(1);
+        }
+
+        filter->row_values          = values;
+        filter->row_value_capacity  = batch->column_count;
+    }
+
+    uint32_t kept = 0;
+
+    for (uint32_t i = 0; i < batch->selected_count; i++) {
+        struct Row row;
+        column_batch_get_row(batch, batch->selection[i], filter->row_values, &row);
+
+        if (evaluate_predicate(predicate, &row)) {
+            batch->selection[kept++] = batch->selection[i];
+        }
+    }
+
+    return kept;
+}
+
+bool filter_next_batch(struct Pager *pager, struct Filter *filter, struct ColumnBatch **batch) {
+    // Narrows the child's batch in place, batches with no rows left are skipped
+    while (plan_next_batch(pager, filter->child, batch)) {
+        struct ColumnBatch *input = *batch;
+
+        for (size_t i = 0; i < filter->predicates->count && input->selected_count > 0; i++) {
+            input->selected_count = select_rows(filter, &filter->predicates->data[i], input);
+        }
+
+        if (input->selected_count > 0) {
             return true;
         }
     }
 
     return false;
-}
\ No newline at end of file
+}
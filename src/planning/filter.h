@@ -7,9 +7,13 @@ struct Filter {
     struct Plan     base;
     struct Plan     *child;
     struct ExprList *predicates;
+    struct Value    *row_values;        // Batch rows are gathered here for predicates without a kernel
+    uint32_t        row_value_capacity;
 };
 
 struct Plan *make_filter(struct Plan *plan, struct ExprList *predicates);
 bool filter_next(struct Pager *pager, struct Filter *filter, struct Row *row);
+bool filter_next_batch(struct Pager *pager, struct Filter *filter, struct ColumnBatch **batch);
+bool filter_row_matches(struct ExprList *predicates, struct Row *row);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <threads.h>
+
+#include "filter_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86
+#include <immintrin.h>
+#endif
+
+static void clear_bitmap(uint64_t *bitmap) {
+    memset(bitmap, 0, BITMAP_WORDS * sizeof(uint64_t));
+}
+
+// Scalar kernels, the fallback on every CPU and the tail of the vector kernels
+
+// Bits are gathered in a register and stored a word at a time
+#define COMPARE_INTS_TAIL(compare)                                                      \
+    while (start < count) {                                                             \
+        uint32_t end = start - start % 64 + 64 < count ? start - start % 64 + 64 : count; \
+        uint64_t word = 0;                                                              \
+        for (uint32_t i = start; i < end; i++) {                                        \
+            word |= (uint64_t)(compare) << (i % 64);                                    \
+        }                                                                               \
+        bitmap[start / 64] |= word;                                                     \
+        start = end;                                                                    \
+    }
+
+static void compare_ints_tail(const int64_t *values, uint32_t start, uint32_t count, enum BinaryOp op, int64_t value, uint64_t *bitmap) {
+    switch (op) {
+        case BIN_EQUAL:     COMPARE_INTS_TAIL(values[i] == value); break;
+        case BIN_LESS:      COMPARE_INTS_TAIL(values[i] < value); break;
+        case BIN_GREATER:   COMPARE_INTS_TAIL(values[i] > value); break;
+
+        default:
+            fprintf(stderr, "compare_ints: Op unsupported %d.\n", op);
+            exit(1);
+    }
+}
+
+#undef COMPARE_INTS_TAIL
+
+static void match_types_tail(const uint8_t *types, uint32_t start, uint32_t count, uint8_t type, uint64_t *bitmap) {
+    for (uint32_t i = start; i < count; i++) {
+        bitmap[i / 64] |= (uint64_t)(types[i] == type) << (i % 64);
+    }
+}
+
+static void compare_ints_scalar(const int64_t *values, uint32_t count, enum BinaryOp op, int64_t value, uint64_t *bitmap) {
+    clear_bitmap(bitmap);
+    compare_ints_tail(values, 0, count, op, value, bitmap);
+}
+
+static void match_types_scalar(const uint8_t *types, uint32_t count, uint8_t type, uint64_t *bitmap) {
+    clear_bitmap(bitmap);
+    match_types_tail(types, 0, count, type, bitmap);
+}
+
+#ifdef KERNELS_X86
+
+// SSE4.2 kernels, two 64-bit lanes per compare. _mm_cmpgt_epi64 is the SSE4.2 instruction.
+
+#define COMPARE_INTS_SSE42(compare)                                                     \
+    for (; i + 2 <= count; i += 2) {                                                    \
+        __m128i v = _mm_loadu_si128((const __m128i *)(values + i));                     \
+        uint64_t bits = (uint64_t)_mm_movemask_pd(_mm_castsi128_pd(compare));           \
+        bitmap[i / 64] |= bits << (i % 64);                                             \
+    }
+
+__attribute__((target("sse4.2")))
+static void compare_ints_sse42(const int64_t *values, uint32_t count, enum BinaryOp op, int64_t value, uint64_t *bitmap) {
+    __m128i constant = _mm_set1_epi64x(value);
+    uint32_t i = 0;
+    clear_bitmap(bitmap);
+
+    switch (op) {
+        case BIN_EQUAL:     COMPARE_INTS_SSE42(_mm_cmpeq_epi64(v, constant)); break;
+        case BIN_LESS:      COMPARE_INTS_SSE42(_mm_cmpgt_epi64(constant, v)); break;
+        case BIN_GREATER:   COMPARE_INTS_SSE42(_mm_cmpgt_epi64(v, constant)); break;
+        default:            break;
+    }
+
+    compare_ints_tail(values, i, count, op, value, bitmap);
+}
+
+#undef COMPARE_INTS_SSE42
+
+__attribute__((target("sse4.2")))
+static void match_types_sse42(const uint8_t *types, uint32_t count, uint8_t type, uint64_t *bitmap) {
+    __m128i constant = _mm_set1_epi8((char)type);
+    uint32_t i = 0;
+    clear_bitmap(bitmap);
+
+    for (; i + 16 <= count; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(types + i));
+        uint64_t bits = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, constant));
+        bitmap[i / 64] |= bits << (i % 64);
+    }
+
+    match_types_tail(types, i, count, type, bitmap);
+}
+
+// AVX2 kernels, four 64-bit lanes per compare
+
+#define COMPARE_INTS_AVX2(compare)                                                      \
+    for (; i + 4 <= count; i += 4) {                                                    \
+        __m256i v = _mm256_loadu_si256((const __m256i *)(values + i));                  \
+        uint64_t bits = (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(compare));     \
+        bitmap[i / 64] |= bits << (i % 64);                                             \
+    }
+
+__attribute__((target("avx2")))
+static void compare_ints_avx2(const int64_t *values, uint32_t count, enum BinaryOp op, int64_t value, uint64_t *bitmap) {
+    __m256i constant = _mm256_set1_epi64x(value);
+    uint32_t i = 0;
+    clear_bitmap(bitmap);
+
+    switch (op) {
+        case BIN_EQUAL:     COMPARE_INTS_AVX2(_mm256_cmpeq_epi64(v, constant)); break;
+        case BIN_LESS:      COMPARE_INTS_AVX2(_mm256_cmpgt_epi64(constant, v)); break;
+        case BIN_GREATER:   COMPARE_INTS_AVX2(_mm256_cmpgt_epi64(v, constant)); break;
+        default:            break;
+    }
+
+    compare_ints_tail(values, i, count, op, value, bitmap);
+}
+
+#undef COMPARE_INTS_AVX2
+
+__attribute__((target("avx2")))
+static void match_types_avx2(const uint8_t *types, uint32_t count, uint8_t type, uint64_t *bitmap) {
+    __m256i constant = _mm256_set1_epi8((char)type);
+    uint32_t i = 0;
+    clear_bitmap(bitmap);
+
+    for (; i + 32 <= count; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(types + i));
+        uint64_t bits = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, constant));
+        bitmap[i / 64] |= bits << (i % 64);
+    }
+
+    match_types_tail(types, i, count, type, bitmap);
+}
+
+#endif
+
+static const struct FilterKernels KERNELS[] = {
+    [KERNEL_SCALAR] = { KERNEL_SCALAR, "scalar", compare_ints_scalar, match_types_scalar },
+#ifdef KERNELS_X86
+    [KERNEL_SSE42]  = { KERNEL_SSE42, "sse4.2", compare_ints_sse42, match_types_sse42 },
+    [KERNEL_AVX2]   = { KERNEL_AVX2, "avx2", compare_ints_avx2, match_types_avx2 },
+#endif
+};
+
+static bool cpu_supports(enum KernelLevel level) {
+    switch (level) {
+        case KERNEL_SCALAR:
+            return true;
+
+#ifdef KERNELS_X86
+        case KERNEL_SSE42:
+            return __builtin_cpu_supports("sse4.2");
+
+        case KERNEL_AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+
+        default:
+            return false;
+    }
+}
+
+static const struct FilterKernels *best_kernels;
+static once_flag best_kernels_once = ONCE_FLAG_INIT;
+
+static void choose_best_kernels(void) {
+    // cpuid is asked once, the parallel scan's workers may all get here together
+    best_kernels = &KERNELS[KERNEL_SCALAR];
+
+    for (int level = KERNEL_AVX2; level > KERNEL_SCALAR; level--) {
+        if (cpu_supports((enum KernelLevel)level)) {
+            best_kernels = &KERNELS[level];
+            break;
+        }
+    }
+
+    fprintf(stderr, "Filter kernels: %s\n", best_kernels->name);
+}
+
+const struct FilterKernels *filter_kernels(void) {
+    // The widest kernels the CPU runs
+    call_once(&best_kernels_once, choose_best_kernels);
+    return best_kernels;
+}
+
+const struct FilterKernels *filter_kernels_for_level(enum KernelLevel level) {
+    // NULL when the CPU, or the build, has no kernels for level
+    return cpu_supports(level) ? &KERNELS[level] : NULL;
+}
+
+void text_equal_bitmap(const struct ColumnVector *vector, uint32_t count, const struct UnterminatedString *value, uint64_t *bitmap) {
+    // Only text of the same length is compared, and memcmp gives up at the first differing byte
+    clear_bitmap(bitmap);
+
+    for (uint32_t i = 0; i < count; i++) {
+        const struct UnterminatedString *text = &vector->texts[i];
+        uint64_t match = vector->types[i] == VALUE_TEXT
+            && text->len == value->len
+            && memcmp(text->start, value->start, value->len) == 0;
+
+        bitmap[i / 64] |= match << (i % 64);
+    }
+}
+
+uint32_t bitmap_select(const uint64_t *bitmap, uint16_t *selection, uint32_t count) {
+    // Keeps the selected rows whose bit is set, in order
+    uint32_t kept = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t r = selection[i];
+        selection[kept] = r;
+        kept += (bitmap[r / 64] >> (r % 64)) & 1;
+    }
+
+    return kept;
+}
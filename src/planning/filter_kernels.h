@@ -0,0 +1,34 @@
+#ifndef sql_filter_kernels
+#define sql_filter_kernels
+
+#include <stdint.h>
+
+#include "../ast.h"
+#include "column_batch.h"
+
+// One bit per row of a batch, bit r of word r / 64 is row r
+#define BITMAP_WORDS (BATCH_SIZE / 64)
+
+enum KernelLevel {
+    KERNEL_SCALAR,
+    KERNEL_SSE42,
+    KERNEL_AVX2
+};
+
+// Comparisons of the first count rows of a column against a constant. Each sets the bit
+// of every matching row and clears all others, including those past count.
+struct FilterKernels {
+    enum KernelLevel    level;
+    const char          *name;
+    // op is BIN_EQUAL, BIN_LESS or BIN_GREATER, the rest are built from those
+    void                (*compare_ints)(const int64_t *values, uint32_t count, enum BinaryOp op, int64_t value, uint64_t *bitmap);
+    void                (*match_types)(const uint8_t *types, uint32_t count, uint8_t type, uint64_t *bitmap);
+};
+
+const struct FilterKernels *filter_kernels(void);
+const struct FilterKernels *filter_kernels_for_level(enum KernelLevel level);
+
+void text_equal_bitmap(const struct ColumnVector *vector, uint32_t count, const struct UnterminatedString *value, uint64_t *bitmap);
+uint32_t bitmap_select(const uint64_t *bitmap, uint16_t *selection, uint32_t count);
+
+#endif
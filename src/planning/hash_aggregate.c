@@ -0,0 +1,357 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hash_aggregate.h"
+#include "accumulator.h"
+#include "column_batch.h"
+
+#define GROUP_SLOT_EMPTY (SIZE_MAX)
+#define INITIAL_SLOT_COUNT (1024)
+#define INITIAL_GROUPS_ARENA_CAPACITY (64 * 1024)
+#define INITIAL_TEXT_ARENA_CAPACITY (16 * 1024)
+
+static uint64_t mix_hash(uint64_t x) {
+    // Finaliser of murmur3, spreads the bits of small integer keys over the whole word
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+static uint64_t hash_value(struct Value *value) {
+    // A float holding a whole number hashes like that integer, the two are one group
+    int64_t as_int;
+
+    switch (value->type) {
+        case VALUE_INT:
+            return mix_hash((uint64_t)value->int_value.value);
+
+        case VALUE_FLOAT: {
+            if (float_as_int(value->float_value.value, &as_int)) {
+                return mix_hash((uint64_t)as_int);
+            }
+
+            uint64_t bits;
+            memcpy(&bits, &value->float_value.value, sizeof bits);
+            return mix_hash(bits ^ 0x5bd1e995ULL);
+        }
+
+        case VALUE_TEXT: {
+            // FNV-1a
+            uint64_t hash = 0xcbf29ce484222325ULL;
+            for (size_t i = 0; i < value->text_value.text.len; i++) {
+                hash ^= (uint8_t)value->text_value.text.start[i];
+                hash *= 0x100000001b3ULL;
+            }
+            return mix_hash(hash);
+        }
+
+        default:
+            return 0x9e3779b97f4a7c15ULL;
+    }
+}
+
+static uint64_t hash_keys(struct Value *keys, size_t key_count) {
+    uint64_t hash = 0;
+    for (size_t i = 0; i < key_count; i++) {
+        hash = mix_hash(hash ^ hash_value(&keys[i])) + i;
+    }
+    return hash;
+}
+
+static struct StoredValue *group_keys(struct HashAggregate *hash_aggregate, size_t group) {
+    return (struct StoredValue *)(hash_aggregate->groups_arena.buffer + group);
+}
+
+static struct Accumulator *group_accumulators(struct HashAggregate *hash_aggregate, size_t group) {
+    return (struct Accumulator *)(group_keys(hash_aggregate, group) + hash_aggregate->group_by->count);
+}
+
+static struct GroupSlot *alloc_slots(size_t slot_count) {
+    struct GroupSlot *slots = malloc(slot_count * sizeof(struct GroupSlot));
+    if (!slots) {
+        fprintf(stderr, "alloc_slots: slots malloc failed\n");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < slot_count; i++) {
+        slots[i].group = GROUP_SLOT_EMPTY;
+    }
+
+    return slots;
+}
+
+static void grow_slots(struct HashAggregate *hash_aggregate) {
+    // Doubles the table, the stored hashes place every group again without looking at its keys
+    size_t slot_count = hash_aggregate->slot_count * 2;
+    struct GroupSlot *slots = alloc_slots(slot_count);
+
+    for (size_t i = 0; i < hash_aggregate->slot_count; i++) {
+        struct GroupSlot *old = &hash_aggregate->slots[i];
+        if (old->group == GROUP_SLOT_EMPTY) {
+            continue;
+        }
+
+        size_t position = old->hash & (slot_count - 1);
+        while (slots[position].group != GROUP_SLOT_EMPTY) {
+            position = (position + 1) & (slot_count - 1);
+        }
+        slots[position] = *old;
+    }
+
+    free(hash_aggregate->slots);
+    hash_aggregate->slots       = slots;
+    hash_aggregate->slot_count  = slot_count;
+}
+
+static bool keys_equal(struct HashAggregate *hash_aggregate, size_t group, struct Value *keys) {
+    struct StoredValue *stored = group_keys(hash_aggregate, group);
+
+    for (size_t i = 0; i < hash_aggregate->group_by->count; i++) {
+        if (!stored_value_equals(&hash_aggregate->text_arena, &stored[i], &keys[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static size_t new_group(struct HashAggregate *hash_aggregate, struct Value *keys) {
+    void *memory = arena_alloc_aligned_checked(&hash_aggregate->groups_arena, hash_aggregate->group_size, _Alignof(struct Accumulator));
+    size_t group = (size_t)((unsigned char *)memory - hash_aggregate->groups_arena.buffer);
+
+    struct StoredValue *stored = group_keys(hash_aggregate, group);
+    for (size_t i = 0; i < hash_aggregate->group_by->count; i++) {
+        stored[i].type = VALUE_NULL;
+        stored_value_set(&hash_aggregate->text_arena, &stored[i], &keys[i]);
+    }
+
+    struct Accumulator *accumulators = group_accumulators(hash_aggregate, group);
+    for (size_t i = 0; i < hash_aggregate->aggregates->count; i++) {
+        accumulator_init(&accumulators[i]);
+    }
+
+    vector_size_t_push(hash_aggregate->groups, group);
+    return group;
+}
+
+static size_t find_group(struct HashAggregate *hash_aggregate, struct Value *keys) {
+    // Linear probing, the table is kept at most half full so runs stay short
+    uint64_t hash = hash_keys(keys, hash_aggregate->group_by->count);
+    size_t mask = hash_aggregate->slot_count - 1;
+    size_t position = hash & mask;
+
+    for (;;) {
+        struct GroupSlot *slot = &hash_aggregate->slots[position];
+
+        if (slot->group == GROUP_SLOT_EMPTY) {
+            break;
+        }
+
+        if (slot->hash == hash && keys_equal(hash_aggregate, slot->group, keys)) {
+            return slot->group;
+        }
+
+        position = (position + 1) & mask;
+    }
+
+    size_t group = new_group(hash_aggregate, keys);
+    hash_aggregate->slots[position] = (struct GroupSlot){ .hash = hash, .group = group };
+
+    if (hash_aggregate->groups->count * 2 > hash_aggregate->slot_count) {
+        grow_slots(hash_aggregate);
+    }
+
+    return group;
+}
+
+struct Plan *make_hash_aggregate(struct Plan *plan, struct ExprList *group_by, struct ExprList *aggregates) {
+    struct HashAggregate *hash_aggregate = malloc(sizeof(struct HashAggregate));
+    if (!hash_aggregate) {
+        fprintf(stderr, "make_hash_aggregate: *hash_aggregate malloc failed\n");
+        exit(1);
+    }
+
+    size_t key_count = group_by->count;
+    size_t aggregate_count = aggregates->count;
+
+    memset(hash_aggregate, 0, sizeof *hash_aggregate);
+    hash_aggregate->base.type               = PLAN_HASH_AGGREGATE;
+    hash_aggregate->child                   = plan;
+    hash_aggregate->group_by                = group_by;
+    hash_aggregate->aggregates              = aggregates;
+    hash_aggregate->groups_arena            = arena_new(INITIAL_GROUPS_ARENA_CAPACITY);
+    hash_aggregate->text_arena              = arena_new(INITIAL_TEXT_ARENA_CAPACITY);
+    hash_aggregate->slots                   = alloc_slots(INITIAL_SLOT_COUNT);
+    hash_aggregate->slot_count              = INITIAL_SLOT_COUNT;
+    hash_aggregate->groups                  = vector_size_t_new();
+    hash_aggregate->group_size              = key_count * sizeof(struct StoredValue) + aggregate_count * sizeof(struct Accumulator);
+    hash_aggregate->aggregate_columns       = malloc((aggregate_count + 1) * sizeof(size_t));
+    hash_aggregate->aggregate_has_column    = malloc((aggregate_count + 1) * sizeof(bool));
+    hash_aggregate->keys                    = malloc((key_count + 1) * sizeof(struct Value));
+    hash_aggregate->values                  = malloc((key_count + aggregate_count + 1) * sizeof(struct Value));
+
+    if (!hash_aggregate->groups_arena.buffer || !hash_aggregate->text_arena.buffer || !hash_aggregate->aggregate_columns
+        || !hash_aggregate->aggregate_has_column || !hash_aggregate->keys || !hash_aggregate->values) {
+        fprintf(stderr, "make_hash_aggregate: malloc failed\n");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < key_count; i++) {
+        if (group_by->data[i].type != EXPR_COLUMN) {
+            fprintf(stderr, "make_hash_aggregate: GROUP BY only takes columns\n");
+            exit(1);
+        }
+    }
+
+    for (size_t i = 0; i < aggregate_count; i++) {
+        hash_aggregate->aggregate_has_column[i] = aggregate_argument(&aggregates->data[i], &hash_aggregate->aggregate_columns[i]);
+    }
+
+    return &hash_aggregate->base;
+}
+
+static void add_row(struct HashAggregate *hash_aggregate, struct Value *keys, struct Value *row_values) {
+    // row_values holds the child's row, keys its group columns
+    size_t group = find_group(hash_aggregate, keys);
+    struct Accumulator *accumulators = group_accumulators(hash_aggregate, group);
+
+    for (size_t i = 0; i < hash_aggregate->aggregates->count; i++) {
+        if (!hash_aggregate->aggregate_has_column[i]) {
+            accumulator_add_rows(&accumulators[i], 1);
+            continue;
+        }
+
+        accumulator_add(
+            &accumulators[i],
+            &hash_aggregate->text_arena,
+            hash_aggregate->aggregates->data[i].function.agg_type,
+            &row_values[hash_aggregate->aggregate_columns[i]]
+        );
+    }
+}
+
+static void build_groups_from_rows(struct Pager *pager, struct HashAggregate *hash_aggregate) {
+    struct Row row;
+
+    while (plan_next(pager, hash_aggregate->child, &row)) {
+        for (size_t i = 0; i < hash_aggregate->group_by->count; i++) {
+            hash_aggregate->keys[i] = row.values[hash_aggregate->group_by->data[i].column.idx];
+        }
+
+        add_row(hash_aggregate, hash_aggregate->keys, row.values);
+    }
+}
+
+static void build_groups_from_batches(struct Pager *pager, struct HashAggregate *hash_aggregate) {
+    // Only the key and argument columns are read out of the batch, into a sparse row
+    struct ColumnBatch *input;
+    struct Value *row_values = NULL;
+    uint32_t row_value_capacity = 0;
+
+    while (plan_next_batch(pager, hash_aggregate->child, &input)) {
+        if (input->column_count > row_value_capacity) {
+            row_values = realloc(row_values, input->column_count * sizeof(struct Value));
+            if (!row_values) {
+                fprintf(stderr, "build_groups_from_batches: row_values realloc failed\n");
+                exit(1);
+            }
+            row_value_capacity = input->column_count;
+        }
+
+        for (uint32_t r = 0; r < input->selected_count; r++) {
+            uint16_t position = input->selection[r];
+
+            for (size_t i = 0; i < hash_aggregate->group_by->count; i++) {
+                column_batch_get_value(input, (uint32_t)hash_aggregate->group_by->data[i].column.idx, position, &hash_aggregate->keys[i]);
+            }
+
+            for (size_t i = 0; i < hash_aggregate->aggregates->count; i++) {
+                if (hash_aggregate->aggregate_has_column[i]) {
+                    size_t column = hash_aggregate->aggregate_columns[i];
+                    column_batch_get_value(input, (uint32_t)column, position, &row_values[column]);
+                }
+            }
+
+            add_row(hash_aggregate, hash_aggregate->keys, row_values);
+        }
+    }
+
+    free(row_values);
+}
+
+static void finish_building(struct HashAggregate *hash_aggregate) {
+    hash_aggregate->built = true;
+    fprintf(stderr, "Hash aggregate: %zu groups\n", hash_aggregate->groups->count);
+}
+
+static void group_row(struct HashAggregate *hash_aggregate, size_t group, struct Row *row) {
+    // Text in the row points into text_arena, which no longer grows once the groups are built
+    size_t key_count = hash_aggregate->group_by->count;
+    struct StoredValue *stored = group_keys(hash_aggregate, group);
+    struct Accumulator *accumulators = group_accumulators(hash_aggregate, group);
+
+    for (size_t i = 0; i < key_count; i++) {
+        stored_value_get(&hash_aggregate->text_arena, &stored[i], &hash_aggregate->values[i]);
+    }
+
+    for (size_t i = 0; i < hash_aggregate->aggregates->count; i++) {
+        accumulator_result(
+            &accumulators[i],
+            &hash_aggregate->text_arena,
+            hash_aggregate->aggregates->data[i].function.agg_type,
+            &hash_aggregate->values[key_count + i]
+        );
+    }
+
+    row->rowid          = 0;
+    row->column_count   = key_count + hash_aggregate->aggregates->count;
+    row->values         = hash_aggregate->values;
+}
+
+bool hash_aggregate_next(struct Pager *pager, struct HashAggregate *hash_aggregate, struct Row *row) {
+    // The first call consumes every row of the child
+    if (!hash_aggregate->built) {
+        build_groups_from_rows(pager, hash_aggregate);
+        finish_building(hash_aggregate);
+    }
+
+    if (hash_aggregate->next_group == hash_aggregate->groups->count) {
+        return false;
+    }
+
+    group_row(hash_aggregate, hash_aggregate->groups->data[hash_aggregate->next_group++], row);
+    return true;
+}
+
+bool hash_aggregate_next_batch(struct Pager *pager, struct HashAggregate *hash_aggregate, struct ColumnBatch **batch) {
+    if (!hash_aggregate->built) {
+        build_groups_from_batches(pager, hash_aggregate);
+        finish_building(hash_aggregate);
+    }
+
+    if (hash_aggregate->next_group == hash_aggregate->groups->count) {
+        return false;
+    }
+
+    size_t column_count = hash_aggregate->group_by->count + hash_aggregate->aggregates->count;
+    if (hash_aggregate->base.batch == NULL) {
+        hash_aggregate->base.batch = column_batch_new((uint32_t)column_count);
+    }
+
+    struct ColumnBatch *output = hash_aggregate->base.batch;
+    column_batch_reset(output);
+
+    while (!column_batch_is_full(output) && hash_aggregate->next_group < hash_aggregate->groups->count) {
+        struct Row row;
+        group_row(hash_aggregate, hash_aggregate->groups->data[hash_aggregate->next_group++], &row);
+        column_batch_append_row(output, &row, NULL);
+    }
+
+    *batch = output;
+    return true;
+}
@@ -0,0 +1,41 @@
+#ifndef sql_hash_aggregate
+#define sql_hash_aggregate
+
+#include "plan.h"
+#include "../arena.h"
+
+// A slot of the open addressing table, group is GROUP_SLOT_EMPTY in an unused slot
+struct GroupSlot {
+    uint64_t    hash;
+    size_t      group;      // Arena offset of the group
+};
+
+// GROUP BY. Every row of the child is added to the group of its key columns, then one row
+// per group comes out holding the keys followed by the aggregates, groups in the order
+// they were first seen. Groups live in groups_arena as the key values followed by one
+// accumulator per aggregate, the table only holds their hashes and offsets. Text goes in
+// text_arena, adding a value to a group never moves the groups.
+struct HashAggregate {
+    struct Plan             base;
+    struct Plan             *child;
+    struct ExprList         *group_by;      // Columns of the child's rows
+    struct ExprList         *aggregates;
+    struct ArenaAllocator   groups_arena;
+    struct ArenaAllocator   text_arena;
+    struct GroupSlot        *slots;
+    size_t                  slot_count;     // A power of two, at least twice the group count
+    struct SizeTVec         *groups;        // Arena offset of each group, in the order they were first seen
+    size_t                  group_size;
+    size_t                  *aggregate_columns; // Column each aggregate reads, unused for COUNT(*)
+    bool                    *aggregate_has_column;
+    struct Value            *keys;          // Key values of the row being added
+    bool                    built;
+    size_t                  next_group;
+    struct Value            *values;        // Output row, reused for every group
+};
+
+struct Plan *make_hash_aggregate(struct Plan *plan, struct ExprList *group_by, struct ExprList *aggregates);
+bool hash_aggregate_next(struct Pager *pager, struct HashAggregate *hash_aggregate, struct Row *row);
+bool hash_aggregate_next_batch(struct Pager *pager, struct HashAggregate *hash_aggregate, struct ColumnBatch **batch);
+
+#endif
@@ -0,0 +1,120 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "limit.h"
+#include "table_scan.h"
+#include "filter.h"
+#include "column_batch.h"
+
+struct Plan *make_limit(struct Plan *plan, uint64_t limit, uint64_t offset) {
+    struct Limit *node = malloc(sizeof(struct Limit));
+    if (!node) {
+        fprintf(stderr, "make_limit: *node malloc failed\n");
+        exit(1);
+    }
+
+    memset(node, 0, sizeof *node);
+    node->base.type = PLAN_LIMIT;
+    node->child     = plan;
+    node->offset    = offset;
+    node->remaining = limit;
+
+    return &node->base;
+}
+
+static void start_limit(struct Limit *limit) {
+    // The scan at the bottom is told how many rows are wanted, so it does not read far past
+    // them, and asked to drop the offset rows itself. Under a filter it is handed the WHERE,
+    // the rows it drops have to be the first that pass it.
+    limit->started = true;
+
+    struct Plan *scan = limit->child;
+    struct ExprList *predicates = NULL;
+
+    if (scan->type == PLAN_FILTER) {
+        predicates  = ((struct Filter *)scan)->predicates;
+        scan        = ((struct Filter *)scan)->child;
+    }
+
+    if (limit->remaining == 0 || scan->type != PLAN_TABLE_SCAN) {
+        return;
+    }
+
+    struct TableScan *table_scan = (struct TableScan *)scan;
+    uint64_t wanted = limit->remaining > UINT64_MAX - limit->offset ? UINT64_MAX : limit->remaining + limit->offset;
+    table_scan_limit_rows(table_scan, wanted);
+
+    if (limit->offset > 0 && table_scan_skip(table_scan, limit->offset, predicates)) {
+        // Only the rows after the offset are left to read
+        limit->offset = 0;
+        table_scan_limit_rows(table_scan, limit->remaining);
+    }
+}
+
+static bool finish_limit(struct Limit *limit) {
+    // Called once no more rows are wanted, the last row handed out is no longer in use
+    if (!limit->done) {
+        plan_close(limit->child);
+        limit->done = true;
+    }
+
+    return false;
+}
+
+bool limit_next(struct Pager *pager, struct Limit *limit, struct Row *row) {
+    if (!limit->started) {
+        start_limit(limit);
+    }
+
+    while (!limit->done && limit->remaining > 0) {
+        if (!plan_next(pager, limit->child, row)) {
+            return finish_limit(limit);
+        }
+
+        if (limit->offset > 0) {
+            limit->offset--;
+            continue;
+        }
+
+        limit->remaining--;
+        return true;
+    }
+
+    return finish_limit(limit);
+}
+
+bool limit_next_batch(struct Pager *pager, struct Limit *limit, struct ColumnBatch **batch) {
+    // The child's batches are handed on with their selections cut to the rows wanted
+    if (!limit->started) {
+        start_limit(limit);
+    }
+
+    struct ColumnBatch *input;
+
+    while (!limit->done && limit->remaining > 0) {
+        if (!plan_next_batch(pager, limit->child, &input)) {
+            return finish_limit(limit);
+        }
+
+        uint32_t dropped = limit->offset < input->selected_count ? (uint32_t)limit->offset : input->selected_count;
+        uint32_t kept = input->selected_count - dropped;
+
+        if (kept > limit->remaining) {
+            kept = (uint32_t)limit->remaining;
+        }
+
+        memmove(input->selection, input->selection + dropped, kept * sizeof(input->selection[0]));
+        input->selected_count   = kept;
+        limit->offset          -= dropped;
+        limit->remaining       -= kept;
+
+        if (kept > 0) {
+            *batch = input;
+            return true;
+        }
+    }
+
+    return finish_limit(limit);
+}
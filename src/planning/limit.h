@@ -0,0 +1,24 @@
+#ifndef sql_limit
+#define sql_limit
+
+#include "plan.h"
+
+// LIMIT and OFFSET without an ORDER BY. The first offset rows of the child are dropped and
+// the next limit handed out. Then the child is closed, so scans below unpin their pages and
+// parallel workers stop, and it is never pulled from again. The scan below, under at most
+// a filter, drops the offset rows itself where it can: a scan in rowid order a leaf at a
+// time without decoding them, an index scan by reading only the index entries.
+struct Limit {
+    struct Plan     base;
+    struct Plan     *child;
+    uint64_t        offset;         // Rows still to drop
+    uint64_t        remaining;      // Rows still to hand out
+    bool            started;
+    bool            done;
+};
+
+struct Plan *make_limit(struct Plan *plan, uint64_t limit, uint64_t offset);
+bool limit_next(struct Pager *pager, struct Limit *limit, struct Row *row);
+bool limit_next_batch(struct Pager *pager, struct Limit *limit, struct ColumnBatch **batch);
+
+#endif
@@ -0,0 +1,449 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "parallel_scan.h"
+#include "filter.h"
+#include "../btree_cursor.h"
+#include "../data_parsing/byte_reader.h"
+#include "../data_parsing/page_parsing.h"
+
+#define MORSELS_PER_THREAD      (8)
+#define BATCH_ROWS              (1024)
+#define BATCH_VALUES            (16384)
+#define BATCH_BYTES             (1 << 18)
+#define MAX_BUFFERED_BATCHES    (64)    // Per scan, across morsels the consumer has not reached yet
+
+// Batches
+
+static struct RowBatch *row_batch_new(size_t min_values, size_t min_bytes) {
+    struct RowBatch *batch = malloc(sizeof(struct RowBatch));
+    if (!batch) {
+        fprintf(stderr, "row_batch_new: *batch malloc failed\n");
+        exit(1);
+    }
+
+    batch->next             = NULL;
+    batch->row_count        = 0;
+    batch->row_capacity     = BATCH_ROWS;
+    batch->value_count      = 0;
+    batch->value_capacity   = min_values > BATCH_VALUES ? min_values : BATCH_VALUES;
+    batch->byte_count       = 0;
+    batch->byte_capacity    = min_bytes > BATCH_BYTES ? min_bytes : BATCH_BYTES;
+    batch->rows             = malloc(batch->row_capacity * sizeof(struct Row));
+    batch->values           = malloc(batch->value_capacity * sizeof(struct Value));
+    batch->bytes            = malloc(batch->byte_capacity);
+
+    if (!batch->rows || !batch->values || !batch->bytes) {
+        fprintf(stderr, "row_batch_new: malloc failed\n");
+        exit(1);
+    }
+
+    return batch;
+}
+
+static void row_batch_free(struct RowBatch *batch) {
+    free(batch->rows);
+    free(batch->values);
+    free(batch->bytes);
+    free(batch);
+}
+
+static size_t row_text_bytes(struct Row *row) {
+    size_t bytes = 0;
+    for (uint64_t i = 0; i < row->column_count; i++) {
+        if (row->values[i].type == VALUE_TEXT) {
+            bytes += row->values[i].text_value.text.len;
+        }
+    }
+    return bytes;
+}
+
+static bool row_batch_append(struct RowBatch *batch, struct Row *row, size_t text_bytes) {
+    // Copies row and its text into the batch, false when it does not fit
+    if (batch->row_count == batch->row_capacity
+        || batch->value_count + row->column_count > batch->value_capacity
+        || batch->byte_count + text_bytes > batch->byte_capacity) {
+        return false;
+    }
+
+    struct Value *values = &batch->values[batch->value_count];
+
+    for (uint64_t i = 0; i < row->column_count; i++) {
+        values[i] = row->values[i];
+
+        if (values[i].type == VALUE_TEXT) {
+            struct UnterminatedString *text = &values[i].text_value.text;
+            char *copy = &batch->bytes[batch->byte_count];
+
+            memcpy(copy, text->start, text->len);
+            batch->byte_count += text->len;
+            text->start = copy;
+        }
+    }
+
+    batch->rows[batch->row_count++] = (struct Row){ .rowid = row->rowid, .column_count = row->column_count, .values = values };
+    batch->value_count += row->column_count;
+    return true;
+}
+
+// Morsels
+
+static void collect_morsels(struct ParallelScan *parallel_scan, uint32_t target) {
+    // Walk down from the root a level at a time until a level has enough pages for every
+    // worker to get several, or the leaves are reached. Children are taken in order, so the
+    // subtrees of a level cover the table in rowid order.
+    struct PageNumberVec level;
+    struct PageNumberVec next;
+    vector_page_number_vec_init(&level);
+    vector_page_number_vec_init(&next);
+    vector_page_number_vec_push(&level, parallel_scan->root_page);
+
+    while (level.count < target) {
+        bool descended = false;
+        next.count = 0;
+
+        for (size_t i = 0; i < level.count; i++) {
+            struct PageView view;
+            page_view_open(parallel_scan->pager, &view, level.data[i]);
+
+            if (view.header.page_type != PAGE_INTERIOR_TABLE) {
+                vector_page_number_vec_push(&next, level.data[i]);
+                page_view_release(&view);
+                continue;
+            }
+
+            for (uint16_t cell = 0; cell < view.header.number_of_cells; cell++) {
+                vector_page_number_vec_push(&next, read_u32_big_endian(view.page->data, page_view_cell_offset(&view, cell)));
+            }
+            vector_page_number_vec_push(&next, view.header.right_most_pointer);
+
+            descended = true;
+            page_view_release(&view);
+        }
+
+        if (!descended) {
+            break;
+        }
+
+        struct PageNumberVec swap = level;
+        level   = next;
+        next    = swap;
+    }
+
+    parallel_scan->morsel_count = (uint32_t)level.count;
+    parallel_scan->morsels      = malloc(level.count * sizeof(struct Morsel));
+
+    if (!parallel_scan->morsels) {
+        fprintf(stderr, "collect_morsels: *morsels malloc failed\n");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < level.count; i++) {
+        parallel_scan->morsels[i] = (struct Morsel){ .page_number = level.data[i], .head = NULL, .tail = NULL, .done = false };
+    }
+
+    vector_page_number_vec_free(&level);
+    vector_page_number_vec_free(&next);
+}
+
+static uint32_t subtree_depth(struct Pager *pager, uint32_t page_number) {
+    // Pages on the path from page_number down to a leaf, the pins one cursor holds at most
+    uint32_t depth = 1;
+
+    while (true) {
+        struct PageView view;
+        page_view_open(pager, &view, page_number);
+
+        bool interior = view.header.page_type == PAGE_INTERIOR_TABLE;
+        uint32_t child = interior ? read_u32_big_endian(view.page->data, page_view_cell_offset(&view, 0)) : 0;
+        page_view_release(&view);
+
+        if (!interior) {
+            return depth;
+        }
+
+        page_number = child;
+        depth++;
+    }
+}
+
+// Workers
+
+static void publish_batch(struct ParallelScan *parallel_scan, uint32_t morsel_index, struct RowBatch *batch) {
+    struct Morsel *morsel = &parallel_scan->morsels[morsel_index];
+
+    mtx_lock(&parallel_scan->lock);
+
+    // Workers ahead of the consumer wait once enough is buffered. The morsel the consumer
+    // is reading never waits, so the consumer can always make progress.
+    while (morsel_index != parallel_scan->current_morsel && parallel_scan->buffered_batches >= MAX_BUFFERED_BATCHES && !atomic_load(&parallel_scan->stopping)) {
+        cnd_wait(&parallel_scan->batch_taken, &parallel_scan->lock);
+    }
+
+    if (morsel->tail != NULL) {
+        morsel->tail->next = batch;
+    } else {
+        morsel->head = batch;
+    }
+    morsel->tail = batch;
+    parallel_scan->buffered_batches++;
+
+    cnd_broadcast(&parallel_scan->batch_ready);
+    mtx_unlock(&parallel_scan->lock);
+}
+
+static void finish_morsel(struct ParallelScan *parallel_scan, uint32_t morsel_index) {
+    mtx_lock(&parallel_scan->lock);
+    parallel_scan->morsels[morsel_index].done = true;
+    cnd_broadcast(&parallel_scan->batch_ready);
+    mtx_unlock(&parallel_scan->lock);
+}
+
+static void scan_morsel(struct ParallelScan *parallel_scan, uint32_t morsel_index, struct RowBuffer *buffer) {
+    // A morsel's subtree is a b-tree of its own, so a cursor rooted at it visits exactly its rows
+    struct BTreeCursor cursor;
+    struct RowBatch *batch = NULL;
+
+    btree_cursor_init(&cursor, parallel_scan->pager, parallel_scan->morsels[morsel_index].page_number);
+    cursor.readahead = true;
+
+    for (bool found = btree_cursor_first(&cursor); found; found = btree_cursor_next(&cursor)) {
+        if (atomic_load_explicit(&parallel_scan->stopping, memory_order_relaxed)) {
+            break;
+        }
+
+        struct Row row;
+        btree_cursor_read_row(&cursor, buffer, &parallel_scan->column_mask, &row);
+
+        // The record stores NULL for an INTEGER PRIMARY KEY, its value is the rowid
+        if (parallel_scan->first_col_is_row_id && row.column_count > 0 && row.values[0].type == VALUE_NULL) {
+            row.values[0] = (struct Value){ .type = VALUE_INT, .int_value = { .value = (int64_t)row.rowid } };
+        }
+
+        if (parallel_scan->predicates != NULL && !filter_row_matches(parallel_scan->predicates, &row)) {
+            continue;
+        }
+
+        size_t text_bytes = row_text_bytes(&row);
+
+        if (batch != NULL && row_batch_append(batch, &row, text_bytes)) {
+            continue;
+        }
+
+        if (batch != NULL) {
+            publish_batch(parallel_scan, morsel_index, batch);
+        }
+
+        batch = row_batch_new(row.column_count, text_bytes);
+        row_batch_append(batch, &row, text_bytes);
+    }
+
+    if (batch != NULL) {
+        publish_batch(parallel_scan, morsel_index, batch);
+    }
+
+    finish_morsel(parallel_scan, morsel_index);
+    btree_cursor_close(&cursor);
+}
+
+static int parallel_scan_worker(void *arg) {
+    struct ParallelScan *parallel_scan = arg;
+    struct RowBuffer buffer;
+    row_buffer_init(&buffer);
+
+    while (true) {
+        uint32_t morsel_index = atomic_fetch_add(&parallel_scan->next_morsel, 1);
+        if (morsel_index >= parallel_scan->morsel_count || atomic_load(&parallel_scan->stopping)) {
+            break;
+        }
+
+        scan_morsel(parallel_scan, morsel_index, &buffer);
+    }
+
+    row_buffer_free(&buffer);
+    return 0;
+}
+
+// Consumer
+
+static void start_workers(struct ParallelScan *parallel_scan) {
+    collect_morsels(parallel_scan, parallel_scan->thread_count * MORSELS_PER_THREAD);
+
+    // Every worker keeps its cursor path pinned, leave the cache at least half free so
+    // workers can never pin every slot between them
+    // Reads io_uring has in flight hold pins too
+    uint32_t pins_per_worker = subtree_depth(parallel_scan->pager, parallel_scan->morsels[0].page_number);
+    if (parallel_scan->pager->async_io) {
+        pins_per_worker += parallel_scan->pager->readahead_pages;
+    }
+    uint32_t max_threads = parallel_scan->pager->cache_capacity / (pins_per_worker * 2);
+
+    if (max_threads < 1) {
+        max_threads = 1;
+    }
+
+    if (parallel_scan->thread_count > max_threads) {
+        fprintf(stderr, "Parallel scan: a %u page cache fits %u threads\n", parallel_scan->pager->cache_capacity, max_threads);
+        parallel_scan->thread_count = max_threads;
+    }
+
+    fprintf(stderr, "Parallel scan: %u morsels over %u threads\n", parallel_scan->morsel_count, parallel_scan->thread_count);
+
+    parallel_scan->threads = malloc(parallel_scan->thread_count * sizeof(thrd_t));
+    if (!parallel_scan->threads) {
+        fprintf(stderr, "start_workers: *threads malloc failed\n");
+        exit(1);
+    }
+
+    for (uint32_t i = 0; i < parallel_scan->thread_count; i++) {
+        if (thrd_create(&parallel_scan->threads[i], parallel_scan_worker, parallel_scan) != thrd_success) {
+            fprintf(stderr, "start_workers: thrd_create failed\n");
+            exit(1);
+        }
+    }
+
+    parallel_scan->started = true;
+}
+
+static void join_workers(struct ParallelScan *parallel_scan) {
+    for (uint32_t i = 0; i < parallel_scan->thread_count; i++) {
+        thrd_join(parallel_scan->threads[i], NULL);
+    }
+
+    // Batches of a scan that was stopped are never taken
+    for (uint32_t i = 0; i < parallel_scan->morsel_count; i++) {
+        while (parallel_scan->morsels[i].head != NULL) {
+            struct RowBatch *batch = parallel_scan->morsels[i].head;
+            parallel_scan->morsels[i].head = batch->next;
+            row_batch_free(batch);
+        }
+    }
+
+    free(parallel_scan->threads);
+    free(parallel_scan->morsels);
+    parallel_scan->threads  = NULL;
+    parallel_scan->morsels  = NULL;
+    parallel_scan->finished = true;
+}
+
+static bool take_batch(struct ParallelScan *parallel_scan) {
+    // Moves on to the next batch in morsel order, waiting for the workers when it is not ready
+    struct RowBatch *batch = NULL;
+
+    mtx_lock(&parallel_scan->lock);
+
+    while (parallel_scan->current_morsel < parallel_scan->morsel_count) {
+        struct Morsel *morsel = &parallel_scan->morsels[parallel_scan->current_morsel];
+
+        if (morsel->head != NULL) {
+            batch = morsel->head;
+            morsel->head = batch->next;
+            if (morsel->head == NULL) {
+                morsel->tail = NULL;
+            }
+
+            parallel_scan->buffered_batches--;
+            cnd_broadcast(&parallel_scan->batch_taken);
+            break;
+        }
+
+        if (morsel->done) {
+            parallel_scan->current_morsel++;
+            cnd_broadcast(&parallel_scan->batch_taken);
+            continue;
+        }
+
+        cnd_wait(&parallel_scan->batch_ready, &parallel_scan->lock);
+    }
+
+    mtx_unlock(&parallel_scan->lock);
+
+    if (parallel_scan->batch != NULL) {
+        row_batch_free(parallel_scan->batch);
+    }
+
+    parallel_scan->batch        = batch;
+    parallel_scan->batch_row    = 0;
+
+    if (batch == NULL) {
+        join_workers(parallel_scan);
+        return false;
+    }
+
+    return true;
+}
+
+struct Plan *make_parallel_scan(struct Pager *pager, struct TableScan *table_scan, struct ExprList *predicates, uint32_t thread_count) {
+    struct ParallelScan *parallel_scan = malloc(sizeof(struct ParallelScan));
+    if (!parallel_scan) {
+        fprintf(stderr, "make_parallel_scan: *parallel_scan malloc failed\n");
+        exit(1);
+    }
+
+    memset(parallel_scan, 0, sizeof *parallel_scan);
+    parallel_scan->base.type            = PLAN_PARALLEL_SCAN;
+    parallel_scan->pager                = pager;
+    parallel_scan->root_page            = table_scan->root_page;
+    parallel_scan->first_col_is_row_id  = table_scan->first_col_is_row_id;
+    parallel_scan->column_mask          = table_scan->column_mask;
+    parallel_scan->predicates           = predicates;
+    parallel_scan->thread_count         = thread_count;
+    atomic_init(&parallel_scan->next_morsel, 0);
+    atomic_init(&parallel_scan->stopping, false);
+
+    if (mtx_init(&parallel_scan->lock, mtx_plain) != thrd_success
+        || cnd_init(&parallel_scan->batch_ready) != thrd_success
+        || cnd_init(&parallel_scan->batch_taken) != thrd_success) {
+        fprintf(stderr, "make_parallel_scan: mtx_init or cnd_init failed\n");
+        exit(1);
+    }
+
+    return &parallel_scan->base;
+}
+
+bool parallel_scan_next(struct ParallelScan *parallel_scan, struct Row *row) {
+    // The row stays valid until the next call, the batch holding it is freed then
+    if (parallel_scan->finished) {
+        return false;
+    }
+
+    if (!parallel_scan->started) {
+        start_workers(parallel_scan);
+    }
+
+    while (parallel_scan->batch == NULL || parallel_scan->batch_row == parallel_scan->batch->row_count) {
+        if (!take_batch(parallel_scan)) {
+            return false;
+        }
+    }
+
+    *row = parallel_scan->batch->rows[parallel_scan->batch_row++];
+    return true;
+}
+
+void parallel_scan_close(struct ParallelScan *parallel_scan) {
+    // Workers stop at their next row and do not claim another morsel, a worker waiting for
+    // the consumer to take batches is woken. Once they are joined no page is pinned.
+    if (parallel_scan->finished) {
+        return;
+    }
+
+    if (parallel_scan->started) {
+        mtx_lock(&parallel_scan->lock);
+        atomic_store(&parallel_scan->stopping, true);
+        cnd_broadcast(&parallel_scan->batch_taken);
+        mtx_unlock(&parallel_scan->lock);
+
+        join_workers(parallel_scan);
+    }
+
+    if (parallel_scan->batch != NULL) {
+        row_batch_free(parallel_scan->batch);
+        parallel_scan->batch = NULL;
+    }
+
+    parallel_scan->finished = true;
+}
@@ -0,0 +1,66 @@
+#ifndef sql_parallel_scan
+#define sql_parallel_scan
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <threads.h>
+
+#include "plan.h"
+#include "table_scan.h"
+
+// Rows copied out of a worker's row buffer so they outlive it. Values and text bytes are
+// sized when the batch is made and never grow, so the rows can point straight into them.
+struct RowBatch {
+    struct RowBatch *next;
+    size_t          row_count;
+    size_t          row_capacity;
+    size_t          value_count;
+    size_t          value_capacity;
+    size_t          byte_count;
+    size_t          byte_capacity;
+    struct Row      *rows;
+    struct Value    *values;
+    char            *bytes;
+};
+
+// A subtree of the table scanned by one worker. Morsels are numbered in rowid order.
+struct Morsel {
+    uint32_t        page_number;
+    struct RowBatch *head;          // Finished batches waiting for the consumer, in rowid order
+    struct RowBatch *tail;
+    bool            done;           // The worker has published every batch of this morsel
+};
+
+// Full table scan spread over worker threads. Workers claim morsels, decode their rows and
+// apply the WHERE predicates, the rows that pass are copied into batches. The consumer hands
+// out the batches morsel by morsel, so rows come out in rowid order like a serial scan.
+struct ParallelScan {
+    struct Plan         base;
+    struct Pager        *pager;
+    uint32_t            root_page;
+    bool                first_col_is_row_id;
+    struct ColumnMask   column_mask;        // Shares its bits with the table scan's mask
+    struct ExprList     *predicates;        // May be NULL
+    uint32_t            thread_count;
+    thrd_t              *threads;
+    struct Morsel       *morsels;
+    uint32_t            morsel_count;
+    atomic_uint         next_morsel;        // Next morsel a worker claims
+    atomic_bool         stopping;           // Set by parallel_scan_close, workers stop scanning
+    mtx_t               lock;               // Guards the morsel batch lists, current_morsel and buffered_batches
+    cnd_t               batch_ready;
+    cnd_t               batch_taken;
+    uint32_t            current_morsel;     // Morsel the consumer is reading from
+    uint32_t            buffered_batches;
+    bool                started;
+    bool                finished;
+    struct RowBatch     *batch;             // Rows handed out live here until the next row
+    size_t              batch_row;
+};
+
+struct Plan *make_parallel_scan(struct Pager *pager, struct TableScan *table_scan, struct ExprList *predicates, uint32_t thread_count);
+bool parallel_scan_next(struct ParallelScan *parallel_scan, struct Row *row);
+void parallel_scan_close(struct ParallelScan *parallel_scan);
+
+#endif
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <ctype.h>
 
 #include "../memory.h"
 #include "plan.h"
@@ -14,9 +15,45 @@
 #include "aggregate.h"
 #include "filter.h"
 #include "table_scan.h"
+#include "parallel_scan.h"
+#include "count_scan.h"
+#include "hash_aggregate.h"
+#include "sort.h"
+#include "top_n.h"
+#include "limit.h"
+#include "column_batch.h"
+
+static bool aggregate_type_from_name(const char *function_name, enum AggType *type) {
+    // Function names are case insensitive
+    static const struct { const char *name; enum AggType type; } aggregates[] = {
+        { "count", AGG_COUNT },
+        { "sum",   AGG_SUM },
+        { "min",   AGG_MIN },
+        { "max",   AGG_MAX },
+        { "avg",   AGG_AVG },
+    };
+
+    for (size_t i = 0; i < sizeof(aggregates) / sizeof(aggregates[0]); i++) {
+        const char *a = function_name;
+        const char *b = aggregates[i].name;
+
+        while (*a != '\0' && tolower((unsigned char)*a) == *b) {
+            a++;
+            b++;
+        }
+
+        if (*a == '\0' && *b == '\0') {
+            *type = aggregates[i].type;
+            return true;
+        }
+    }
+
+    return false;
+}
 
 static bool is_aggregate_function(const char *function_name) {
-    return strcmp(function_name, "count") == 0;
+    enum AggType type;
+    return aggregate_type_from_name(function_name, &type);
 }
 
 bool expr_contains_aggregate(struct Expr *expr) {
@@ -59,12 +96,33 @@ static void collect_aggregates(struct ExprList *expr_list, struct Expr *expr) {
         return;
     }
 
-    if (expr->type == EXPR_FUNCTION && is_aggregate_function(expr->function.name)) {
+    if (expr->type == EXPR_FUNCTION && aggregate_type_from_name(expr->function.name, &expr->function.agg_type)) {
         vector_expr_list_push(expr_list, *expr);
     }
 }
 
-struct Plan *build_plan(struct Pager *pager, struct SelectStatement *stmt) {
+static bool is_count_star(struct SelectStatement *stmt) {
+    // SELECT COUNT(*) FROM t, with nothing that needs the rows themselves
+    if (stmt->where_list != NULL || stmt->group_by_list != NULL || stmt->select_list->count != 1) {
+        return false;
+    }
+
+    struct Expr *expr = &stmt->select_list->data[0];
+    enum AggType type;
+
+    return expr->type == EXPR_FUNCTION
+        && aggregate_type_from_name(expr->function.name, &type)
+        && type == AGG_COUNT
+        && expr->function.args != NULL
+        && expr->function.args->count == 1
+        && expr->function.args->data[0].type == EXPR_STAR;
+}
+
+struct PlanConfig plan_default_config(void) {
+    return (struct PlanConfig){ .scan_threads = 1, .batch_execution = true, .sort_memory = DEFAULT_SORT_MEMORY };
+}
+
+struct Plan *build_plan(struct Pager *pager, struct SelectStatement *stmt, struct PlanConfig *config) {
     assert(stmt);
     assert(stmt->from_table);
     assert(stmt->select_list);
@@ -84,29 +142,72 @@ struct Plan *build_plan(struct Pager *pager, struct SelectStatement *stmt) {
     struct Resolver *resolver = new_resolver(query_has_aggregates);
     resolver_init(resolver, pager, stmt);
 
+    if (is_count_star(stmt)) {
+        // Counting cells on the leaf pages gives the answer without decoding a single row
+        fprintf(stderr, "   build_plan: count leaf cells\n");
+        struct SchemaRecord *schema_record = get_schema_record_for_table(pager, stmt->from_table);
+        struct Plan *plan = make_count_scan(pager, schema_record->body.root_page);
+        if (stmt->limit >= 0) {
+            plan = make_limit(plan, (uint64_t)stmt->limit, (uint64_t)stmt->offset);
+        }
+        return make_projection(plan, get_projection_indexes(resolver, stmt));
+    }
+
     fprintf(stderr, "   build_plan: make table scan\n");
-    struct Plan *plan = make_table_scan(pager, stmt);
+    struct Plan *plan = make_table_scan(pager, stmt, resolver);
 
     fprintf(stderr, "   build_plan: columns:\n");
 
     fprintf(stderr, "   build_plan: make filter:\n");
     if (stmt->where_list != NULL) {
         resolve_column_names(resolver, stmt->where_list, PLAN_FILTER);
+    }
+
+    // Without anything between the scan and a LIMIT only the first rows of the table are
+    // read, a serial scan reads no more than it needs and can skip the OFFSET rows
+    bool limits_scan = stmt->limit >= 0 && stmt->where_list == NULL && stmt->order_by_list == NULL && stmt->group_by_list == NULL && !query_has_aggregates;
+
+    if (config->scan_threads > 1 && ((struct TableScan *)plan)->mode == SCAN_FULL && !limits_scan) {
+        // The workers apply the WHERE predicates themselves, no filter is needed above
+        plan = make_parallel_scan(pager, (struct TableScan *)plan, stmt->where_list, config->scan_threads);
+    } else if (stmt->where_list != NULL) {
         plan = make_filter(plan, stmt->where_list);
     }
     fprintf(stderr, "   build_plan: filter made:\n");
 
     fprintf(stderr, "   build_plan: collect aggregates:\n");
 
-    if (query_has_aggregates) {
+    for (size_t i = 0; i < aggregate_exprs->count; i++) {
+        resolve_column_names(resolver, aggregate_exprs->data[i].function.args, PLAN_AGGREGATE);
+    }
+
+    if (stmt->group_by_list != NULL) {
+        fprintf(stderr, "   Plan groups rows.\n");
+        resolve_column_names(resolver, stmt->group_by_list, PLAN_HASH_AGGREGATE);
+        plan = make_hash_aggregate(plan, stmt->group_by_list, aggregate_exprs);
+    } else if (query_has_aggregates) {
         fprintf(stderr, "   Plan contains aggregates.\n");
         plan = make_aggregate(plan, aggregate_exprs);
     }
     fprintf(stderr, "   build_plan: aggregates collected:\n");
 
+    if (stmt->order_by_list != NULL && stmt->limit >= 0) {
+        // Only the first rows in order are wanted, a bounded heap keeps them without sorting the rest
+        fprintf(stderr, "   build_plan: make top n:\n");
+        plan = make_top_n(plan, get_sort_key_indexes(resolver, stmt), stmt->order_by_sort, (uint64_t)stmt->limit, (uint64_t)stmt->offset);
+    } else if (stmt->order_by_list != NULL) {
+        // Below the projection, so rows can be ordered by columns that are not selected
+        fprintf(stderr, "   build_plan: make sort:\n");
+        plan = make_sort(plan, get_sort_key_indexes(resolver, stmt), stmt->order_by_sort, config->sort_memory);
+    } else if (stmt->limit >= 0) {
+        // Stops pulling rows once it has enough and closes the plan below
+        fprintf(stderr, "   build_plan: make limit:\n");
+        plan = make_limit(plan, (uint64_t)stmt->limit, (uint64_t)stmt->offset);
+    }
+
     fprintf(stderr, "   build_plan: make projection:\n");
     struct SizeTVec *indexes = get_projection_indexes(resolver, stmt);
-    plan = make_projection(plan, indexes, resolver->first_col_is_rowid);
+    plan = make_projection(plan, indexes);
     fprintf(stderr, "   build_plan: projection made:\n");
     return plan;
 }
@@ -135,18 +236,179 @@ bool plan_next(struct Pager *pager, struct Plan *plan, struct Row *row) {
             // fprintf(stderr, "projection_next\n");
             return projection_next(pager, (struct Projection *)plan, row);
 
+        case PLAN_PARALLEL_SCAN:
+            return parallel_scan_next((struct ParallelScan *)plan, row);
+
+        case PLAN_COUNT_SCAN:
+            return count_scan_next((struct CountScan *)plan, row);
+
+        case PLAN_HASH_AGGREGATE:
+            return hash_aggregate_next(pager, (struct HashAggregate *)plan, row);
+
+        case PLAN_SORT:
+            return sort_next(pager, (struct Sort *)plan, row);
+
+        case PLAN_TOP_N:
+            return top_n_next(pager, (struct TopN *)plan, row);
+
+        case PLAN_LIMIT:
+            return limit_next(pager, (struct Limit *)plan, row);
+
         default:
             return false;
     }
 }
 
-void plan_execute(struct Pager *pager, struct Plan *plan) {
-    fprintf(stderr, "Execute Plan\n");
+static bool rows_next_batch(struct Pager *pager, struct Plan *plan, const struct ColumnMask *mask, struct ColumnBatch **batch) {
+    // Plans without a batch path of their own hand out their rows collected into batches
+    if (plan->batch == NULL) {
+        plan->batch = column_batch_new(mask != NULL ? (uint32_t)mask->column_count : 0);
+    }
+
+    struct ColumnBatch *output = plan->batch;
+    struct Row row;
+    column_batch_reset(output);
+
+    while (!column_batch_is_full(output) && plan_next(pager, plan, &row)) {
+        column_batch_append_row(output, &row, mask);
+    }
+
+    *batch = output;
+    return output->row_count > 0;
+}
+
+bool plan_next_batch(struct Pager *pager, struct Plan *plan, struct ColumnBatch **batch) {
+    // Like plan_next, but up to BATCH_SIZE rows at a time. A batch may have no selected rows
+    // left, false means the plan has no more rows.
+    if (plan == NULL) {
+        fprintf(stderr, "plan_next_batch: NULL plan\n");
+        exit(1);
+    }
+
+    switch(plan->type) {
+
+        case PLAN_TABLE_SCAN:
+            return table_scan_next_batch((struct TableScan *)plan, batch);
+
+        case PLAN_AGGREGATE:
+            return aggregate_next_batch(pager, (struct Aggregate *)plan, batch);
+
+        case PLAN_FILTER:
+            return filter_next_batch(pager, (struct Filter *)plan, batch);
+
+        case PLAN_PROJECTION:
+            return projection_next_batch(pager, (struct Projection *)plan, batch);
+
+        case PLAN_PARALLEL_SCAN:
+            return rows_next_batch(pager, plan, &((struct ParallelScan *)plan)->column_mask, batch);
+
+        case PLAN_COUNT_SCAN:
+            return rows_next_batch(pager, plan, NULL, batch);
+
+        case PLAN_HASH_AGGREGATE:
+            return hash_aggregate_next_batch(pager, (struct HashAggregate *)plan, batch);
+
+        case PLAN_SORT:
+            return sort_next_batch(pager, (struct Sort *)plan, batch);
+
+        case PLAN_TOP_N:
+            return top_n_next_batch(pager, (struct TopN *)plan, batch);
+
+        case PLAN_LIMIT:
+            return limit_next_batch(pager, (struct Limit *)plan, batch);
+
+        default:
+            return false;
+    }
+}
+
+void plan_close(struct Plan *plan) {
+    // No more rows will be pulled from plan. Scans unpin their pages and parallel workers
+    // stop, a sort deletes its run files, every other plan passes it down to its child.
+    switch(plan->type) {
+
+        case PLAN_TABLE_SCAN:
+            table_scan_close((struct TableScan *)plan);
+            break;
+
+        case PLAN_PARALLEL_SCAN:
+            parallel_scan_close((struct ParallelScan *)plan);
+            break;
+
+        case PLAN_COUNT_SCAN:
+            ((struct CountScan *)plan)->done = true;
+            break;
+
+        case PLAN_FILTER:
+            plan_close(((struct Filter *)plan)->child);
+            break;
+
+        case PLAN_PROJECTION:
+            plan_close(((struct Projection *)plan)->child);
+            break;
+
+        case PLAN_AGGREGATE:
+            plan_close(((struct Aggregate *)plan)->child);
+            break;
+
+        case PLAN_HASH_AGGREGATE:
+            plan_close(((struct HashAggregate *)plan)->child);
+            break;
+
+        case PLAN_SORT:
+            sort_close((struct Sort *)plan);
+            plan_close(((struct Sort *)plan)->child);
+            break;
+
+        case PLAN_TOP_N:
+            plan_close(((struct TopN *)plan)->child);
+            break;
+
+        case PLAN_LIMIT:
+            plan_close(((struct Limit *)plan)->child);
+            break;
+    }
+}
+
+static void execute_rows(struct Pager *pager, struct Plan *plan) {
     struct Row row;
+    // Rows are owned by the plan that produced them and only valid until the next plan_next
     while (plan_next(pager, plan, &row)) {
         print_row(&row);
-        free(row.values);
-        row.values = NULL;
-        row.column_count = 0;
     }
-}
\ No newline at end of file
+}
+
+static void execute_batches(struct Pager *pager, struct Plan *plan) {
+    struct ColumnBatch *batch;
+    struct Value *values = NULL;
+    uint32_t value_capacity = 0;
+
+    while (plan_next_batch(pager, plan, &batch)) {
+        if (batch->column_count > value_capacity) {
+            values = realloc(values, batch->column_count * sizeof(struct Value));
+            if (!values) {
+                fprintf(stderr, "execute_batches: values realloc failed\n");
+                exit(1);
+            }
+            value_capacity = batch->column_count;
+        }
+
+        for (uint32_t i = 0; i < batch->selected_count; i++) {
+            struct Row row;
+            column_batch_get_row(batch, batch->selection[i], values, &row);
+            print_row(&row);
+        }
+    }
+
+    free(values);
+}
+
+void plan_execute(struct Pager *pager, struct Plan *plan, struct PlanConfig *config) {
+    fprintf(stderr, "Execute Plan\n");
+
+    if (config->batch_execution) {
+        execute_batches(pager, plan);
+    } else {
+        execute_rows(pager, plan);
+    }
+}
@@ -6,19 +6,38 @@
 #include "../ast.h"
 #include "../data_parsing/row_parsing.h"
 
+#define DEFAULT_SORT_MEMORY (64 * 1024 * 1024)
+
 DEFINE_VECTOR(size_t, SizeTVec, size_t)
+DEFINE_VECTOR(uint32_t, PageNumberVec, page_number_vec)
 
 enum PlanType {
     PLAN_TABLE_SCAN,
     PLAN_FILTER,
     PLAN_PROJECTION,
-    PLAN_AGGREGATE
+    PLAN_AGGREGATE,
+    PLAN_PARALLEL_SCAN,
+    PLAN_COUNT_SCAN,
+    PLAN_HASH_AGGREGATE,
+    PLAN_SORT,
+    PLAN_TOP_N,
+    PLAN_LIMIT
+};
+
+// Settings for executing a query, see plan_default_config
+struct PlanConfig {
+    uint32_t    scan_threads;       // Worker threads for full table scans, 1 scans on the calling thread
+    bool        batch_execution;    // Move rows through the plan in column batches instead of one at a time
+    size_t      sort_memory;        // Bytes ORDER BY sorts in before it spills sorted runs to temporary files
 };
 
 
 
+struct ColumnBatch;
+
 struct Plan {
-    enum PlanType type;
+    enum PlanType       type;
+    struct ColumnBatch  *batch;     // Batches handed out by plan_next_batch, made on the first call
 };
 
 struct Index {
@@ -32,8 +51,11 @@ struct Index {
 bool expr_contains_aggregate(struct Expr *expr);
 bool expr_list_contains_aggregate(struct ExprList *expr_list);
 bool plan_next(struct Pager *pager, struct Plan *plan, struct Row *row);
+bool plan_next_batch(struct Pager *pager, struct Plan *plan, struct ColumnBatch **batch);
+void plan_close(struct Plan *plan);
 
-struct Plan *build_plan(struct Pager *pager, struct SelectStatement *stmt);
-void plan_execute(struct Pager *pager, struct Plan *plan);
+struct PlanConfig plan_default_config(void);
+struct Plan *build_plan(struct Pager *pager, struct SelectStatement *stmt, struct PlanConfig *config);
+void plan_execute(struct Pager *pager, struct Plan *plan, struct PlanConfig *config);
 
 #endif
\ No newline at end of file
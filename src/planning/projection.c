@@ -6,8 +6,9 @@
 #include "../sql_utils.h"
 #include "plan.h"
 #include "../data_parsing/row_parsing.h"
+#include "column_batch.h"
 
-struct Plan *make_projection(struct Plan *plan, struct SizeTVec *indexes, bool first_col_is_rowid) {
+struct Plan *make_projection(struct Plan *plan, struct SizeTVec *indexes) {
     struct Projection *projection = malloc(sizeof(struct Projection));
     if (!projection) {
         fprintf(stderr, "make_projection: *projection malloc failed\n");
@@ -15,11 +16,15 @@ struct Plan *make_projection(struct Plan *plan, struct SizeTVec *indexes, bool f
     }
 
     projection->base.type           = PLAN_PROJECTION;
+    projection->base.batch          = NULL;
     projection->child               = plan;
     projection->column_indexes      = indexes;
-    projection->first_col_is_rowid  = first_col_is_rowid;
+    projection->values              = malloc(indexes->count * sizeof(struct Value));
 
-    fprintf(stderr, "Projection: first_col_is_rowid: %d\n", first_col_is_rowid);
+    if (!projection->values) {
+        fprintf(stderr, "make_projection: *projection->values malloc failed\n");
+        exit(1);
+    }
 
     return &projection->base;
 }
@@ -31,25 +36,39 @@ bool projection_next(struct Pager *pager, struct Projection *projection, struct
     }
 
     // print_row_to_stderr(row);
-    struct Row original_row_order;
-    original_row_order.column_count = row->column_count;
-    original_row_order.values = malloc(row->column_count * sizeof(struct Value));
-    if (!original_row_order.values) {
-        fprintf(stderr, "projection_next: *original_row_order.values malloc failed\n");
-        exit(1);
+    // The child's row stays untouched, the selected columns are copied into our own row.
+    // A rowid alias column already holds the rowid, the table scan fills it in.
+    for (size_t i = 0; i < projection->column_indexes->count; i++) {
+        size_t idx = projection->column_indexes->data[i];
+        projection->values[i] = row->values[idx];
     }
-    memcpy(original_row_order.values, row->values, row->column_count * sizeof(struct Value));
 
-    if (projection->first_col_is_rowid) {
-        row->values[0] = (struct Value){ .type = VALUE_INT, .int_value = { .value = row->rowid } };
+    row->values = projection->values;
+    row->column_count = projection->column_indexes->count;
+    return true;
+}
+
+bool projection_next_batch(struct Pager *pager, struct Projection *projection, struct ColumnBatch **batch) {
+    // The output is a view of the child's batch with the selected columns, no value is copied
+    struct ColumnBatch *input;
+    if (!plan_next_batch(pager, projection->child, &input)) {
+        return false;
     }
 
-    for (size_t i = projection->first_col_is_rowid ? 1 : 0; i < projection->column_indexes->count; i++) {
-        size_t idx = projection->column_indexes->data[i];
-        row->values[i] = original_row_order.values[idx];
+    if (projection->base.batch == NULL) {
+        projection->base.batch = column_batch_new_view((uint32_t)projection->column_indexes->count);
     }
 
-    free(original_row_order.values);
-    row->column_count = projection->column_indexes->count;
+    struct ColumnBatch *output = projection->base.batch;
+    output->row_count       = input->row_count;
+    output->selected_count  = input->selected_count;
+    output->selection       = input->selection;
+    output->rowids          = input->rowids;
+
+    for (size_t i = 0; i < projection->column_indexes->count; i++) {
+        output->columns[i] = input->columns[projection->column_indexes->data[i]];
+    }
+
+    *batch = output;
     return true;
-}
\ No newline at end of file
+}
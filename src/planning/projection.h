@@ -7,10 +7,11 @@ struct Projection {
     struct Plan     base;
     struct Plan     *child;
     struct SizeTVec *column_indexes;
-    bool            first_col_is_rowid;
+    struct Value    *values;        // Output row, reused for every row
 };
 
-struct Plan *make_projection(struct Plan *plan, struct SizeTVec *indexes, bool first_col_is_rowid);
+struct Plan *make_projection(struct Plan *plan, struct SizeTVec *indexes);
 bool projection_next(struct Pager *pager, struct Projection *projection, struct Row *row);
+bool projection_next_batch(struct Pager *pager, struct Projection *projection, struct ColumnBatch **batch);
 
 #endif
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
+#include <ctype.h>
 
 #include "../memory.h"
 #include "resolver.h"
@@ -59,6 +61,9 @@ static struct HashMap *get_full_row_col_to_idx_hash_map(struct Resolver *resolve
     // @TODO: should this be elsewhere?
     print_unterminated_string_to_stderr(&columns->data[0].name);
     resolver->first_col_is_rowid = get_is_first_col_rowid(&columns->data[0]);
+    if (resolver->first_col_is_rowid) {
+        resolver->rowid_alias = columns->data[0].name;
+    }
     add_table_to_hash_map(column_to_index, columns, 0);
     // vector_columns_free(columns);
 
@@ -92,7 +97,9 @@ void set_index_for_expr_column(struct Resolver *resolver, struct ExprColumn *exp
     fprintf(stderr, "set_index_for_expr_column: called\n");
     print_expr_column_to_stderr(expr, 4);
     switch (type) {
-        case PLAN_FILTER: {
+        case PLAN_FILTER:
+        case PLAN_AGGREGATE:
+        case PLAN_HASH_AGGREGATE: {
             struct Column column = { .index = 0, .name = expr->name };
             size_t *idx = hash_map_column_to_index_get(resolver->full_row_col_to_idx, &column);
             expr->idx = *idx;
@@ -122,6 +129,9 @@ static void resolve_columns(struct Resolver *resolver, struct Expr *expr, enum P
         case EXPR_BINARY:
             resolve_columns(resolver, expr->binary.left, type);
             resolve_columns(resolver, expr->binary.right, type);
+            if (expr->binary.upper != NULL) {
+                resolve_columns(resolver, expr->binary.upper, type);
+            }
             break;
 
         case EXPR_COLUMN:
@@ -169,6 +179,7 @@ struct Resolver *new_resolver(bool query_has_aggregates) {
     resolver->full_row_col_to_idx       = NULL;
     resolver->post_agg_row_col_to_idx   = NULL;
     resolver->first_col_is_rowid        = false;
+    resolver->rowid_alias               = (struct UnterminatedString){ .start = NULL, .len = 0 };
     resolver->query_has_aggregates      = query_has_aggregates;
 
     return resolver;
@@ -182,14 +193,151 @@ struct Resolver *resolver_init(struct Resolver *resolver, struct Pager *pager, s
     return resolver;
 }
 
+static size_t group_by_position(struct SelectStatement *stmt, struct UnterminatedString *name) {
+    for (size_t i = 0; i < stmt->group_by_list->count; i++) {
+        struct UnterminatedString *group_name = &stmt->group_by_list->data[i].column.name;
+        if (group_name->len == name->len && memcmp(group_name->start, name->start, name->len) == 0) {
+            return i;
+        }
+    }
+
+    fprintf(stderr, "get_projection_indexes: %.*s must appear in the GROUP BY\n", (int)name->len, name->start);
+    exit(1);
+}
+
+static struct SizeTVec *get_grouped_projection_indexes(struct SelectStatement *stmt) {
+    // Grouped rows hold the GROUP BY columns, then one value per aggregate in select list order
+    struct SizeTVec *indexes = vector_size_t_new();
+    size_t aggregate_index = stmt->group_by_list->count;
+
+    for (size_t i = 0; i < stmt->select_list->count; i++) {
+        struct Expr *expr = &stmt->select_list->data[i];
+
+        if (expr->type == EXPR_FUNCTION) {
+            vector_size_t_push(indexes, aggregate_index++);
+        } else if (expr->type == EXPR_COLUMN) {
+            vector_size_t_push(indexes, group_by_position(stmt, &expr->column.name));
+        }
+    }
+
+    return indexes;
+}
+
+static bool same_aggregate(struct Expr *a, struct Expr *b) {
+    // ORDER BY count(*) names the count(*) of the select list, function names ignore case
+    if (strlen(a->function.name) != strlen(b->function.name)) {
+        return false;
+    }
+
+    for (size_t i = 0; a->function.name[i] != '\0'; i++) {
+        if (tolower((unsigned char)a->function.name[i]) != tolower((unsigned char)b->function.name[i])) {
+            return false;
+        }
+    }
+
+    size_t a_count = a->function.args != NULL ? a->function.args->count : 0;
+    size_t b_count = b->function.args != NULL ? b->function.args->count : 0;
+    if (a_count != b_count) {
+        return false;
+    }
+
+    for (size_t i = 0; i < a_count; i++) {
+        struct Expr *a_arg = &a->function.args->data[i];
+        struct Expr *b_arg = &b->function.args->data[i];
+
+        if (a_arg->type != b_arg->type) {
+            return false;
+        }
+
+        if (a_arg->type == EXPR_COLUMN && (a_arg->column.name.len != b_arg->column.name.len
+            || memcmp(a_arg->column.name.start, b_arg->column.name.start, a_arg->column.name.len) != 0)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static size_t aggregate_position(struct SelectStatement *stmt, struct Expr *expr) {
+    // Aggregate rows hold one value per aggregate of the select list, in order
+    size_t position = 0;
+
+    for (size_t i = 0; i < stmt->select_list->count; i++) {
+        struct Expr *item = &stmt->select_list->data[i];
+        if (item->type != EXPR_FUNCTION) {
+            continue;
+        }
+
+        if (same_aggregate(item, expr)) {
+            return position;
+        }
+
+        position++;
+    }
+
+    fprintf(stderr, "get_sort_key_indexes: %.*s must appear in the select list\n", (int)expr->text.len, expr->text.start);
+    exit(1);
+}
+
+struct SizeTVec *get_sort_key_indexes(struct Resolver *resolver, struct SelectStatement *stmt) {
+    // Positions of the ORDER BY terms in the rows the sort sees. Without aggregates these
+    // are table rows, otherwise the rows of the aggregate below it. A number is a position
+    // in the select list, like ORDER BY 2.
+    struct SizeTVec *indexes = vector_size_t_new();
+
+    for (size_t i = 0; i < stmt->order_by_list->count; i++) {
+        struct Expr *expr = &stmt->order_by_list->data[i];
+
+        if (expr->type == EXPR_INTEGER) {
+            if (expr->integer.value < 1 || (uint64_t)expr->integer.value > stmt->select_list->count) {
+                fprintf(stderr, "get_sort_key_indexes: ORDER BY term %lld is out of range\n", (long long)expr->integer.value);
+                exit(1);
+            }
+            expr = &stmt->select_list->data[expr->integer.value - 1];
+        }
+
+        size_t idx;
+
+        if (expr->type == EXPR_FUNCTION && resolver->query_has_aggregates) {
+            size_t key_count = stmt->group_by_list != NULL ? stmt->group_by_list->count : 0;
+            idx = key_count + aggregate_position(stmt, expr);
+        } else if (expr->type == EXPR_COLUMN && stmt->group_by_list != NULL) {
+            idx = group_by_position(stmt, &expr->column.name);
+        } else if (expr->type == EXPR_COLUMN && !resolver->query_has_aggregates) {
+            if (!resolver_get_table_column_index(resolver, &expr->column.name, &idx)) {
+                fprintf(stderr, "get_sort_key_indexes: no such column %.*s\n", (int)expr->column.name.len, expr->column.name.start);
+                exit(1);
+            }
+        } else {
+            fprintf(stderr, "get_sort_key_indexes: cannot order by %.*s\n", (int)expr->text.len, expr->text.start);
+            exit(1);
+        }
+
+        vector_size_t_push(indexes, idx);
+    }
+
+    return indexes;
+}
+
 struct SizeTVec *get_projection_indexes(struct Resolver *resolver, struct SelectStatement *stmt) {
+    if (stmt->group_by_list != NULL) {
+        return get_grouped_projection_indexes(stmt);
+    }
+
     struct HashMap *hash_map = resolver->query_has_aggregates ? resolver->post_agg_row_col_to_idx : resolver->full_row_col_to_idx;
     assert(hash_map != NULL);
     struct SizeTVec *indexes = vector_size_t_new();
 
     // @TODO: currently only handling column expr
+    // Aggregate rows hold one value per aggregate, in select list order
+    size_t aggregate_index = 0;
     for (size_t i = 0; i < stmt->select_list->count; i++) {
         struct Expr *expr = &stmt->select_list->data[i];
+        if (expr->type == EXPR_FUNCTION && resolver->query_has_aggregates) {
+            vector_size_t_push(indexes, aggregate_index++);
+            continue;
+        }
+
         if (expr->type != EXPR_COLUMN) {
             continue;
         }
@@ -202,4 +350,81 @@ struct SizeTVec *get_projection_indexes(struct Resolver *resolver, struct Select
     }
 
     return indexes;
-}
\ No newline at end of file
+}
+bool resolver_get_table_column_index(struct Resolver *resolver, struct UnterminatedString *name, size_t *idx) {
+    // Position of a column in rows read from the table
+    struct Column column = { .index = 0, .name = *name };
+    size_t *found = hash_map_column_to_index_get(resolver->full_row_col_to_idx, &column);
+
+    if (found == NULL) {
+        return false;
+    }
+
+    *idx = *found;
+    return true;
+}
+
+size_t resolver_table_column_count(struct Resolver *resolver) {
+    return resolver->full_row_col_to_idx->element_count;
+}
+
+static void mark_expr_columns(struct Resolver *resolver, struct Expr *expr, struct ColumnMask *mask) {
+    switch (expr->type) {
+        case EXPR_INTEGER:
+        case EXPR_STRING:
+            break;
+
+        case EXPR_BINARY:
+            mark_expr_columns(resolver, expr->binary.left, mask);
+            mark_expr_columns(resolver, expr->binary.right, mask);
+            if (expr->binary.upper != NULL) {
+                mark_expr_columns(resolver, expr->binary.upper, mask);
+            }
+            break;
+
+        case EXPR_COLUMN: {
+            size_t idx;
+            if (resolver_get_table_column_index(resolver, &expr->column.name, &idx)) {
+                column_mask_set(mask, idx);
+            }
+            break;
+        }
+
+        case EXPR_FUNCTION:
+            for (size_t i = 0; i < expr->function.args->count; i++) {
+                struct Expr *arg = &expr->function.args->data[i];
+
+                // count(*) does not read any column
+                if (arg->type != EXPR_STAR) {
+                    mark_expr_columns(resolver, arg, mask);
+                }
+            }
+            break;
+
+        case EXPR_UNARY:
+            mark_expr_columns(resolver, expr->unary.right, mask);
+            break;
+
+        default:
+            // SELECT * reads every column
+            column_mask_set_all(mask);
+            break;
+    }
+}
+
+void resolver_column_mask(struct Resolver *resolver, struct SelectStatement *stmt, struct ColumnMask *mask) {
+    // Table columns the select, where, group by and order by lists read, the scan decodes only these
+    column_mask_init(mask, resolver_table_column_count(resolver));
+
+    struct ExprList *lists[] = { stmt->select_list, stmt->where_list, stmt->group_by_list, stmt->order_by_list };
+
+    for (size_t i = 0; i < sizeof(lists) / sizeof(lists[0]); i++) {
+        if (lists[i] == NULL) {
+            continue;
+        }
+
+        for (size_t j = 0; j < lists[i]->count; j++) {
+            mark_expr_columns(resolver, &lists[i]->data[j], mask);
+        }
+    }
+}
@@ -11,6 +11,7 @@ struct Resolver {
     struct HashMap *full_row_col_to_idx;
     struct HashMap *post_agg_row_col_to_idx;
     bool            first_col_is_rowid;
+    struct UnterminatedString rowid_alias;  // Name of the first column when it is an alias for the rowid
     bool            query_has_aggregates;
 };
 
@@ -18,5 +19,9 @@ void resolve_column_names(struct Resolver *resolver, struct ExprList *expr_list,
 struct Resolver *new_resolver(bool query_has_aggregates);
 struct Resolver *resolver_init(struct Resolver *resolver, struct Pager *pager, struct SelectStatement *stmt);
 struct SizeTVec *get_projection_indexes(struct Resolver *resolver, struct SelectStatement *stmt);
+struct SizeTVec *get_sort_key_indexes(struct Resolver *resolver, struct SelectStatement *stmt);
+bool resolver_get_table_column_index(struct Resolver *resolver, struct UnterminatedString *name, size_t *idx);
+size_t resolver_table_column_count(struct Resolver *resolver);
+void resolver_column_mask(struct Resolver *resolver, struct SelectStatement *stmt, struct ColumnMask *mask);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,736 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sort.h"
+#include "column_batch.h"
+#include "../comparisons.h"
+
+#define INITIAL_ROWS_ARENA_CAPACITY (64 * 1024)
+#define INITIAL_ENTRY_CAPACITY (1024)
+
+// Stretches of entries sorted by insertion before the merge passes
+#define INSERTION_SORT_WIDTH (16)
+
+// Entries are sorted in chunks small enough that their rows stay in cache, and the chunks
+// merged with the heap that merges run files. Comparing every row against the whole array
+// in merge passes would miss the cache on nearly every row.
+#define SORT_CHUNK_ENTRIES (8192)
+
+// stdio buffer of a run file, the budget decides how many are read at once in a merge
+#define RUN_BUFFER_SIZE (64 * 1024)
+
+// A run file row: rowid, byte count of the columns, then each column as its type and value
+#define RUN_ROW_HEADER_SIZE (sizeof(uint64_t) + sizeof(uint32_t))
+
+struct Plan *make_sort(struct Plan *plan, struct SizeTVec *keys, struct SortTypeList *sort_types, size_t memory_budget) {
+    struct Sort *sort = malloc(sizeof(struct Sort));
+    if (!sort) {
+        fprintf(stderr, "make_sort: *sort malloc failed\n");
+        exit(1);
+    }
+
+    if (keys->count == 0 || keys->count != sort_types->count) {
+        fprintf(stderr, "make_sort: %zu keys and %zu sort types\n", keys->count, sort_types->count);
+        exit(1);
+    }
+
+    memset(sort, 0, sizeof *sort);
+    sort->base.type         = PLAN_SORT;
+    sort->child             = plan;
+    sort->keys              = keys;
+    sort->sort_types        = sort_types;
+    sort->memory_budget     = memory_budget;
+    sort->rows_arena        = arena_new(INITIAL_ROWS_ARENA_CAPACITY);
+    sort->scratch           = malloc(SORT_CHUNK_ENTRIES * sizeof(struct SortEntry));
+
+    if (!sort->rows_arena.buffer || !sort->scratch) {
+        fprintf(stderr, "make_sort: malloc failed\n");
+        exit(1);
+    }
+
+    return &sort->base;
+}
+
+static struct SortRow *row_at(struct Sort *sort, size_t offset) {
+    return (struct SortRow *)(sort->rows_arena.buffer + offset);
+}
+
+static uint64_t order_bits(double value) {
+    // Doubles compare like unsigned integers once negative ones have every bit flipped and
+    // positive ones the sign bit set
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof bits);
+    return (bits >> 63) != 0 ? ~bits : bits | ((uint64_t)1 << 63);
+}
+
+uint64_t sort_key_prefix(struct Value *value, enum SortType sort_type) {
+    // The type rank in the top two bits, NULLs then numbers then text, then the top 62 bits
+    // of the value. Integers go through a double so they order among floats, and text
+    // keeps its first eight bytes. Different values may share a prefix but never have
+    // prefixes in the wrong order.
+    uint64_t rank = 0;
+    uint64_t bits = 0;
+
+    switch (value->type) {
+        case VALUE_NULL:
+            break;
+
+        case VALUE_INT:
+            rank = 1;
+            bits = order_bits((double)value->int_value.value);
+            break;
+
+        case VALUE_FLOAT:
+            rank = 1;
+            bits = order_bits(value->float_value.value);
+            break;
+
+        case VALUE_TEXT: {
+            struct UnterminatedString *text = &value->text_value.text;
+            size_t len = text->len < sizeof bits ? text->len : sizeof bits;
+
+            rank = 2;
+            for (size_t i = 0; i < len; i++) {
+                bits |= (uint64_t)(unsigned char)text->start[i] << (56 - 8 * i);
+            }
+            break;
+        }
+    }
+
+    uint64_t prefix = rank << 62 | bits >> 2;
+    return sort_type == SORT_DESC ? ~prefix : prefix;
+}
+
+int sort_compare_rows(struct SizeTVec *keys, struct SortTypeList *sort_types, struct Value *a, struct Value *b) {
+    for (size_t i = 0; i < keys->count; i++) {
+        size_t column = keys->data[i];
+        int cmp = compare_index_key(&a[column], &b[column]);
+
+        if (cmp != 0) {
+            return sort_types->data[i] == SORT_DESC ? -cmp : cmp;
+        }
+    }
+
+    return 0;
+}
+
+static int compare_entries(struct Sort *sort, struct SortEntry *a, struct SortEntry *b) {
+    if (a->prefix != b->prefix) {
+        return a->prefix < b->prefix ? -1 : 1;
+    }
+
+    struct SortRow *x = row_at(sort, a->row);
+    struct SortRow *y = row_at(sort, b->row);
+
+    for (size_t i = 0; i < sort->keys->count; i++) {
+        size_t column = sort->keys->data[i];
+        struct Value u, v;
+
+        stored_value_get(&sort->rows_arena, &x->values[column], &u);
+        stored_value_get(&sort->rows_arena, &y->values[column], &v);
+
+        int cmp = compare_index_key(&u, &v);
+        if (cmp != 0) {
+            return sort->sort_types->data[i] == SORT_DESC ? -cmp : cmp;
+        }
+    }
+
+    return 0;
+}
+
+static void insertion_sort(struct Sort *sort, struct SortEntry *entries, size_t count) {
+    for (size_t i = 1; i < count; i++) {
+        struct SortEntry entry = entries[i];
+        size_t j = i;
+
+        while (j > 0 && compare_entries(sort, &entry, &entries[j - 1]) < 0) {
+            entries[j] = entries[j - 1];
+            j--;
+        }
+
+        entries[j] = entry;
+    }
+}
+
+static void sort_chunk(struct Sort *sort, struct SortEntry *entries, size_t count) {
+    // Bottom up merge sort over stretches sorted by insertion, stable so rows with equal keys
+    // keep the order they came in. count is at most SORT_CHUNK_ENTRIES, the scratch length.
+    for (size_t start = 0; start < count; start += INSERTION_SORT_WIDTH) {
+        size_t remaining = count - start;
+        insertion_sort(sort, entries + start, remaining < INSERTION_SORT_WIDTH ? remaining : INSERTION_SORT_WIDTH);
+    }
+
+    struct SortEntry *from  = entries;
+    struct SortEntry *to    = sort->scratch;
+
+    for (size_t width = INSERTION_SORT_WIDTH; width < count; width *= 2) {
+        for (size_t low = 0; low < count; low += 2 * width) {
+            size_t middle   = low + width < count ? low + width : count;
+            size_t high     = low + 2 * width < count ? low + 2 * width : count;
+            size_t i = low, j = middle, k = low;
+
+            while (i < middle && j < high) {
+                to[k++] = compare_entries(sort, &from[j], &from[i]) < 0 ? from[j++] : from[i++];
+            }
+            while (i < middle) {
+                to[k++] = from[i++];
+            }
+            while (j < high) {
+                to[k++] = from[j++];
+            }
+        }
+
+        struct SortEntry *swap = from;
+        from    = to;
+        to      = swap;
+    }
+
+    if (from != entries) {
+        memcpy(entries, from, count * sizeof(struct SortEntry));
+    }
+}
+
+static void ensure_bytes(unsigned char **bytes, size_t *capacity, size_t size) {
+    if (size <= *capacity) {
+        return;
+    }
+
+    size_t new_capacity = *capacity > 0 ? *capacity : 256;
+    while (new_capacity < size) {
+        new_capacity *= 2;
+    }
+
+    *bytes = realloc(*bytes, new_capacity);
+    if (!*bytes) {
+        fprintf(stderr, "ensure_bytes: realloc failed\n");
+        exit(1);
+    }
+    *capacity = new_capacity;
+}
+
+static void write_row(struct Sort *sort, FILE *file, uint64_t rowid, struct Value *values) {
+    size_t size = 0;
+    for (uint64_t i = 0; i < sort->column_count; i++) {
+        size += 1;
+        if (values[i].type == VALUE_INT || values[i].type == VALUE_FLOAT) {
+            size += sizeof(int64_t);
+        } else if (values[i].type == VALUE_TEXT) {
+            size += sizeof(uint32_t) + values[i].text_value.text.len;
+        }
+    }
+
+    if (size > UINT32_MAX) {
+        fprintf(stderr, "write_row: row of %zu bytes is too long\n", size);
+        exit(1);
+    }
+
+    ensure_bytes(&sort->bytes, &sort->byte_capacity, RUN_ROW_HEADER_SIZE + size);
+
+    unsigned char *p = sort->bytes;
+    uint32_t column_bytes = (uint32_t)size;
+    memcpy(p, &rowid, sizeof rowid);
+    p += sizeof rowid;
+    memcpy(p, &column_bytes, sizeof column_bytes);
+    p += sizeof column_bytes;
+
+    for (uint64_t i = 0; i < sort->column_count; i++) {
+        struct Value *value = &values[i];
+        *p++ = (unsigned char)value->type;
+
+        switch (value->type) {
+            case VALUE_NULL:
+                break;
+
+            case VALUE_INT:
+                memcpy(p, &value->int_value.value, sizeof(int64_t));
+                p += sizeof(int64_t);
+                break;
+
+            case VALUE_FLOAT:
+                memcpy(p, &value->float_value.value, sizeof(double));
+                p += sizeof(double);
+                break;
+
+            case VALUE_TEXT: {
+                uint32_t len = (uint32_t)value->text_value.text.len;
+                memcpy(p, &len, sizeof len);
+                p += sizeof len;
+                memcpy(p, value->text_value.text.start, len);
+                p += len;
+                break;
+            }
+        }
+    }
+
+    size_t total = (size_t)(p - sort->bytes);
+    if (fwrite(sort->bytes, 1, total, file) != total) {
+        fprintf(stderr, "write_row: fwrite failed\n");
+        exit(1);
+    }
+}
+
+static bool read_row(struct Sort *sort, struct SortRun *run) {
+    unsigned char header[RUN_ROW_HEADER_SIZE];
+    size_t read = fread(header, 1, sizeof header, run->file);
+
+    if (read == 0 && feof(run->file)) {
+        return false;
+    }
+
+    uint32_t column_bytes;
+    if (read != sizeof header) {
+        fprintf(stderr, "read_row: run file is truncated\n");
+        exit(1);
+    }
+
+    memcpy(&run->rowid, header, sizeof run->rowid);
+    memcpy(&column_bytes, header + sizeof run->rowid, sizeof column_bytes);
+    ensure_bytes(&run->bytes, &run->byte_capacity, column_bytes);
+
+    if (fread(run->bytes, 1, column_bytes, run->file) != column_bytes) {
+        fprintf(stderr, "read_row: run file is truncated\n");
+        exit(1);
+    }
+
+    // Text points into bytes, valid until the next row is read
+    const unsigned char *p = run->bytes;
+    for (uint64_t i = 0; i < sort->column_count; i++) {
+        struct Value *value = &run->values[i];
+        value->type = (enum ValueType)*p++;
+
+        switch (value->type) {
+            case VALUE_NULL:
+                value->null_value.null_ptr = NULL;
+                break;
+
+            case VALUE_INT:
+                memcpy(&value->int_value.value, p, sizeof(int64_t));
+                p += sizeof(int64_t);
+                break;
+
+            case VALUE_FLOAT:
+                memcpy(&value->float_value.value, p, sizeof(double));
+                p += sizeof(double);
+                break;
+
+            case VALUE_TEXT: {
+                uint32_t len;
+                memcpy(&len, p, sizeof len);
+                p += sizeof len;
+                value->text_value.text = (struct UnterminatedString){ .start = (const char *)p, .len = len };
+                p += len;
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+static bool run_next(struct Sort *sort, struct SortRun *run) {
+    // Moves a run to its next row, a run file is closed once it has none left
+    if (run->in_memory) {
+        if (run->next_entry == run->end_entry) {
+            return false;
+        }
+
+        struct SortEntry *entry = &sort->entries[run->next_entry++];
+        struct SortRow *row = row_at(sort, entry->row);
+
+        run->rowid  = row->rowid;
+        run->prefix = entry->prefix;
+        for (uint64_t i = 0; i < sort->column_count; i++) {
+            stored_value_get(&sort->rows_arena, &row->values[i], &run->values[i]);
+        }
+        return true;
+    }
+
+    if (run->file == NULL) {
+        return false;
+    }
+
+    if (!read_row(sort, run)) {
+        fclose(run->file);
+        free(run->bytes);
+        run->file           = NULL;
+        run->bytes          = NULL;
+        run->byte_capacity  = 0;
+        return false;
+    }
+
+    run->prefix = sort_key_prefix(&run->values[sort->keys->data[0]], sort->sort_types->data[0]);
+    return true;
+}
+
+static FILE *open_run_file(void) {
+    // Removed by the C library when it is closed or the program exits
+    FILE *file = tmpfile();
+    if (!file) {
+        fprintf(stderr, "open_run_file: tmpfile failed\n");
+        exit(1);
+    }
+
+    setvbuf(file, NULL, _IOFBF, RUN_BUFFER_SIZE);
+    return file;
+}
+
+static struct SortRun *add_run(struct Sort *sort) {
+    if (sort->run_count == sort->run_capacity) {
+        sort->run_capacity  = sort->run_capacity > 0 ? sort->run_capacity * 2 : 8;
+        sort->runs          = realloc(sort->runs, sort->run_capacity * sizeof(struct SortRun));
+        sort->heap          = realloc(sort->heap, sort->run_capacity * sizeof(size_t));
+
+        if (!sort->runs || !sort->heap) {
+            fprintf(stderr, "add_run: realloc failed\n");
+            exit(1);
+        }
+    }
+
+    struct SortRun *run = &sort->runs[sort->run_count++];
+    memset(run, 0, sizeof *run);
+
+    run->values = malloc((sort->column_count > 0 ? sort->column_count : 1) * sizeof(struct Value));
+    if (!run->values) {
+        fprintf(stderr, "add_run: values malloc failed\n");
+        exit(1);
+    }
+
+    return run;
+}
+
+static void add_file_run(struct Sort *sort, FILE *file) {
+    // Written from the start, read back from the start
+    rewind(file);
+    add_run(sort)->file = file;
+}
+
+static int compare_runs(struct Sort *sort, size_t a, size_t b) {
+    struct SortRun *x = &sort->runs[a];
+    struct SortRun *y = &sort->runs[b];
+
+    if (x->prefix != y->prefix) {
+        return x->prefix < y->prefix ? -1 : 1;
+    }
+
+    int cmp = sort_compare_rows(sort->keys, sort->sort_types, x->values, y->values);
+    if (cmp != 0) {
+        return cmp;
+    }
+
+    // Earlier runs hold earlier rows
+    return (a > b) - (a < b);
+}
+
+static void sift_down(struct Sort *sort, size_t i) {
+    size_t *heap = sort->heap;
+
+    while (true) {
+        size_t smallest = i;
+        size_t left     = 2 * i + 1;
+        size_t right    = left + 1;
+
+        if (left < sort->heap_count && compare_runs(sort, heap[left], heap[smallest]) < 0) {
+            smallest = left;
+        }
+        if (right < sort->heap_count && compare_runs(sort, heap[right], heap[smallest]) < 0) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            return;
+        }
+
+        size_t swap     = heap[i];
+        heap[i]         = heap[smallest];
+        heap[smallest]  = swap;
+        i               = smallest;
+    }
+}
+
+static void start_merge(struct Sort *sort, size_t first, size_t count) {
+    // A heap of the runs first to first + count that have a row
+    sort->heap_count = 0;
+
+    for (size_t i = first; i < first + count; i++) {
+        if (run_next(sort, &sort->runs[i])) {
+            sort->heap[sort->heap_count++] = i;
+        }
+    }
+
+    for (size_t i = sort->heap_count / 2; i-- > 0;) {
+        sift_down(sort, i);
+    }
+}
+
+static void merge_next(struct Sort *sort) {
+    // Moves the run at the top of the heap past its current row
+    if (run_next(sort, &sort->runs[sort->heap[0]])) {
+        sift_down(sort, 0);
+        return;
+    }
+
+    sort->heap[0] = sort->heap[--sort->heap_count];
+    sift_down(sort, 0);
+}
+
+static void add_memory_runs(struct Sort *sort) {
+    // Sorts the entries a chunk at a time, each chunk becomes a run
+    for (size_t start = 0; start < sort->entry_count; start += SORT_CHUNK_ENTRIES) {
+        size_t remaining = sort->entry_count - start;
+        size_t count = remaining < SORT_CHUNK_ENTRIES ? remaining : SORT_CHUNK_ENTRIES;
+
+        sort_chunk(sort, sort->entries + start, count);
+
+        struct SortRun *run = add_run(sort);
+        run->in_memory  = true;
+        run->next_entry = start;
+        run->end_entry  = start + count;
+    }
+}
+
+static void spill_run(struct Sort *sort) {
+    // Merges the rows in memory into a run file, the memory is used again for the rows that
+    // follow
+    FILE *file = open_run_file();
+    size_t first = sort->run_count;
+
+    add_memory_runs(sort);
+    start_merge(sort, first, sort->run_count - first);
+
+    while (sort->heap_count > 0) {
+        struct SortRun *run = &sort->runs[sort->heap[0]];
+        write_row(sort, file, run->rowid, run->values);
+        merge_next(sort);
+    }
+
+    for (size_t i = first; i < sort->run_count; i++) {
+        free(sort->runs[i].values);
+    }
+    sort->run_count = first;
+
+    add_file_run(sort, file);
+
+    sort->entry_count = 0;
+    arena_reset(&sort->rows_arena);
+}
+
+static size_t memory_used(struct Sort *sort) {
+    // Rows with their text, and the entries
+    return sort->rows_arena.offset + sort->entry_count * sizeof(struct SortEntry);
+}
+
+static void set_column_count(struct Sort *sort, struct Row *row) {
+    // Every key has to be a column, rows shorter than the first are padded with NULLs
+    uint64_t column_count = row->column_count;
+
+    for (size_t i = 0; i < sort->keys->count; i++) {
+        if (sort->keys->data[i] >= column_count) {
+            column_count = sort->keys->data[i] + 1;
+        }
+    }
+
+    sort->column_count = column_count;
+}
+
+static void add_row(struct Sort *sort, struct Row *row) {
+    if (sort->column_count == 0) {
+        set_column_count(sort, row);
+    }
+
+    if (sort->entry_count > 0 && memory_used(sort) >= sort->memory_budget) {
+        spill_run(sort);
+    }
+
+    if (sort->entry_count == sort->entry_capacity) {
+        sort->entry_capacity    = sort->entry_capacity > 0 ? sort->entry_capacity * 2 : INITIAL_ENTRY_CAPACITY;
+        sort->entries           = realloc(sort->entries, sort->entry_capacity * sizeof(struct SortEntry));
+
+        if (!sort->entries) {
+            fprintf(stderr, "add_row: entries realloc failed\n");
+            exit(1);
+        }
+    }
+
+    // The row's text follows it in the arena, so comparing rows touches one place in memory.
+    // Storing text can move the arena, the row is found again by its offset.
+    size_t size = sizeof(struct SortRow) + sort->column_count * sizeof(struct StoredValue);
+    struct SortRow *stored = arena_alloc_aligned_checked(&sort->rows_arena, size, _Alignof(struct SortRow));
+    size_t offset = (size_t)((unsigned char *)stored - sort->rows_arena.buffer);
+    stored->rowid = row->rowid;
+
+    for (uint64_t i = 0; i < sort->column_count; i++) {
+        struct StoredValue value = { .type = VALUE_NULL };
+
+        if (i < row->column_count) {
+            stored_value_set(&sort->rows_arena, &value, &row->values[i]);
+        }
+
+        row_at(sort, offset)->values[i] = value;
+    }
+
+    size_t key = sort->keys->data[0];
+    struct Value null_value = { .type = VALUE_NULL };
+
+    sort->entries[sort->entry_count++] = (struct SortEntry){
+        .prefix = sort_key_prefix(key < row->column_count ? &row->values[key] : &null_value, sort->sort_types->data[0]),
+        .row    = offset,
+    };
+}
+
+static void merge_runs(struct Sort *sort, size_t first, size_t count) {
+    // Merges count run files into one that takes their place, so the order of the runs,
+    // and of rows with equal keys, stays the same
+    FILE *file = open_run_file();
+    start_merge(sort, first, count);
+
+    while (sort->heap_count > 0) {
+        struct SortRun *run = &sort->runs[sort->heap[0]];
+        write_row(sort, file, run->rowid, run->values);
+        merge_next(sort);
+    }
+
+    for (size_t i = first; i < first + count; i++) {
+        free(sort->runs[i].values);
+    }
+
+    rewind(file);
+    memset(&sort->runs[first], 0, sizeof(struct SortRun));
+    sort->runs[first].file      = file;
+    sort->runs[first].values    = malloc(sort->column_count * sizeof(struct Value));
+    if (!sort->runs[first].values) {
+        fprintf(stderr, "merge_runs: values malloc failed\n");
+        exit(1);
+    }
+
+    memmove(&sort->runs[first + 1], &sort->runs[first + count], (sort->run_count - first - count) * sizeof(struct SortRun));
+    sort->run_count -= count - 1;
+}
+
+static void finish_building(struct Sort *sort) {
+    sort->built = true;
+
+    if (sort->run_count == 0) {
+        // Everything fit in memory, the chunks are merged as rows are handed out
+        add_memory_runs(sort);
+        start_merge(sort, 0, sort->run_count);
+        return;
+    }
+
+    // The rest is spilled too, which leaves the memory for the buffers of the run files
+    if (sort->entry_count > 0) {
+        spill_run(sort);
+    }
+
+    arena_free(&sort->rows_arena);
+    free(sort->entries);
+    sort->entries       = NULL;
+    sort->entry_count   = 0;
+
+    // More runs than the budget has buffers for are merged in passes until few enough are left
+    size_t fan_in = sort->memory_budget / RUN_BUFFER_SIZE;
+    if (fan_in < 2) {
+        fan_in = 2;
+    }
+
+    while (sort->run_count > fan_in) {
+        for (size_t first = 0; first + 1 < sort->run_count; first++) {
+            size_t remaining = sort->run_count - first;
+            merge_runs(sort, first, remaining < fan_in ? remaining : fan_in);
+        }
+    }
+
+    start_merge(sort, 0, sort->run_count);
+}
+
+static bool next_sorted_row(struct Sort *sort, struct Row *row) {
+    // The row handed out last belongs to the run at the top of the heap, that run only
+    // moves on now so the row stayed valid until this call
+    if (sort->started && sort->heap_count > 0) {
+        merge_next(sort);
+    }
+    sort->started = true;
+
+    if (sort->heap_count == 0) {
+        return false;
+    }
+
+    struct SortRun *run = &sort->runs[sort->heap[0]];
+    row->rowid          = run->rowid;
+    row->column_count   = sort->column_count;
+    row->values         = run->values;
+    return true;
+}
+
+bool sort_next(struct Pager *pager, struct Sort *sort, struct Row *row) {
+    // Consumes every row of the child before the first row comes out
+    if (!sort->built) {
+        while (plan_next(pager, sort->child, row)) {
+            add_row(sort, row);
+        }
+        finish_building(sort);
+    }
+
+    return next_sorted_row(sort, row);
+}
+
+bool sort_next_batch(struct Pager *pager, struct Sort *sort, struct ColumnBatch **batch) {
+    if (!sort->built) {
+        struct ColumnBatch *input;
+        struct Value *values = NULL;
+        uint32_t value_capacity = 0;
+
+        while (plan_next_batch(pager, sort->child, &input)) {
+            if (input->column_count > value_capacity) {
+                values = realloc(values, input->column_count * sizeof(struct Value));
+                if (!values) {
+                    fprintf(stderr, "sort_next_batch: values realloc failed\n");
+                    exit(1);
+                }
+                value_capacity = input->column_count;
+            }
+
+            for (uint32_t i = 0; i < input->selected_count; i++) {
+                struct Row row;
+                column_batch_get_row(input, input->selection[i], values, &row);
+                add_row(sort, &row);
+            }
+        }
+
+        free(values);
+        finish_building(sort);
+    }
+
+    if (sort->base.batch == NULL) {
+        sort->base.batch = column_batch_new((uint32_t)sort->column_count);
+    }
+
+    struct ColumnBatch *output = sort->base.batch;
+    struct Row row;
+    column_batch_reset(output);
+
+    while (!column_batch_is_full(output) && next_sorted_row(sort, &row)) {
+        column_batch_append_row(output, &row, NULL);
+    }
+
+    *batch = output;
+    return output->row_count > 0;
+}
+
+void sort_close(struct Sort *sort) {
+    // Run files the merge has not read to the end are closed, which deletes them
+    for (size_t i = 0; i < sort->run_count; i++) {
+        struct SortRun *run = &sort->runs[i];
+
+        if (run->file != NULL) {
+            fclose(run->file);
+            free(run->bytes);
+            run->file           = NULL;
+            run->bytes          = NULL;
+            run->byte_capacity  = 0;
+        }
+    }
+
+    sort->built         = true;
+    sort->heap_count    = 0;
+}
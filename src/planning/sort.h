@@ -0,0 +1,73 @@
+#ifndef sql_sort
+#define sql_sort
+
+#include <stdio.h>
+
+#include "plan.h"
+#include "../arena.h"
+#include "accumulator.h"
+
+// A row held by the sort, its rowid and one value per column, followed by its text
+struct SortRow {
+    uint64_t            rowid;
+    struct StoredValue  values[];
+};
+
+// What the in memory sort moves around: the first key folded into 64 bits that order the
+// same way as the values, and the arena offset of the row. Rows are only followed when the
+// prefixes are equal.
+struct SortEntry {
+    uint64_t    prefix;
+    size_t      row;
+};
+
+// A sorted run, a temporary file or a chunk of the entries in memory
+struct SortRun {
+    bool            in_memory;
+    FILE            *file;          // Closed once every row has been read
+    size_t          next_entry;     // Of a chunk in memory
+    size_t          end_entry;
+    unsigned char   *bytes;         // The last row read from the file
+    size_t          byte_capacity;
+    uint64_t        rowid;          // Current row
+    uint64_t        prefix;
+    struct Value    *values;
+};
+
+// ORDER BY. Rows of the child are copied into rows_arena and sorted by their entries, a
+// chunk at a time, and the chunks merged with a heap holding the run each next row comes
+// from. When the rows and the entries outgrow memory_budget the merged rows are written to
+// a temporary file as a run, and the run files are merged the same way at the end. Rows
+// with equal keys keep the order they came in.
+struct Sort {
+    struct Plan             base;
+    struct Plan             *child;
+    struct SizeTVec         *keys;          // Columns of the child's rows
+    struct SortTypeList     *sort_types;
+    size_t                  memory_budget;  // Bytes
+    uint64_t                column_count;   // Of the child's rows, set by the first row
+    struct ArenaAllocator   rows_arena;     // SortRows
+    struct SortEntry        *entries;
+    struct SortEntry        *scratch;       // Merge sort buffer for one chunk
+    size_t                  entry_count;
+    size_t                  entry_capacity;
+    unsigned char           *bytes;         // A row being written to a run
+    size_t                  byte_capacity;
+    struct SortRun          *runs;
+    size_t                  run_count;
+    size_t                  run_capacity;
+    size_t                  *heap;          // Runs by current row, the smallest first
+    size_t                  heap_count;
+    bool                    built;
+    bool                    started;        // The top run's current row has been handed out
+};
+
+uint64_t sort_key_prefix(struct Value *value, enum SortType sort_type);
+int sort_compare_rows(struct SizeTVec *keys, struct SortTypeList *sort_types, struct Value *a, struct Value *b);
+
+struct Plan *make_sort(struct Plan *plan, struct SizeTVec *keys, struct SortTypeList *sort_types, size_t memory_budget);
+bool sort_next(struct Pager *pager, struct Sort *sort, struct Row *row);
+bool sort_next_batch(struct Pager *pager, struct Sort *sort, struct ColumnBatch **batch);
+void sort_close(struct Sort *sort);
+
+#endif
@@ -8,9 +8,11 @@
 #include "../sql_utils.h"
 #include "../data_parsing/page_parsing.h"
 #include "../data_parsing/record_parsing.h"
-#include "../tree_walker.h"
+#include "../btree_cursor.h"
 #include "../comparisons.h"
 #include "plan.h"
+#include "column_batch.h"
+#include "filter.h"
 
 #define COLUMNS_IN_EXPR_HASH_MAP_MIN_SIZE 8
 
@@ -177,13 +179,638 @@ static struct IndexData *get_best_index(struct Pager *pager, struct SelectStatem
     // Select best index based on score
 }
 
+static bool is_literal(struct Expr *expr) {
+    return expr->type == EXPR_INTEGER || expr->type == EXPR_STRING;
+}
+
+static bool collect_column_range(struct IndexData *index, struct Column *index_column, struct KeyRange *range) {
+    // Gather every comparison between one index column and a literal into a range of keys
+    bool constrained = false;
+
+    key_range_init(range);
+
+    for (size_t i = 0; i < index->predicates->count; i++) {
+        struct ExprBinary *predicate = &index->predicates->data[i];
+        enum BinaryOp op = predicate->op;
+        struct Expr *column;
+        struct Value value;
+        struct Value upper;
+
+        if (op == BIN_BETWEEN) {
+            column = predicate->left;
+            if (column->type != EXPR_COLUMN || !is_literal(predicate->right) || !is_literal(predicate->upper)) {
+                continue;
+            }
+
+            value = get_predicate_value(&(struct ExprBinary){ .left = column, .right = predicate->right });
+            upper = get_predicate_value(&(struct ExprBinary){ .left = column, .right = predicate->upper });
+        } else {
+            bool column_on_left = predicate->left->type == EXPR_COLUMN;
+            column = column_on_left ? predicate->left : predicate->right;
+            struct Expr *literal = column_on_left ? predicate->right : predicate->left;
+
+            if (column->type != EXPR_COLUMN || !is_literal(literal)) {
+                continue;
+            }
+
+            value = get_predicate_value(predicate);
+            op = column_on_left ? op : mirror_binary_op(op);
+        }
+
+        if (!unterminated_string_equals(&column->column.name, &index_column->name)) {
+            continue;
+        }
+
+        constrained |= key_range_apply(range, op, &value, &upper);
+    }
+
+    return constrained;
+}
+
+static bool find_index_range(struct IndexData *index, struct IndexKeyRange *range) {
+    // Entries are ordered column by column, so equalities on the leading index columns
+    // form a seek prefix. The first column without an equality adds its range to the
+    // key and ends it, later columns cannot narrow the scan.
+    size_t key_columns = index->columns->count < INDEX_KEY_MAX_COLUMNS ? index->columns->count : INDEX_KEY_MAX_COLUMNS;
+
+    range->prefix_count = 0;
+    range->empty        = false;
+    key_range_init(&range->next);
+
+    for (size_t i = 0; i < key_columns; i++) {
+        struct KeyRange column_range;
+
+        if (!collect_column_range(index, &index->columns->data[i], &column_range)) {
+            break;
+        }
+
+        if (key_range_is_empty(&column_range)) {
+            range->empty = true;
+            return true;
+        }
+
+        if (!key_range_is_point(&column_range)) {
+            range->next = column_range;
+            break;
+        }
+
+        range->prefix[range->prefix_count++] = column_range.lower.value;
+    }
+
+    return range->prefix_count > 0 || range->next.lower.present || range->next.upper.present;
+}
+
+static bool index_range_is_selective(struct IndexKeyRange *range) {
+    // Without statistics, an equality on a leading column or a range closed at both ends is
+    // taken to match few entries. Their rowids are gathered and the rows fetched in one sweep
+    // in rowid order. A range open at one end may match most of the index, its rows are
+    // fetched in index order as the entries are read and nothing is held.
+    return range->prefix_count > 0 || (range->next.lower.present && range->next.upper.present);
+}
+
+static bool index_has_column(struct IndexData *index, struct UnterminatedString *name) {
+    for (size_t i = 0; i < index->columns->count; i++) {
+        if (unterminated_string_equals(&index->columns->data[i].name, name)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool expr_covered_by_index(struct Expr *expr, struct IndexData *index, struct UnterminatedString *rowid_alias) {
+    // True when every column expr reads is in the index, the rowid comes with every entry
+    switch (expr->type) {
+        case EXPR_INTEGER:
+        case EXPR_STRING:
+            return true;
+
+        case EXPR_COLUMN:
+            if (rowid_alias->start != NULL && unterminated_string_equals(&expr->column.name, rowid_alias)) {
+                return true;
+            }
+            return index_has_column(index, &expr->column.name);
+
+        case EXPR_BINARY:
+            return expr_covered_by_index(expr->binary.left, index, rowid_alias)
+                && expr_covered_by_index(expr->binary.right, index, rowid_alias)
+                && (expr->binary.upper == NULL || expr_covered_by_index(expr->binary.upper, index, rowid_alias));
+
+        case EXPR_UNARY:
+            return expr_covered_by_index(expr->unary.right, index, rowid_alias);
+
+        case EXPR_FUNCTION:
+            for (size_t i = 0; i < expr->function.args->count; i++) {
+                struct Expr *arg = &expr->function.args->data[i];
+
+                // count(*) does not read any column
+                if (arg->type != EXPR_STAR && !expr_covered_by_index(arg, index, rowid_alias)) {
+                    return false;
+                }
+            }
+            return true;
+
+        default:
+            // SELECT * reads every column
+            return false;
+    }
+}
+
+static bool expr_list_covered_by_index(struct ExprList *expr_list, struct IndexData *index, struct UnterminatedString *rowid_alias) {
+    if (expr_list == NULL) {
+        return true;
+    }
+
+    for (size_t i = 0; i < expr_list->count; i++) {
+        if (!expr_covered_by_index(&expr_list->data[i], index, rowid_alias)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool index_covers_query(struct IndexData *index, struct SelectStatement *stmt, struct UnterminatedString *rowid_alias) {
+    struct ExprList *lists[] = { stmt->select_list, stmt->where_list, stmt->group_by_list, stmt->order_by_list };
+
+    for (size_t i = 0; i < sizeof(lists) / sizeof(lists[0]); i++) {
+        if (!expr_list_covered_by_index(lists[i], index, rowid_alias)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void map_index_columns(struct TableScan *table_scan, struct Resolver *resolver) {
+    // Where each index column goes in a table row, so an entry can be laid out as one
+    struct Columns *index_columns = table_scan->index->columns;
+
+    table_scan->table_column_count      = resolver_table_column_count(resolver);
+    table_scan->index_to_table_column   = malloc(index_columns->count * sizeof(size_t));
+    table_scan->index_only_values       = malloc(table_scan->table_column_count * sizeof(struct Value));
+
+    if (!table_scan->index_to_table_column || !table_scan->index_only_values) {
+        fprintf(stderr, "map_index_columns: malloc failed\n");
+        exit(1);
+    }
+
+    for (size_t i = 0; i < index_columns->count; i++) {
+        if (!resolver_get_table_column_index(resolver, &index_columns->data[i].name, &table_scan->index_to_table_column[i])) {
+            fprintf(stderr, "map_index_columns: index column %.*s is not in the table.\n", (int)index_columns->data[i].name.len, index_columns->data[i].name.start);
+            exit(1);
+        }
+    }
+
+    // Columns outside the index are never read, NULL keeps the row well formed
+    for (size_t i = 0; i < table_scan->table_column_count; i++) {
+        table_scan->index_only_values[i] = (struct Value){ .type = VALUE_NULL };
+    }
+}
+
+static bool collect_rowid_bounds(struct SelectStatement *stmt, struct UnterminatedString *rowid_alias, int64_t *rowid_min, int64_t *rowid_max, bool *exact) {
+    // Narrow [rowid_min, rowid_max] with every comparison between the rowid alias and an
+    // integer. Returns false when no predicate constrains the rowid. exact is set when every
+    // predicate went into the bounds, so every row in them passes the WHERE.
+    bool constrained = false;
+    size_t used = 0;
+    *rowid_min = INT64_MIN;
+    *rowid_max = INT64_MAX;
+    *exact     = false;
+
+    if (stmt->where_list == NULL || rowid_alias->start == NULL) {
+        return false;
+    }
+
+    for (size_t i = 0; i < stmt->where_list->count; i++) {
+        struct Expr *expr = &stmt->where_list->data[i];
+        if (expr->type != EXPR_BINARY) {
+            continue;
+        }
+
+        struct ExprBinary *predicate = &expr->binary;
+        bool column_on_left = predicate->left->type == EXPR_COLUMN;
+        struct Expr *column = column_on_left ? predicate->left : predicate->right;
+        struct Expr *literal = column_on_left ? predicate->right : predicate->left;
+
+        if (column->type != EXPR_COLUMN || literal->type != EXPR_INTEGER) {
+            continue;
+        }
+
+        if (!unterminated_string_equals(&column->column.name, rowid_alias)) {
+            continue;
+        }
+
+        // Write every predicate as rowid <op> value
+        int64_t value = literal->integer.value;
+        int64_t upper = 0;
+        enum BinaryOp op = predicate->op;
+
+        if (op == BIN_BETWEEN) {
+            if (!column_on_left || predicate->upper->type != EXPR_INTEGER) {
+                continue;
+            }
+            upper = predicate->upper->integer.value;
+        } else if (!column_on_left) {
+            op = mirror_binary_op(op);
+        }
+
+        switch (op) {
+            case BIN_EQUAL:
+                if (value > *rowid_min) *rowid_min = value;
+                if (value < *rowid_max) *rowid_max = value;
+                break;
+
+            case BIN_LESS:
+                if (value == INT64_MIN) {
+                    *rowid_max = INT64_MIN;
+                    *rowid_min = INT64_MAX;
+                } else if (value - 1 < *rowid_max) {
+                    *rowid_max = value - 1;
+                }
+                break;
+
+            case BIN_GREATER:
+                if (value == INT64_MAX) {
+                    *rowid_max = INT64_MIN;
+                    *rowid_min = INT64_MAX;
+                } else if (value + 1 > *rowid_min) {
+                    *rowid_min = value + 1;
+                }
+                break;
+
+            case BIN_LESS_EQUAL:
+                if (value < *rowid_max) *rowid_max = value;
+                break;
+
+            case BIN_GREATER_EQUAL:
+                if (value > *rowid_min) *rowid_min = value;
+                break;
+
+            case BIN_BETWEEN:
+                if (value > *rowid_min) *rowid_min = value;
+                if (upper < *rowid_max) *rowid_max = upper;
+                break;
+
+            default:
+                continue;
+        }
+
+        constrained = true;
+        used++;
+    }
+
+    *exact = constrained && used == stmt->where_list->count;
+    return constrained;
+}
+
+static bool produce_full_scan_row(struct TableScan *table_scan, bool started) {
+    struct BTreeCursor *table_cursor = &table_scan->table_cursor;
+    return started ? btree_cursor_next(table_cursor) : btree_cursor_first(table_cursor);
+}
+
+static bool produce_rowid_range_row(struct TableScan *table_scan, bool started) {
+    // One seek finds the start of the range, after that the cursor walks the leaves in
+    // order and the scan ends at the first rowid past the range
+    struct BTreeCursor *table_cursor = &table_scan->table_cursor;
+    bool found;
+
+    if (started) {
+        found = btree_cursor_next(table_cursor);
+    } else if (table_scan->rowid_min > 0) {
+        found = btree_cursor_seek_rowid(table_cursor, (uint64_t)table_scan->rowid_min);
+    } else {
+        found = btree_cursor_first(table_cursor);
+    }
+
+    return found && (int64_t)btree_cursor_rowid(table_cursor) <= table_scan->rowid_max;
+}
+
+static bool next_index_entry(struct TableScan *table_scan, bool started, struct Row *index_row) {
+    // Index entries are visited in key order from the start of the range. The first entry
+    // past the end of the range ends the scan.
+    struct BTreeCursor *index_cursor = &table_scan->index_cursor;
+    struct IndexKeyRange *range = &table_scan->index_range;
+    int position = 1;
+    bool found;
+
+    if (started) {
+        found = btree_cursor_next(index_cursor);
+    } else {
+        struct Value key[INDEX_KEY_MAX_COLUMNS];
+        uint8_t key_count = index_key_range_start(range, key);
+        found = btree_cursor_seek_key(index_cursor, key, key_count);
+    }
+
+    while (found) {
+        btree_cursor_read_key(index_cursor, index_row);
+        position = index_key_range_position(range, index_row->values);
+
+        if (position >= 0) {
+            break;
+        }
+
+        // Keys equal to an exclusive lower bound, or NULLs before an open lower end
+        found = btree_cursor_next(index_cursor);
+    }
+
+    return found && position == 0;
+}
+
+static bool produce_index_row(struct TableScan *table_scan, bool started) {
+    // Each index entry names a row to fetch from the table
+    struct BTreeCursor *table_cursor = &table_scan->table_cursor;
+    struct Row index_row;
+
+    if (!next_index_entry(table_scan, started, &index_row)) {
+        return false;
+    }
+
+    if (!btree_cursor_seek_rowid(table_cursor, index_row.rowid) || btree_cursor_rowid(table_cursor) != index_row.rowid) {
+        fprintf(stderr, "produce_index_row: rowid %llu from the index is not in the table.\n", (unsigned long long)index_row.rowid);
+        exit(1);
+    }
+
+    return true;
+}
+
+static int compare_rowids(const void *a, const void *b) {
+    uint64_t left = *(const uint64_t *)a;
+    uint64_t right = *(const uint64_t *)b;
+    return (left > right) - (left < right);
+}
+
+static void collect_index_rowids(struct TableScan *table_scan) {
+    // Entries under an equality on every index column come out in rowid order already,
+    // anything wider is sorted once here
+    struct RowidVec *rowids = &table_scan->rowids;
+    struct Row index_row;
+    bool sorted = true;
+
+    for (bool found = next_index_entry(table_scan, false, &index_row); found; found = next_index_entry(table_scan, true, &index_row)) {
+        if (rowids->count > 0 && rowids->data[rowids->count - 1] > index_row.rowid) {
+            sorted = false;
+        }
+
+        vector_rowid_vec_push(rowids, index_row.rowid);
+    }
+
+    if (!sorted) {
+        qsort(rowids->data, rowids->count, sizeof(uint64_t), compare_rowids);
+    }
+
+    // Every entry has been read, the index pages can be unpinned
+    btree_cursor_close(&table_scan->index_cursor);
+}
+
+static bool produce_index_rowids_row(struct TableScan *table_scan, bool started) {
+    // The qualifying rowids are gathered from the index first, then the table is swept once
+    // in rowid order. Every leaf holding a match is searched once and the leaves are visited
+    // in file order, instead of one random root to leaf walk per index entry.
+    struct BTreeCursor *table_cursor = &table_scan->table_cursor;
+    struct RowidVec *rowids = &table_scan->rowids;
+
+    if (!started) {
+        collect_index_rowids(table_scan);
+    }
+
+    if (table_scan->rowid_position == rowids->count) {
+        return false;
+    }
+
+    uint64_t rowid = rowids->data[table_scan->rowid_position++];
+
+    if (!btree_cursor_advance_to_rowid(table_cursor, rowid) || btree_cursor_rowid(table_cursor) != rowid) {
+        fprintf(stderr, "produce_index_rowids_row: rowid %llu from the index is not in the table.\n", (unsigned long long)rowid);
+        exit(1);
+    }
+
+    return true;
+}
+
+static void index_entry_row(struct TableScan *table_scan, struct Row *index_row, struct Row *row) {
+    // Lays the entry out like a table row, columns outside the index stay NULL. The values
+    // borrow the index cursor's key buffer, which stays put until the next entry is read.
+    size_t index_columns = table_scan->index->columns->count;
+    for (size_t i = 0; i < index_columns; i++) {
+        table_scan->index_only_values[table_scan->index_to_table_column[i]] = index_row->values[i];
+    }
+
+    // Refreshed for every entry, unlike in rows read from the table the slot is reused
+    if (table_scan->first_col_is_row_id) {
+        table_scan->index_only_values[0] = (struct Value){ .type = VALUE_INT, .int_value = { .value = (int64_t)index_row->rowid } };
+    }
+
+    row->values         = table_scan->index_only_values;
+    row->column_count   = table_scan->table_column_count;
+    row->rowid          = index_row->rowid;
+}
+
+static bool produce_index_only_row(struct TableScan *table_scan, bool started, struct Row *row) {
+    // The entry holds every column the query reads, so the row is built straight from it
+    // and the table b-tree is never touched
+    struct Row index_row;
+
+    if (!next_index_entry(table_scan, started, &index_row)) {
+        return false;
+    }
+
+    index_entry_row(table_scan, &index_row, row);
+    return true;
+}
+
+static bool advance_scan(struct TableScan *table_scan, struct Row *row) {
+    // Moves the table cursor onto the next row, a SCAN_INDEX_ONLY scan builds the row itself instead
+    if (table_scan->done) {
+        return false;
+    }
+
+    bool started = table_scan->started;
+    bool found = false;
+    table_scan->started = true;
+
+    switch (table_scan->mode) {
+        case SCAN_FULL:
+            found = produce_full_scan_row(table_scan, started);
+            break;
+
+        case SCAN_ROWID_RANGE:
+            found = produce_rowid_range_row(table_scan, started);
+            break;
+
+        case SCAN_INDEX:
+            found = produce_index_row(table_scan, started);
+            break;
+
+        case SCAN_INDEX_ROWIDS:
+            found = produce_index_rowids_row(table_scan, started);
+            break;
+
+        case SCAN_INDEX_ONLY:
+            found = produce_index_only_row(table_scan, started, row);
+            break;
+    }
+
+    if (!found) {
+        table_scan->done = true;
+    }
+
+    return found;
+}
+
+static bool produce_row(struct TableScan *table_scan, struct Row *row) {
+    // The row is decoded into the scan's row buffer and the cursors only move over pinned
+    // pages, so producing a row allocates nothing once the buffer has grown to fit
+    if (!advance_scan(table_scan, row)) {
+        return false;
+    }
+
+    if (table_scan->mode != SCAN_INDEX_ONLY) {
+        btree_cursor_read_row(&table_scan->table_cursor, &table_scan->row_buffer, &table_scan->column_mask, row);
+    }
+
+    // The record stores NULL for an INTEGER PRIMARY KEY, its value is the rowid
+    if (table_scan->first_col_is_row_id && row->column_count > 0 && row->values[0].type == VALUE_NULL) {
+        row->values[0] = (struct Value){ .type = VALUE_INT, .int_value = { .value = (int64_t)row->rowid } };
+    }
+
+    return true;
+}
+
+static void skip_index_entries(struct TableScan *table_scan, uint64_t count, struct ExprList *predicates) {
+    // Only the index is read, the table rows the skipped entries name are never fetched.
+    // Entries are tested against the predicates on their own columns, only those that pass
+    // count. The index cursor rests on the last entry skipped.
+    struct Row index_row;
+    struct Row row;
+    bool started = false;
+
+    while (count > 0) {
+        if (!next_index_entry(table_scan, started, &index_row)) {
+            table_scan->done = true;
+            break;
+        }
+        started = true;
+
+        if (predicates != NULL) {
+            index_entry_row(table_scan, &index_row, &row);
+            if (!filter_row_matches(predicates, &row)) {
+                continue;
+            }
+        }
+
+        count--;
+    }
+
+    table_scan->started = true;
+}
+
+bool table_scan_skip(struct TableScan *table_scan, uint64_t count, struct ExprList *predicates) {
+    // Drops the first count rows that pass predicates, which is the WHERE a filter above
+    // applies or NULL. Scans in rowid order move the cursor over whole leaves at a time and
+    // the rows are never decoded, when every row they produce passes. Index scans in index
+    // order step over the entries, when the predicates only read index columns. Any other
+    // scan returns false and leaves the rows to be dropped as they come.
+    if (table_scan->started || count == 0) {
+        return false;
+    }
+
+    if (table_scan->mode == SCAN_INDEX || table_scan->mode == SCAN_INDEX_ONLY) {
+        if (predicates != NULL && !table_scan->where_in_index) {
+            return false;
+        }
+
+        skip_index_entries(table_scan, count, predicates);
+        return true;
+    }
+
+    if (table_scan->mode == SCAN_INDEX_ROWIDS || (predicates != NULL && !table_scan->where_exact)) {
+        return false;
+    }
+
+    // The first row is found the way the scan finds it, the cursor then rests on the last row skipped
+    struct Row row;
+    if (!advance_scan(table_scan, &row)) {
+        return true;
+    }
+
+    struct BTreeCursor *table_cursor = &table_scan->table_cursor;
+    bool found = btree_cursor_skip(table_cursor, count - 1);
+
+    if (!found || (table_scan->mode == SCAN_ROWID_RANGE && (int64_t)btree_cursor_rowid(table_cursor) > table_scan->rowid_max)) {
+        table_scan->done = true;
+    }
+
+    return true;
+}
+
+void table_scan_limit_rows(struct TableScan *table_scan, uint64_t rows) {
+    // A LIMIT above wants about rows rows and closes the scan once it has them. Batches
+    // start that small and double from there, and an index scan fetches rows in index order
+    // as the entries are read instead of gathering every rowid first. A scan that is closed
+    // early has read little more than it handed out.
+    if (table_scan->mode == SCAN_INDEX_ROWIDS && !table_scan->started) {
+        table_scan->mode = SCAN_INDEX;
+    }
+
+    if (rows < table_scan->batch_rows) {
+        table_scan->batch_rows = rows > 0 ? (uint32_t)rows : 1;
+    }
+}
+
+void table_scan_close(struct TableScan *table_scan) {
+    // No more rows are wanted, the pages on the cursor paths are unpinned
+    btree_cursor_close(&table_scan->table_cursor);
+    if (table_scan->index != NULL) {
+        btree_cursor_close(&table_scan->index_cursor);
+    }
+
+    table_scan->done = true;
+}
+
 bool table_scan_next(struct TableScan *table_scan, struct Row *row) {
     // Decode all columns of row into struct Row
     // fprintf(stderr, "table_scan_next\n");
-    return produce_row(table_scan->walker, row);
+    return produce_row(table_scan, row);
+}
+
+bool table_scan_next_batch(struct TableScan *table_scan, struct ColumnBatch **batch) {
+    // Table rows are decoded straight into the batch columns, only the columns the query reads
+    if (table_scan->base.batch == NULL) {
+        table_scan->base.batch = column_batch_new((uint32_t)table_scan->column_mask.column_count);
+    }
+
+    struct ColumnBatch *output = table_scan->base.batch;
+    struct Row row;
+    column_batch_reset(output);
+
+    while (output->row_count < table_scan->batch_rows && advance_scan(table_scan, &row)) {
+        if (table_scan->mode == SCAN_INDEX_ONLY) {
+            column_batch_append_row(output, &row, &table_scan->column_mask);
+            continue;
+        }
+
+        struct BTreeCursor *cursor = &table_scan->table_cursor;
+        column_batch_append_cell(output, cursor->pager, btree_cursor_page_data(cursor), &cursor->cell, &table_scan->row_buffer, &table_scan->column_mask);
+
+        // The record stores NULL for an INTEGER PRIMARY KEY, its value is the rowid
+        uint16_t position = (uint16_t)(output->row_count - 1);
+        struct ColumnVector *first = output->column_count > 0 ? output->columns[0] : NULL;
+        if (table_scan->first_col_is_row_id && first != NULL && first->types[position] == VALUE_NULL) {
+            first->types[position]  = VALUE_INT;
+            first->ints[position]   = (int64_t)output->rowids[position];
+        }
+    }
+
+    if (table_scan->batch_rows < BATCH_SIZE) {
+        table_scan->batch_rows = table_scan->batch_rows * 2 < BATCH_SIZE ? table_scan->batch_rows * 2 : BATCH_SIZE;
+    }
+
+    *batch = output;
+    return output->row_count > 0;
 }
 
-struct Plan *make_table_scan(struct Pager *pager, struct SelectStatement *stmt) {
+struct Plan *make_table_scan(struct Pager *pager, struct SelectStatement *stmt, struct Resolver *resolver) {
     struct TableScan *table_scan = malloc(sizeof(struct TableScan));
     if (!table_scan) {
         fprintf(stderr, "make_table_scan: *table_scan malloc failed\n");
@@ -194,20 +821,63 @@ struct Plan *make_table_scan(struct Pager *pager, struct SelectStatement *stmt)
     
     struct PageHeader page_header;
     read_page_header(pager, &page_header, schema_record->body.root_page);
-    
+
+    memset(table_scan, 0, sizeof *table_scan);
+    table_scan->base.type           = PLAN_TABLE_SCAN;
+    table_scan->row_cursor          = 0;
+    table_scan->root_page           = schema_record->body.root_page;
+    table_scan->first_col_is_row_id = resolver->first_col_is_rowid;
+    table_scan->table_name          = stmt->from_table;
+    table_scan->mode                = SCAN_FULL;
+    table_scan->index               = NULL;
+    table_scan->started             = false;
+    table_scan->done                = false;
+    table_scan->batch_rows          = BATCH_SIZE;
+
+    btree_cursor_init(&table_scan->table_cursor, pager, table_scan->root_page);
+    row_buffer_init(&table_scan->row_buffer);
+    resolver_column_mask(resolver, stmt, &table_scan->column_mask);
+
+    // A seek on the table itself beats going through an index
+    if (collect_rowid_bounds(stmt, &resolver->rowid_alias, &table_scan->rowid_min, &table_scan->rowid_max, &table_scan->where_exact)) {
+        fprintf(stderr, "Rowid range scan: [%lld, %lld]\n", (long long)table_scan->rowid_min, (long long)table_scan->rowid_max);
+        table_scan->mode                    = SCAN_ROWID_RANGE;
+        table_scan->done                    = table_scan->rowid_min > table_scan->rowid_max;
+        table_scan->table_cursor.readahead  = table_scan->rowid_min != table_scan->rowid_max;
+        return &table_scan->base;
+    }
 
     // Find any indexes for our table
     // Check if any predicate matches that index
     struct IndexData *index = get_best_index(pager, stmt);
 
-    memset(table_scan, 0, sizeof *table_scan);
-    table_scan->base.type       = PLAN_TABLE_SCAN;
-    table_scan->row_cursor      = 0;
-    table_scan->root_page       = schema_record->body.root_page;
-    table_scan->table_name      = stmt->from_table;
-    table_scan->index           = index;
+    if (index != NULL && find_index_range(index, &table_scan->index_range)) {
+        table_scan->mode    = index_range_is_selective(&table_scan->index_range) ? SCAN_INDEX_ROWIDS : SCAN_INDEX;
+        table_scan->index   = index;
+        table_scan->done    = table_scan->index_range.empty;
+        btree_cursor_init(&table_scan->index_cursor, pager, index->root_page);
+        vector_rowid_vec_init(&table_scan->rowids);
 
-    table_scan->walker = new_tree_walker(pager, table_scan->root_page, table_scan->index);
+        table_scan->where_in_index = expr_list_covered_by_index(stmt->where_list, index, &resolver->rowid_alias);
+        if (table_scan->where_in_index) {
+            map_index_columns(table_scan, resolver);
+        }
 
+        if (index_covers_query(index, stmt, &resolver->rowid_alias)) {
+            fprintf(stderr, "Index covers the query, skipping the table.\n");
+            table_scan->mode = SCAN_INDEX_ONLY;
+        }
+
+        return &table_scan->base;
+    }
+
+    if (index != NULL) {
+        // Without a comparison on the leading column the index cannot narrow the scan,
+        // the filter above still applies every predicate
+        fprintf(stderr, "No comparison on the first index column, using a full scan.\n");
+    }
+
+    // Only a full scan visits the table in rowid order
+    table_scan->table_cursor.readahead = true;
     return &table_scan->base;
-}
\ No newline at end of file
+}
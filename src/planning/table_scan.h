@@ -2,6 +2,19 @@
 #define sql_table_scan
 
 #include "plan.h"
+#include "../btree_cursor.h"
+#include "../comparisons.h"
+#include "resolver.h"
+
+DEFINE_VECTOR(uint64_t, RowidVec, rowid_vec)
+
+enum TableScanMode {
+    SCAN_FULL,          // Every row in rowid order
+    SCAN_ROWID_RANGE,   // Seek to rowid_min and stop after rowid_max
+    SCAN_INDEX,         // Rows named by the index entries in index_range, fetched one at a time in index order
+    SCAN_INDEX_ROWIDS,  // Rows named by the index entries in index_range, collected and fetched in rowid order
+    SCAN_INDEX_ONLY     // Like SCAN_INDEX, but the index holds every column the query uses so rows are built from the entries
+};
 
 struct TableScan {
     struct Plan         base;
@@ -10,11 +23,32 @@ struct TableScan {
     bool                first_col_is_row_id;
     char                *table_name;
     struct Columns      *columns;
-    struct TreeWalker   *walker;
+    enum TableScanMode  mode;
+    int64_t             rowid_min;      // Inclusive bounds of a SCAN_ROWID_RANGE
+    int64_t             rowid_max;
     struct IndexData    *index;
+    struct IndexKeyRange index_range;   // Equalities on the leading index columns and a range on the next
+    bool                where_exact;    // SCAN_ROWID_RANGE: every row in the range passes the WHERE
+    bool                where_in_index; // Every column the WHERE reads is in the index, entries can be tested on their own
+    bool                started;
+    bool                done;
+    uint32_t            batch_rows;     // Rows per batch, fewer than BATCH_SIZE while a LIMIT above wants few
+    struct BTreeCursor  table_cursor;
+    struct BTreeCursor  index_cursor;
+    struct RowBuffer    row_buffer;     // Rows handed out by the scan live here until the next row
+    struct ColumnMask   column_mask;    // Columns the query reads, the rest of each row is left NULL
+    size_t              *index_to_table_column; // SCAN_INDEX_ONLY or where_in_index: position in the table row of each index column
+    struct Value        *index_only_values;     // SCAN_INDEX_ONLY or where_in_index: table row built from an index entry, unused columns are NULL
+    size_t              table_column_count;
+    struct RowidVec     rowids;         // SCAN_INDEX_ROWIDS: sorted rowids from the index
+    size_t              rowid_position; // SCAN_INDEX_ROWIDS: next rowid to fetch
 };
 
 bool table_scan_next(struct TableScan *table_scan, struct Row *row);
-struct Plan *make_table_scan(struct Pager *pager, struct SelectStatement *stmt);
+bool table_scan_next_batch(struct TableScan *table_scan, struct ColumnBatch **batch);
+bool table_scan_skip(struct TableScan *table_scan, uint64_t count, struct ExprList *predicates);
+void table_scan_limit_rows(struct TableScan *table_scan, uint64_t rows);
+void table_scan_close(struct TableScan *table_scan);
+struct Plan *make_table_scan(struct Pager *pager, struct SelectStatement *stmt, struct Resolver *resolver);
 
 #endif
\ No newline at end of file
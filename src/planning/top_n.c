@@ -0,0 +1,322 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "top_n.h"
+#include "sort.h"
+#include "column_batch.h"
+#include "filter_kernels.h"
+
+#define INITIAL_SLOT_CAPACITY (64)
+
+struct Plan *make_top_n(struct Plan *plan, struct SizeTVec *keys, struct SortTypeList *sort_types, uint64_t limit, uint64_t offset) {
+    struct TopN *top_n = malloc(sizeof(struct TopN));
+    if (!top_n) {
+        fprintf(stderr, "make_top_n: *top_n malloc failed\n");
+        exit(1);
+    }
+
+    if (keys->count == 0 || keys->count != sort_types->count) {
+        fprintf(stderr, "make_top_n: %zu keys and %zu sort types\n", keys->count, sort_types->count);
+        exit(1);
+    }
+
+    memset(top_n, 0, sizeof *top_n);
+    top_n->base.type    = PLAN_TOP_N;
+    top_n->child        = plan;
+    top_n->keys         = keys;
+    top_n->sort_types   = sort_types;
+    top_n->offset       = offset;
+    top_n->capacity     = limit > UINT64_MAX - offset ? UINT64_MAX : limit + offset;
+
+    return &top_n->base;
+}
+
+static int compare_slots(struct TopN *top_n, struct TopNSlot *a, struct TopNSlot *b) {
+    if (a->prefix != b->prefix) {
+        return a->prefix < b->prefix ? -1 : 1;
+    }
+
+    int cmp = sort_compare_rows(top_n->keys, top_n->sort_types, a->values, b->values);
+    if (cmp != 0) {
+        return cmp;
+    }
+
+    return (a->sequence > b->sequence) - (a->sequence < b->sequence);
+}
+
+static void swap_slots(struct TopNSlot *a, struct TopNSlot *b) {
+    struct TopNSlot swap = *a;
+    *a = *b;
+    *b = swap;
+}
+
+static void sift_up(struct TopN *top_n, uint64_t i) {
+    // The row that sorts last is on top
+    while (i > 0) {
+        uint64_t parent = (i - 1) / 2;
+        if (compare_slots(top_n, &top_n->slots[parent], &top_n->slots[i]) >= 0) {
+            return;
+        }
+
+        swap_slots(&top_n->slots[parent], &top_n->slots[i]);
+        i = parent;
+    }
+}
+
+static void sift_down(struct TopN *top_n, uint64_t i, uint64_t count) {
+    struct TopNSlot *slots = top_n->slots;
+
+    while (true) {
+        uint64_t largest    = i;
+        uint64_t left       = 2 * i + 1;
+        uint64_t right      = left + 1;
+
+        if (left < count && compare_slots(top_n, &slots[left], &slots[largest]) > 0) {
+            largest = left;
+        }
+        if (right < count && compare_slots(top_n, &slots[right], &slots[largest]) > 0) {
+            largest = right;
+        }
+        if (largest == i) {
+            return;
+        }
+
+        swap_slots(&slots[i], &slots[largest]);
+        i = largest;
+    }
+}
+
+static struct TopNSlot *new_slot(struct TopN *top_n) {
+    // The heap grows as rows come in, a LIMIT larger than the table costs no more than the table
+    if (top_n->slot_count == top_n->slot_capacity) {
+        uint64_t capacity = top_n->slot_capacity > 0 ? top_n->slot_capacity * 2 : INITIAL_SLOT_CAPACITY;
+        if (capacity > top_n->capacity) {
+            capacity = top_n->capacity;
+        }
+
+        top_n->slots = realloc(top_n->slots, capacity * sizeof(struct TopNSlot));
+        if (!top_n->slots) {
+            fprintf(stderr, "new_slot: slots realloc failed\n");
+            exit(1);
+        }
+        top_n->slot_capacity = capacity;
+    }
+
+    struct TopNSlot *slot = &top_n->slots[top_n->slot_count++];
+    memset(slot, 0, sizeof *slot);
+
+    slot->values = malloc(top_n->column_count * sizeof(struct Value));
+    if (!slot->values) {
+        fprintf(stderr, "new_slot: values malloc failed\n");
+        exit(1);
+    }
+
+    return slot;
+}
+
+static void slot_set(struct TopN *top_n, struct TopNSlot *slot, struct Row *row, uint64_t prefix, uint64_t sequence) {
+    size_t text_size = 0;
+    for (uint64_t i = 0; i < top_n->column_count; i++) {
+        if (row->values[i].type == VALUE_TEXT) {
+            text_size += row->values[i].text_value.text.len;
+        }
+    }
+
+    if (text_size > slot->text_capacity) {
+        size_t capacity = slot->text_capacity * 2 > text_size ? slot->text_capacity * 2 : text_size;
+
+        slot->text = realloc(slot->text, capacity);
+        if (!slot->text) {
+            fprintf(stderr, "slot_set: text realloc failed\n");
+            exit(1);
+        }
+        slot->text_capacity = capacity;
+    }
+
+    char *text = slot->text;
+    for (uint64_t i = 0; i < top_n->column_count; i++) {
+        struct Value *value = &slot->values[i];
+        *value = row->values[i];
+
+        if (value->type == VALUE_TEXT && value->text_value.text.len > 0) {
+            memcpy(text, value->text_value.text.start, value->text_value.text.len);
+            value->text_value.text.start = text;
+            text += value->text_value.text.len;
+        }
+    }
+
+    slot->rowid     = row->rowid;
+    slot->prefix    = prefix;
+    slot->sequence  = sequence;
+}
+
+static void set_column_count(struct TopN *top_n, struct Row *row) {
+    // Every key has to be a column, rows shorter than the first are padded with NULLs
+    uint64_t column_count = row->column_count;
+
+    for (size_t i = 0; i < top_n->keys->count; i++) {
+        if (top_n->keys->data[i] >= column_count) {
+            column_count = top_n->keys->data[i] + 1;
+        }
+    }
+
+    top_n->column_count = column_count;
+    top_n->padded       = malloc(column_count * sizeof(struct Value));
+    if (!top_n->padded) {
+        fprintf(stderr, "set_column_count: padded malloc failed\n");
+        exit(1);
+    }
+}
+
+static void offer_row(struct TopN *top_n, struct Row *row) {
+    if (top_n->column_count == 0) {
+        set_column_count(top_n, row);
+    }
+
+    struct Row padded_row;
+    if (row->column_count < top_n->column_count) {
+        for (uint64_t i = 0; i < top_n->column_count; i++) {
+            top_n->padded[i] = i < row->column_count ? row->values[i] : (struct Value){ .type = VALUE_NULL };
+        }
+
+        padded_row = (struct Row){ .rowid = row->rowid, .column_count = top_n->column_count, .values = top_n->padded };
+        row = &padded_row;
+    }
+
+    uint64_t prefix = sort_key_prefix(&row->values[top_n->keys->data[0]], top_n->sort_types->data[0]);
+    uint64_t sequence = top_n->sequence++;
+
+    if (top_n->slot_count < top_n->capacity) {
+        slot_set(top_n, new_slot(top_n), row, prefix, sequence);
+        sift_up(top_n, top_n->slot_count - 1);
+        return;
+    }
+
+    // Full, only a row that sorts before the top gets in and takes the top's slot. A row
+    // with the same keys as the top came after it, so it sorts after it.
+    struct TopNSlot *top = &top_n->slots[0];
+
+    if (prefix > top->prefix) {
+        return;
+    }
+
+    if (prefix == top->prefix && sort_compare_rows(top_n->keys, top_n->sort_types, row->values, top->values) >= 0) {
+        return;
+    }
+
+    slot_set(top_n, top, row, prefix, sequence);
+    sift_down(top_n, 0, top_n->slot_count);
+}
+
+static void cut_past_top(struct TopN *top_n, struct ColumnBatch *batch) {
+    // With the heap full, a row whose first key is an integer past the top's cannot get in.
+    // Those leave the selection a batch at a time through the filter kernels, every other
+    // row is left to offer_row.
+    if (top_n->slot_count == 0 || top_n->slot_count < top_n->capacity) {
+        return;
+    }
+
+    size_t column = top_n->keys->data[0];
+    struct Value *threshold = &top_n->slots[0].values[column];
+
+    if (threshold->type != VALUE_INT || column >= batch->column_count) {
+        return;
+    }
+
+    const struct FilterKernels *kernels = filter_kernels();
+    struct ColumnVector *vector = batch->columns[column];
+    enum BinaryOp past = top_n->sort_types->data[0] == SORT_DESC ? BIN_LESS : BIN_GREATER;
+    uint64_t keep[BITMAP_WORDS];
+    uint64_t bitmap[BITMAP_WORDS];
+
+    kernels->match_types(vector->types, batch->row_count, VALUE_INT, keep);
+    kernels->compare_ints(vector->ints, batch->row_count, past, threshold->int_value.value, bitmap);
+
+    for (int w = 0; w < BITMAP_WORDS; w++) {
+        keep[w] = ~(keep[w] & bitmap[w]);
+    }
+
+    batch->selected_count = bitmap_select(keep, batch->selection, batch->selected_count);
+}
+
+static void finish_building(struct TopN *top_n) {
+    // Heap sort, the row on top goes to the end each time, leaving the rows in sort order
+    for (uint64_t end = top_n->slot_count; end > 1; end--) {
+        swap_slots(&top_n->slots[0], &top_n->slots[end - 1]);
+        sift_down(top_n, 0, end - 1);
+    }
+
+    top_n->built        = true;
+    top_n->next_slot    = top_n->offset;
+}
+
+static bool next_kept_row(struct TopN *top_n, struct Row *row) {
+    if (top_n->next_slot >= top_n->slot_count) {
+        return false;
+    }
+
+    struct TopNSlot *slot = &top_n->slots[top_n->next_slot++];
+    row->rowid          = slot->rowid;
+    row->column_count   = top_n->column_count;
+    row->values         = slot->values;
+    return true;
+}
+
+bool top_n_next(struct Pager *pager, struct TopN *top_n, struct Row *row) {
+    // Consumes every row of the child before the first row comes out, none for LIMIT 0
+    if (!top_n->built) {
+        while (top_n->capacity > 0 && plan_next(pager, top_n->child, row)) {
+            offer_row(top_n, row);
+        }
+        finish_building(top_n);
+    }
+
+    return next_kept_row(top_n, row);
+}
+
+bool top_n_next_batch(struct Pager *pager, struct TopN *top_n, struct ColumnBatch **batch) {
+    if (!top_n->built) {
+        struct ColumnBatch *input;
+        struct Value *values = NULL;
+        uint32_t value_capacity = 0;
+
+        while (top_n->capacity > 0 && plan_next_batch(pager, top_n->child, &input)) {
+            cut_past_top(top_n, input);
+
+            if (input->column_count > value_capacity) {
+                values = realloc(values, input->column_count * sizeof(struct Value));
+                if (!values) {
+                    fprintf(stderr, "top_n_next_batch: values realloc failed\n");
+                    exit(1);
+                }
+                value_capacity = input->column_count;
+            }
+
+            for (uint32_t i = 0; i < input->selected_count; i++) {
+                struct Row row;
+                column_batch_get_row(input, input->selection[i], values, &row);
+                offer_row(top_n, &row);
+            }
+        }
+
+        free(values);
+        finish_building(top_n);
+    }
+
+    if (top_n->base.batch == NULL) {
+        top_n->base.batch = column_batch_new((uint32_t)top_n->column_count);
+    }
+
+    struct ColumnBatch *output = top_n->base.batch;
+    struct Row row;
+    column_batch_reset(output);
+
+    while (!column_batch_is_full(output) && next_kept_row(top_n, &row)) {
+        column_batch_append_row(output, &row, NULL);
+    }
+
+    *batch = output;
+    return output->row_count > 0;
+}
@@ -0,0 +1,43 @@
+#ifndef sql_top_n
+#define sql_top_n
+
+#include "plan.h"
+
+// A row kept by a TopN. Its text is copied into a buffer of its own, reused when the slot
+// takes another row.
+struct TopNSlot {
+    uint64_t        rowid;
+    uint64_t        prefix;         // sort_key_prefix of the first key
+    uint64_t        sequence;       // Position in the child's rows, orders rows with equal keys
+    struct Value    *values;
+    char            *text;
+    size_t          text_capacity;
+};
+
+// ORDER BY with a LIMIT. The first limit + offset rows in sort order are kept in a binary
+// heap with the last of them on top, a row that sorts after the top is dropped without
+// being copied. O(n log N) time and O(N) memory for N = limit + offset, where a sort would
+// hold every row. In batch execution, once the heap is full, integer keys past the top are
+// cut from the selection with the filter kernels before any row is looked at.
+struct TopN {
+    struct Plan         base;
+    struct Plan         *child;
+    struct SizeTVec     *keys;          // Columns of the child's rows
+    struct SortTypeList *sort_types;
+    uint64_t            offset;
+    uint64_t            capacity;       // limit + offset
+    uint64_t            column_count;   // Of the child's rows, set by the first row
+    struct TopNSlot     *slots;         // The heap, then the rows in order
+    uint64_t            slot_count;
+    uint64_t            slot_capacity;
+    struct Value        *padded;        // A row shorter than column_count, padded with NULLs
+    uint64_t            sequence;
+    bool                built;
+    uint64_t            next_slot;
+};
+
+struct Plan *make_top_n(struct Plan *plan, struct SizeTVec *keys, struct SortTypeList *sort_types, uint64_t limit, uint64_t offset);
+bool top_n_next(struct Pager *pager, struct TopN *top_n, struct Row *row);
+bool top_n_next_batch(struct Pager *pager, struct TopN *top_n, struct ColumnBatch **batch);
+
+#endif
@@ -0,0 +1,265 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pager.h"
+#include "replacement_policy.h"
+#include "utilities/page_table.h"
+
+// Slot lists
+
+static void slot_list_init(struct SlotList *list) {
+    list->head  = PAGE_SLOT_EMPTY;
+    list->tail  = PAGE_SLOT_EMPTY;
+    list->count = 0;
+}
+
+static void slot_list_unlink(struct PagePartition *partition, struct SlotList *list, uint32_t slot) {
+    struct Page *page = &partition->pages[slot];
+
+    if (page->lru_prev != PAGE_SLOT_EMPTY) {
+        partition->pages[page->lru_prev].lru_next = page->lru_next;
+    } else {
+        list->head = page->lru_next;
+    }
+
+    if (page->lru_next != PAGE_SLOT_EMPTY) {
+        partition->pages[page->lru_next].lru_prev = page->lru_prev;
+    } else {
+        list->tail = page->lru_prev;
+    }
+
+    page->lru_prev  = PAGE_SLOT_EMPTY;
+    page->lru_next  = PAGE_SLOT_EMPTY;
+    page->queue     = QUEUE_NONE;
+    list->count--;
+}
+
+static void slot_list_push_front(struct PagePartition *partition, struct SlotList *list, uint32_t slot, enum SlotQueue queue) {
+    struct Page *page = &partition->pages[slot];
+
+    page->lru_prev  = PAGE_SLOT_EMPTY;
+    page->lru_next  = list->head;
+    page->queue     = queue;
+
+    if (list->head != PAGE_SLOT_EMPTY) {
+        partition->pages[list->head].lru_prev = slot;
+    } else {
+        list->tail = slot;
+    }
+
+    list->head = slot;
+    list->count++;
+}
+
+static uint32_t slot_list_find_unpinned_from_tail(struct PagePartition *partition, struct SlotList *list) {
+    uint32_t slot = list->tail;
+    while (slot != PAGE_SLOT_EMPTY && atomic_load(&partition->pages[slot].pin_count) > 0) {
+        slot = partition->pages[slot].lru_prev;
+    }
+    return slot;
+}
+
+// LRU
+
+static void lru_on_hit(struct PagePartition *partition, uint32_t slot) {
+    struct ReplacementState *state = &partition->replacement;
+    slot_list_unlink(partition, &state->recent, slot);
+    slot_list_push_front(partition, &state->recent, slot, QUEUE_RECENT);
+}
+
+static void lru_on_insert(struct PagePartition *partition, uint32_t slot) {
+    slot_list_push_front(partition, &partition->replacement.recent, slot, QUEUE_RECENT);
+}
+
+static uint32_t lru_choose_victim(struct PagePartition *partition) {
+    struct ReplacementState *state = &partition->replacement;
+    uint32_t slot = slot_list_find_unpinned_from_tail(partition, &state->recent);
+
+    if (slot != PAGE_SLOT_EMPTY) {
+        slot_list_unlink(partition, &state->recent, slot);
+    }
+
+    return slot;
+}
+
+// CLOCK
+
+static void clock_on_hit(struct PagePartition *partition, uint32_t slot) {
+    partition->pages[slot].referenced = true;
+}
+
+static void clock_on_insert(struct PagePartition *partition, uint32_t slot) {
+    partition->pages[slot].referenced = true;
+}
+
+static uint32_t clock_choose_victim(struct PagePartition *partition) {
+    struct ReplacementState *state = &partition->replacement;
+
+    // Two full sweeps clear every reference bit, after that only pins can stop us
+    for (uint64_t i = 0; i < (uint64_t)partition->capacity * 2; i++) {
+        uint32_t slot = state->clock_hand;
+        struct Page *page = &partition->pages[slot];
+        state->clock_hand = (state->clock_hand + 1) % partition->capacity;
+
+        if (atomic_load(&page->pin_count) > 0) {
+            continue;
+        }
+
+        if (page->referenced) {
+            page->referenced = false;
+            continue;
+        }
+
+        return slot;
+    }
+
+    return PAGE_SLOT_EMPTY;
+}
+
+// 2Q
+
+static void ghost_push(struct ReplacementState *state, uint32_t page_number) {
+    if (state->ghost_count == state->ghost_capacity) {
+        // Forget the oldest ghost, unless that page has been remembered again since
+        uint32_t oldest = state->ghost_ring[state->ghost_head];
+        if (page_table_find(&state->ghost_table, oldest) == state->ghost_head) {
+            page_table_remove(&state->ghost_table, oldest);
+        }
+        state->ghost_head = (state->ghost_head + 1) % state->ghost_capacity;
+        state->ghost_count--;
+    }
+
+    uint32_t position = (state->ghost_head + state->ghost_count) % state->ghost_capacity;
+    state->ghost_ring[position] = page_number;
+    state->ghost_count++;
+    page_table_insert(&state->ghost_table, page_number, position);
+}
+
+static inline uint64_t policy_clock(struct ReplacementState *state) {
+    return state->stats.hits + state->stats.misses;
+}
+
+static void two_queue_on_hit(struct PagePartition *partition, uint32_t slot) {
+    struct ReplacementState *state = &partition->replacement;
+    struct Page *page = &partition->pages[slot];
+
+    if (page->queue == QUEUE_FREQUENT) {
+        slot_list_unlink(partition, &state->frequent, slot);
+        slot_list_push_front(partition, &state->frequent, slot, QUEUE_FREQUENT);
+        return;
+    }
+
+    // Hits in A1in shortly after the page was loaded are correlated references,
+    // e.g. reading every cell of a leaf page, and do not promote the page.
+    // A page still being asked for after the correlation period is reused.
+    if (policy_clock(state) - page->loaded_at > state->recent_target) {
+        slot_list_unlink(partition, &state->recent, slot);
+        slot_list_push_front(partition, &state->frequent, slot, QUEUE_FREQUENT);
+    }
+}
+
+static void two_queue_on_insert(struct PagePartition *partition, uint32_t slot) {
+    struct ReplacementState *state = &partition->replacement;
+    uint32_t page_number = partition->pages[slot].page_no;
+
+    partition->pages[slot].loaded_at = policy_clock(state);
+
+    if (page_table_remove(&state->ghost_table, page_number)) {
+        slot_list_push_front(partition, &state->frequent, slot, QUEUE_FREQUENT);
+    } else {
+        slot_list_push_front(partition, &state->recent, slot, QUEUE_RECENT);
+    }
+}
+
+static uint32_t two_queue_evict_recent(struct PagePartition *partition) {
+    struct ReplacementState *state = &partition->replacement;
+    uint32_t slot = slot_list_find_unpinned_from_tail(partition, &state->recent);
+
+    if (slot != PAGE_SLOT_EMPTY) {
+        slot_list_unlink(partition, &state->recent, slot);
+        ghost_push(state, partition->pages[slot].page_no);
+    }
+
+    return slot;
+}
+
+static uint32_t two_queue_choose_victim(struct PagePartition *partition) {
+    struct ReplacementState *state = &partition->replacement;
+    uint32_t slot = PAGE_SLOT_EMPTY;
+
+    // Scanned pages only ever reach A1in, so keeping it at its target size
+    // stops a scan from pushing the hot pages out of Am
+    if (state->recent.count > state->recent_target) {
+        slot = two_queue_evict_recent(partition);
+        if (slot != PAGE_SLOT_EMPTY) {
+            return slot;
+        }
+    }
+
+    slot = slot_list_find_unpinned_from_tail(partition, &state->frequent);
+    if (slot != PAGE_SLOT_EMPTY) {
+        slot_list_unlink(partition, &state->frequent, slot);
+        return slot;
+    }
+
+    return two_queue_evict_recent(partition);
+}
+
+static const struct ReplacementPolicy REPLACEMENT_POLICIES[] = {
+    [POLICY_LRU]    = { .type = POLICY_LRU,     .name = "lru",      .on_hit = lru_on_hit,       .on_insert = lru_on_insert,         .choose_victim = lru_choose_victim },
+    [POLICY_CLOCK]  = { .type = POLICY_CLOCK,   .name = "clock",    .on_hit = clock_on_hit,     .on_insert = clock_on_insert,       .choose_victim = clock_choose_victim },
+    [POLICY_2Q]     = { .type = POLICY_2Q,      .name = "2q",       .on_hit = two_queue_on_hit, .on_insert = two_queue_on_insert,   .choose_victim = two_queue_choose_victim },
+};
+
+void replacement_state_init(struct ReplacementState *state, enum ReplacementPolicyType type, uint32_t cache_capacity) {
+    state->policy       = &REPLACEMENT_POLICIES[type];
+    state->stats        = (struct PolicyStats){ .hits = 0, .misses = 0, .evictions = 0 };
+    state->clock_hand   = 0;
+
+    slot_list_init(&state->recent);
+    slot_list_init(&state->frequent);
+
+    state->recent_target    = 0;
+    state->ghost_ring       = NULL;
+    state->ghost_capacity   = 0;
+    state->ghost_head       = 0;
+    state->ghost_count      = 0;
+    state->ghost_table      = (struct PageTable){ .keys = NULL, .values = NULL, .mask = 0, .count = 0 };
+
+    if (type == POLICY_2Q) {
+        // Sizes suggested by the 2Q paper, A1in holds 25% of the cache and A1out remembers 50%
+        state->recent_target    = cache_capacity / 4 > 0 ? cache_capacity / 4 : 1;
+        state->ghost_capacity   = cache_capacity / 2 > 0 ? cache_capacity / 2 : 1;
+        state->ghost_ring       = malloc(state->ghost_capacity * sizeof(uint32_t));
+
+        if (!state->ghost_ring) {
+            fprintf(stderr, "replacement_state_init: ghost_ring malloc failed\n");
+            exit(1);
+        }
+
+        page_table_init(&state->ghost_table, state->ghost_capacity);
+    }
+}
+
+void replacement_state_free(struct ReplacementState *state) {
+    free(state->ghost_ring);
+    state->ghost_ring = NULL;
+
+    if (state->ghost_table.keys != NULL) {
+        page_table_free(&state->ghost_table);
+    }
+}
+
+bool replacement_policy_from_name(const char *name, enum ReplacementPolicyType *type) {
+    for (size_t i = 0; i < sizeof(REPLACEMENT_POLICIES) / sizeof(REPLACEMENT_POLICIES[0]); i++) {
+        if (strcmp(name, REPLACEMENT_POLICIES[i].name) == 0) {
+            *type = REPLACEMENT_POLICIES[i].type;
+            return true;
+        }
+    }
+
+    return false;
+}
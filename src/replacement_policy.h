@@ -0,0 +1,69 @@
+#ifndef sql_replacement_policy
+#define sql_replacement_policy
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "utilities/page_table.h"
+
+struct PagePartition;
+
+enum ReplacementPolicyType {
+    POLICY_LRU,
+    POLICY_CLOCK,
+    POLICY_2Q
+};
+
+// Which list a cache slot is currently on
+enum SlotQueue {
+    QUEUE_NONE,
+    QUEUE_RECENT,       // The LRU list, or the 2Q A1in FIFO
+    QUEUE_FREQUENT      // The 2Q Am LRU list
+};
+
+// Intrusive list of cache slots threaded through struct Page, head is most recent
+struct SlotList {
+    uint32_t    head;
+    uint32_t    tail;
+    uint32_t    count;
+};
+
+struct PolicyStats {
+    uint64_t    hits;
+    uint64_t    misses;
+    uint64_t    evictions;
+};
+
+struct ReplacementPolicy {
+    enum ReplacementPolicyType  type;
+    const char                  *name;
+
+    void        (*on_hit)(struct PagePartition *partition, uint32_t slot);
+    void        (*on_insert)(struct PagePartition *partition, uint32_t slot);
+    // Unlinks and returns an unpinned slot, PAGE_SLOT_EMPTY if every slot is pinned
+    uint32_t    (*choose_victim)(struct PagePartition *partition);
+};
+
+struct ReplacementState {
+    const struct ReplacementPolicy  *policy;
+    struct PolicyStats              stats;
+
+    struct SlotList                 recent;
+    struct SlotList                 frequent;
+    uint32_t                        clock_hand;
+
+    // 2Q remembers the page numbers recently evicted from A1in, a page that
+    // comes back while remembered has been reused and goes straight to Am
+    uint32_t                        recent_target;
+    struct PageTable                ghost_table;
+    uint32_t                        *ghost_ring;
+    uint32_t                        ghost_capacity;
+    uint32_t                        ghost_head;
+    uint32_t                        ghost_count;
+};
+
+void replacement_state_init(struct ReplacementState *state, enum ReplacementPolicyType type, uint32_t cache_capacity);
+void replacement_state_free(struct ReplacementState *state);
+bool replacement_policy_from_name(const char *name, enum ReplacementPolicyType *type);
+
+#endif
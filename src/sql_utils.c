@@ -25,8 +25,10 @@ bool add_overflow_size_t(size_t a, size_t b, size_t *out) {
 
 struct SchemaRecord *get_schema_record_for_table(struct Pager *pager, const char *table_name) {
     // Read schema
-    int16_t number_of_tables = pager->schema_page_header->number_of_cells;
-    uint16_t *schema_offsets = read_cell_pointer_array(pager, pager->schema_page_header);
+    struct PageView schema_view;
+    page_view_open(pager, &schema_view, 1);
+
+    int16_t number_of_tables = schema_view.header.number_of_cells;
     fprintf(stderr, "There are %d tables\n", number_of_tables);
     
     struct Cell cell;
@@ -41,9 +43,9 @@ struct SchemaRecord *get_schema_record_for_table(struct Pager *pager, const char
 
         read_cell_and_schema_record(
             pager,
-            pager->schema_page_header,
+            &schema_view.header,
             &cell,
-            schema_offsets[i],
+            page_view_cell_offset(&schema_view, i),
             schema_record
         );
 
@@ -51,6 +53,7 @@ struct SchemaRecord *get_schema_record_for_table(struct Pager *pager, const char
             continue;
         }
 
+        page_view_release(&schema_view);
         return schema_record;
     }
 
@@ -60,8 +63,10 @@ struct SchemaRecord *get_schema_record_for_table(struct Pager *pager, const char
 
 uint32_t get_root_page_of_first_matching_index(struct Pager *pager, char *table_name, struct UnterminatedString *column_name) {
     // Read schema
-    int16_t number_of_tables = pager->schema_page_header->number_of_cells;
-    uint16_t *schema_offsets = read_cell_pointer_array(pager, pager->schema_page_header);
+    struct PageView schema_view;
+    page_view_open(pager, &schema_view, 1);
+
+    int16_t number_of_tables = schema_view.header.number_of_cells;
 
     // @TODO: should not be creating new pool here
     struct TriePool *pool = init_reserved_words();
@@ -75,9 +80,9 @@ uint32_t get_root_page_of_first_matching_index(struct Pager *pager, char *table_
 
         read_cell_and_schema_record(
             pager,
-            pager->schema_page_header,
+            &schema_view.header,
             &cell,
-            schema_offsets[i],
+            page_view_cell_offset(&schema_view, i),
             &schema_record);
         
         // If table name does not match
@@ -108,17 +113,19 @@ uint32_t get_root_page_of_first_matching_index(struct Pager *pager, char *table_
         vector_columns_free(stmt->indexed_columns);
         free(stmt);
 
+        page_view_release(&schema_view);
         return schema_record.body.root_page;
     }
 
+    page_view_release(&schema_view);
     return (uint32_t)0;
 }
 
 struct IndexColumnsArray *get_all_indexes_for_table(struct Pager *pager, char* table_name) {
     struct IndexColumnsArray *index_array = vector_index_columns_array_new();
 
-    struct PageHeader page_header;
-    uint16_t *cell_offsets = read_page_header_and_cell_pointer_array(pager, &page_header, 1);
+    struct PageView schema_view;
+    page_view_open(pager, &schema_view, 1);
 
     // @TODO: should not be creating new pool here
     struct TriePool *pool = init_reserved_words();
@@ -126,11 +133,11 @@ struct IndexColumnsArray *get_all_indexes_for_table(struct Pager *pager, char* t
     struct Cell cell;
     struct SchemaRecord record;
     
-    for (int i = 0; i < page_header.number_of_cells; i++) {
+    for (int i = 0; i < schema_view.header.number_of_cells; i++) {
         struct Parser parser_create_index;
         parser_init(&parser_create_index, DEFAULT_ARENA_CAPACITY);
-        uint16_t offset = cell_offsets[i];
-        read_cell_and_schema_record(pager, &page_header, &cell, offset, &record);
+        uint16_t offset = page_view_cell_offset(&schema_view, i);
+        read_cell_and_schema_record(pager, &schema_view.header, &cell, offset, &record);
 
         if (strcmp(record.body.table_name, table_name) != 0) {
             continue;
@@ -147,7 +154,7 @@ struct IndexColumnsArray *get_all_indexes_for_table(struct Pager *pager, char* t
         vector_index_columns_array_push(index_array, index_column);
     }
 
-    free(cell_offsets);
+    page_view_release(&schema_view);
     free(pool);
     return index_array;
 }
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "io_ring.h"
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+static int io_uring_setup(uint32_t entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int io_uring_enter(int ring_fd, uint32_t to_submit, uint32_t min_complete, uint32_t flags) {
+    return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+bool io_ring_init(struct IoRing *ring, uint32_t entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(ring, 0, sizeof(*ring));
+
+    ring->ring_fd = io_uring_setup(entries, &params);
+    if (ring->ring_fd < 0) {
+        // Not supported by the kernel, or blocked by a seccomp policy
+        ring->ring_fd = -1;
+        return false;
+    }
+
+    // IORING_OP_READ arrived in 5.6 together with this feature flag
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+        close(ring->ring_fd);
+        ring->ring_fd = -1;
+        return false;
+    }
+
+    ring->entries       = params.sq_entries;
+    ring->sq_ring_size  = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    ring->cq_ring_size  = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqes_size     = params.sq_entries * sizeof(struct io_uring_sqe);
+
+    // Newer kernels share one mapping between both rings
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        if (ring->cq_ring_size > ring->sq_ring_size) {
+            ring->sq_ring_size = ring->cq_ring_size;
+        }
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        fprintf(stderr, "io_ring_init: mmap of submission ring failed\n");
+        exit(1);
+    }
+
+    if (single_mmap) {
+        ring->cq_ring = ring->sq_ring;
+    } else {
+        ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_CQ_RING);
+        if (ring->cq_ring == MAP_FAILED) {
+            fprintf(stderr, "io_ring_init: mmap of completion ring failed\n");
+            exit(1);
+        }
+    }
+
+    ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        fprintf(stderr, "io_ring_init: mmap of submission entries failed\n");
+        exit(1);
+    }
+
+    uint8_t *sq_ring = ring->sq_ring;
+    ring->sq_head   = (uint32_t *)(sq_ring + params.sq_off.head);
+    ring->sq_tail   = (uint32_t *)(sq_ring + params.sq_off.tail);
+    ring->sq_mask   = (uint32_t *)(sq_ring + params.sq_off.ring_mask);
+    ring->sq_array  = (uint32_t *)(sq_ring + params.sq_off.array);
+
+    uint8_t *cq_ring = ring->cq_ring;
+    ring->cq_head   = (uint32_t *)(cq_ring + params.cq_off.head);
+    ring->cq_tail   = (uint32_t *)(cq_ring + params.cq_off.tail);
+    ring->cq_mask   = (uint32_t *)(cq_ring + params.cq_off.ring_mask);
+    ring->cqes      = cq_ring + params.cq_off.cqes;
+
+    return true;
+}
+
+void io_ring_free(struct IoRing *ring) {
+    if (ring->ring_fd < 0) {
+        return;
+    }
+
+    munmap(ring->sqes, ring->sqes_size);
+    if (ring->cq_ring != ring->sq_ring) {
+        munmap(ring->cq_ring, ring->cq_ring_size);
+    }
+    munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->ring_fd);
+
+    ring->ring_fd = -1;
+}
+
+bool io_ring_queue_read(struct IoRing *ring, int fd, void *buffer, uint32_t length, uint64_t offset, uint64_t user_data) {
+    // Only this thread writes the tail, the kernel moves the head as it consumes entries
+    uint32_t tail = *ring->sq_tail;
+    uint32_t head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+
+    if (tail - head >= ring->entries || ring->in_flight + ring->queued >= ring->entries) {
+        return false;
+    }
+
+    uint32_t index = tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &((struct io_uring_sqe *)ring->sqes)[index];
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode     = IORING_OP_READ;
+    sqe->fd         = fd;
+    sqe->addr       = (uint64_t)(uintptr_t)buffer;
+    sqe->len        = length;
+    sqe->off        = offset;
+    sqe->user_data  = user_data;
+
+    ring->sq_array[index] = index;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ring->queued++;
+
+    return true;
+}
+
+void io_ring_submit(struct IoRing *ring) {
+    while (ring->queued > 0) {
+        int submitted = io_uring_enter(ring->ring_fd, ring->queued, 0, 0);
+
+        if (submitted < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            fprintf(stderr, "io_ring_submit: io_uring_enter failed with errno %d\n", errno);
+            exit(1);
+        }
+
+        ring->queued    -= (uint32_t)submitted;
+        ring->in_flight += (uint32_t)submitted;
+    }
+}
+
+uint32_t io_ring_reap(struct IoRing *ring, struct IoCompletion *completions, uint32_t max_completions, bool wait) {
+    io_ring_submit(ring);
+
+    uint32_t count = 0;
+    while (true) {
+        // Only this thread writes the head, the kernel moves the tail as reads complete
+        uint32_t head = *ring->cq_head;
+        uint32_t tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+        while (head != tail && count < max_completions) {
+            struct io_uring_cqe *cqe = &((struct io_uring_cqe *)ring->cqes)[head & *ring->cq_mask];
+            completions[count].user_data    = cqe->user_data;
+            completions[count].result       = cqe->res;
+            count++;
+            head++;
+        }
+
+        __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+        ring->in_flight -= count;
+
+        if (count > 0 || !wait || ring->in_flight == 0) {
+            return count;
+        }
+
+        if (io_uring_enter(ring->ring_fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+            fprintf(stderr, "io_ring_reap: io_uring_enter failed with errno %d\n", errno);
+            exit(1);
+        }
+    }
+}
+
+#else
+
+bool io_ring_init(struct IoRing *ring, uint32_t entries) {
+    memset(ring, 0, sizeof(*ring));
+    ring->ring_fd = -1;
+    return false;
+}
+
+void io_ring_free(struct IoRing *ring) {
+    ring->ring_fd = -1;
+}
+
+bool io_ring_queue_read(struct IoRing *ring, int fd, void *buffer, uint32_t length, uint64_t offset, uint64_t user_data) {
+    return false;
+}
+
+void io_ring_submit(struct IoRing *ring) {
+}
+
+uint32_t io_ring_reap(struct IoRing *ring, struct IoCompletion *completions, uint32_t max_completions, bool wait) {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef sql_io_ring
+#define sql_io_ring
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+struct IoCompletion {
+    uint64_t    user_data;
+    int32_t     result;     // Bytes read, or a negative errno
+};
+
+// Minimal io_uring submission/completion rings, set up with the raw syscalls so
+// there is no liburing dependency. Only reads are supported.
+// On platforms without io_uring io_ring_init fails and callers fall back to blocking reads.
+struct IoRing {
+    int         ring_fd;
+    uint32_t    entries;
+    uint32_t    queued;     // Prepared but not yet submitted to the kernel
+    uint32_t    in_flight;  // Submitted but not yet reaped
+
+    // Submission queue
+    uint32_t    *sq_head;
+    uint32_t    *sq_tail;
+    uint32_t    *sq_mask;
+    uint32_t    *sq_array;
+    void        *sqes;
+
+    // Completion queue
+    uint32_t    *cq_head;
+    uint32_t    *cq_tail;
+    uint32_t    *cq_mask;
+    void        *cqes;
+
+    void        *sq_ring;
+    size_t      sq_ring_size;
+    void        *cq_ring;
+    size_t      cq_ring_size;
+    size_t      sqes_size;
+};
+
+bool io_ring_init(struct IoRing *ring, uint32_t entries);
+void io_ring_free(struct IoRing *ring);
+bool io_ring_queue_read(struct IoRing *ring, int fd, void *buffer, uint32_t length, uint64_t offset, uint64_t user_data);
+void io_ring_submit(struct IoRing *ring);
+uint32_t io_ring_reap(struct IoRing *ring, struct IoCompletion *completions, uint32_t max_completions, bool wait);
+
+#endif
@@ -0,0 +1,102 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "page_table.h"
+
+static inline uint32_t page_table_home(const struct PageTable *table, uint32_t page_number) {
+    // Fibonacci hashing spreads sequential page numbers across the table
+    return (page_number * 2654435761u) & table->mask;
+}
+
+void page_table_init(struct PageTable *table, uint32_t max_entries) {
+    // Keep the table at most half full so probe runs stay short
+    uint32_t capacity = 1;
+    while (capacity < max_entries * 2) {
+        capacity <<= 1;
+    }
+
+    table->keys     = malloc(capacity * sizeof(uint32_t));
+    table->values   = malloc(capacity * sizeof(uint32_t));
+    table->mask     = capacity - 1;
+    table->count    = 0;
+
+    if (!table->keys || !table->values) {
+        fprintf(stderr, "page_table_init: malloc failed\n");
+        exit(1);
+    }
+
+    for (uint32_t i = 0; i < capacity; i++) {
+        table->keys[i] = PAGE_TABLE_EMPTY_KEY;
+    }
+}
+
+void page_table_free(struct PageTable *table) {
+    free(table->keys);
+    free(table->values);
+    table->keys     = NULL;
+    table->values   = NULL;
+    table->mask     = 0;
+    table->count    = 0;
+}
+
+uint32_t page_table_find(const struct PageTable *table, uint32_t page_number) {
+    uint32_t bucket = page_table_home(table, page_number);
+
+    while (table->keys[bucket] != PAGE_TABLE_EMPTY_KEY) {
+        if (table->keys[bucket] == page_number) {
+            return table->values[bucket];
+        }
+        bucket = (bucket + 1) & table->mask;
+    }
+
+    return PAGE_TABLE_NOT_FOUND;
+}
+
+void page_table_insert(struct PageTable *table, uint32_t page_number, uint32_t value) {
+    uint32_t bucket = page_table_home(table, page_number);
+
+    while (table->keys[bucket] != PAGE_TABLE_EMPTY_KEY) {
+        if (table->keys[bucket] == page_number) {
+            table->values[bucket] = value;
+            return;
+        }
+        bucket = (bucket + 1) & table->mask;
+    }
+
+    table->keys[bucket]     = page_number;
+    table->values[bucket]   = value;
+    table->count++;
+}
+
+bool page_table_remove(struct PageTable *table, uint32_t page_number) {
+    uint32_t mask   = table->mask;
+    uint32_t bucket = page_table_home(table, page_number);
+
+    while (table->keys[bucket] != page_number) {
+        if (table->keys[bucket] == PAGE_TABLE_EMPTY_KEY) {
+            return false;
+        }
+        bucket = (bucket + 1) & mask;
+    }
+
+    // Backward shift deletion, pull later entries of the probe run into the hole
+    // unless their home bucket lies between the hole and where they are now
+    uint32_t next = (bucket + 1) & mask;
+    while (table->keys[next] != PAGE_TABLE_EMPTY_KEY) {
+        uint32_t home = page_table_home(table, table->keys[next]);
+
+        if (((next - home) & mask) >= ((next - bucket) & mask)) {
+            table->keys[bucket]     = table->keys[next];
+            table->values[bucket]   = table->values[next];
+            bucket = next;
+        }
+
+        next = (next + 1) & mask;
+    }
+
+    table->keys[bucket] = PAGE_TABLE_EMPTY_KEY;
+    table->count--;
+    return true;
+}
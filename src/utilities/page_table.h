@@ -0,0 +1,25 @@
+#ifndef sql_page_table
+#define sql_page_table
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PAGE_TABLE_EMPTY_KEY    (0)             // Page numbers start at 1
+#define PAGE_TABLE_NOT_FOUND    (UINT32_MAX)
+
+// Fixed capacity open addressing map from page number to a uint32_t.
+// Sized at creation so it never grows, callers must not insert more than max_entries.
+struct PageTable {
+    uint32_t    *keys;
+    uint32_t    *values;
+    uint32_t    mask;
+    uint32_t    count;
+};
+
+void page_table_init(struct PageTable *table, uint32_t max_entries);
+void page_table_free(struct PageTable *table);
+uint32_t page_table_find(const struct PageTable *table, uint32_t page_number);
+void page_table_insert(struct PageTable *table, uint32_t page_number, uint32_t value);
+bool page_table_remove(struct PageTable *table, uint32_t page_number);
+
+#endif
@@ -0,0 +1,126 @@
+// Aggregate kernel benchmark, reports the cost per row of SUM, MIN and MAX over a column
+//
+// The per value pass adds every value to three accumulators one at a time, the way row
+// execution does. The kernels summarise the column once per batch for all three, at each
+// level the CPU supports, and are checked against the scalar kernel. The second column
+// holds values large enough that the vector kernel has to take its sum again in 128 bits.
+//
+// Build from the repository root:
+// gcc -O2 -Isrc tests/aggregate_bench.c src/planning/aggregate_kernels.c src/planning/accumulator.c src/planning/filter_kernels.c src/planning/column_batch.c src/arena.c src/data_parsing/*.c src/btree_cursor.c src/comparisons.c src/common.c src/pager.c src/replacement_policy.c src/utilities/page_table.c src/utilities/io_ring.c -o aggregate_bench.exe
+//
+// Run:
+// aggregate_bench.exe
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+#include "arena.h"
+#include "planning/accumulator.h"
+#include "planning/aggregate_kernels.h"
+
+#define BENCH_BATCHES (100000)
+
+static void fill_vector(struct ColumnVector *vector, int64_t scale) {
+    // Integers with a NULL every 16 rows and a text value every 64
+    srand(42);
+
+    for (uint32_t i = 0; i < BATCH_SIZE; i++) {
+        vector->types[i]    = i % 16 == 0 ? VALUE_NULL : i % 64 == 1 ? VALUE_TEXT : VALUE_INT;
+        vector->ints[i]     = ((int64_t)(rand() % 2001) - 1000) * scale;
+    }
+}
+
+static bool summaries_equal(struct IntSummary *a, struct IntSummary *b) {
+    return a->int_count == b->int_count && a->other_count == b->other_count
+        && a->sum == b->sum && a->min == b->min && a->max == b->max;
+}
+
+static void bench_per_value(struct ColumnVector *vector) {
+    struct ArenaAllocator arena = arena_new(1024);
+    struct Accumulator accumulators[3];
+    enum AggType types[3] = { AGG_SUM, AGG_MIN, AGG_MAX };
+    struct timespec start, end;
+
+    for (int i = 0; i < 3; i++) {
+        accumulator_init(&accumulators[i]);
+    }
+
+    timespec_get(&start, TIME_UTC);
+    for (int batch = 0; batch < BENCH_BATCHES; batch++) {
+        for (uint32_t r = 0; r < BATCH_SIZE; r++) {
+            if (vector->types[r] != VALUE_INT) {
+                continue;
+            }
+
+            struct Value value = { .type = VALUE_INT, .int_value.value = vector->ints[r] };
+            for (int i = 0; i < 3; i++) {
+                accumulator_add(&accumulators[i], &arena, types[i], &value);
+            }
+        }
+
+        // Keeps the sum from overflowing across batches
+        accumulators[0].sum.int_sum = 0;
+    }
+    timespec_get(&end, TIME_UTC);
+
+    double rows = (double)BENCH_BATCHES * BATCH_SIZE;
+    printf("%-10s %6.3f ns/row\n", "per value", elapsed_ns(&start, &end) / rows);
+    arena_free(&arena);
+}
+
+static void bench_kernels(const struct AggregateKernels *kernels, struct ColumnVector *vector, const char *column) {
+    const struct AggregateKernels *scalar = aggregate_kernels_for_level(KERNEL_SCALAR);
+    struct IntSummary expected, summary;
+    struct timespec start, end;
+
+    scalar->summarise_ints(vector->types, vector->ints, BATCH_SIZE, &expected);
+
+    timespec_get(&start, TIME_UTC);
+    for (int i = 0; i < BENCH_BATCHES; i++) {
+        // Varying the length keeps the compiler from hoisting the call, and exercises the tails
+        kernels->summarise_ints(vector->types, vector->ints, BATCH_SIZE - (uint32_t)(i & 1), &summary);
+    }
+    timespec_get(&end, TIME_UTC);
+
+    kernels->summarise_ints(vector->types, vector->ints, BATCH_SIZE, &summary);
+    if (!summaries_equal(&summary, &expected)) {
+        fprintf(stderr, "%s kernel disagrees with scalar on the %s column\n", kernels->name, column);
+        exit(1);
+    }
+
+    double rows = (double)BENCH_BATCHES * BATCH_SIZE;
+    printf("%-10s %6.3f ns/row, %s column, %lld integers, sum %.6g\n",
+        kernels->name, elapsed_ns(&start, &end) / rows, column, (long long)summary.int_count, (double)summary.sum);
+}
+
+int main(void) {
+    struct ColumnVector *small = calloc(1, sizeof(struct ColumnVector));
+    struct ColumnVector *large = calloc(1, sizeof(struct ColumnVector));
+    if (!small || !large) {
+        fprintf(stderr, "main: vector calloc failed\n");
+        return 1;
+    }
+
+    fill_vector(small, 1);
+    fill_vector(large, INT64_MAX / 1000);
+
+    bench_per_value(small);
+
+    for (int level = KERNEL_SCALAR; level <= KERNEL_AVX2; level++) {
+        const struct AggregateKernels *kernels = aggregate_kernels_for_level((enum KernelLevel)level);
+        if (kernels == NULL || (level != KERNEL_SCALAR && kernels->summarise_ints == aggregate_kernels_for_level(KERNEL_SCALAR)->summarise_ints)) {
+            continue;
+        }
+
+        bench_kernels(kernels, small, "small");
+        bench_kernels(kernels, large, "large");
+    }
+
+    free(small);
+    free(large);
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Execution model benchmark, reports rows per second for one query
+//
+// The query is planned twice per pass. The first plan is drained with plan_next, one row
+// at a time through the volcano operators. The second is drained with plan_next_batch,
+// which moves up to BATCH_SIZE rows at a time in column arrays. Nothing is printed, so
+// the time is spent in the scan and the operators above it.
+//
+// Build from the repository root:
+// gcc -O2 -Isrc tests/batch_bench.c $(ls src/*.c | grep -v main.c) src/data_parsing/*.c src/planning/*.c src/utilities/*.c -o batch_bench.exe
+//
+// Run:
+// batch_bench.exe big.db "SELECT id, a FROM t WHERE a < 100"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "bench.h"
+#include "pager.h"
+#include "parser.h"
+#include "lexer.h"
+#include "planning/plan.h"
+#include "planning/column_batch.h"
+
+#define BENCH_PASSES (3)
+
+static struct Plan *plan_query(struct Pager *pager, const char *query) {
+    struct Parser parser;
+    parser_init(&parser, DEFAULT_ARENA_CAPACITY);
+
+    struct SelectStatement *stmt = parse(&parser, query, init_reserved_words());
+    struct PlanConfig config = plan_default_config();
+    return build_plan(pager, stmt, &config);
+}
+
+static void report(const char *name, uint64_t rows, struct timespec *start, struct timespec *end) {
+    double seconds = elapsed_ns(start, end) / 1e9;
+
+    printf("%-6s %10llu rows, %12.0f rows/s (%.3f s)\n",
+        name, (unsigned long long)rows, (double)rows / seconds, seconds);
+}
+
+static uint64_t bench_rows(struct Pager *pager, const char *query) {
+    struct Plan *plan = plan_query(pager, query);
+    struct Row row;
+    uint64_t rows = 0;
+    struct timespec start, end;
+
+    timespec_get(&start, TIME_UTC);
+    while (plan_next(pager, plan, &row)) {
+        rows++;
+    }
+    timespec_get(&end, TIME_UTC);
+
+    report("row", rows, &start, &end);
+    return rows;
+}
+
+static uint64_t bench_batches(struct Pager *pager, const char *query) {
+    struct Plan *plan = plan_query(pager, query);
+    struct ColumnBatch *batch;
+    uint64_t rows = 0;
+    struct timespec start, end;
+
+    timespec_get(&start, TIME_UTC);
+    while (plan_next_batch(pager, plan, &batch)) {
+        rows += batch->selected_count;
+    }
+    timespec_get(&end, TIME_UTC);
+
+    report("batch", rows, &start, &end);
+    return rows;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: batch_bench.exe <database path> <query>\n");
+        return 1;
+    }
+
+    // Large enough to hold the whole table, so the passes after the first measure execution and not the disk
+    struct PagerConfig config = pager_default_config();
+    config.cache_capacity = 1 << 17;
+
+    struct Pager *pager = pager_open(argv[1], &config);
+
+    for (int pass = 0; pass < BENCH_PASSES; pass++) {
+        uint64_t row_count = bench_rows(pager, argv[2]);
+        uint64_t batch_count = bench_batches(pager, argv[2]);
+
+        if (row_count != batch_count) {
+            fprintf(stderr, "Row and batch execution disagree: %llu vs %llu rows\n", (unsigned long long)row_count, (unsigned long long)batch_count);
+            return 1;
+        }
+    }
+
+    pager_close(pager);
+    free(pager);
+    return 0;
+}
@@ -0,0 +1,35 @@
+#ifndef sql_bench
+#define sql_bench
+
+// Helpers shared by the benchmarks in tests/, each built as its own program
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "data_parsing/row_parsing.h"
+
+#define BENCH_HASH_SEED (14695981039346656037ULL)
+
+static inline double elapsed_ns(struct timespec *start, struct timespec *end) {
+    return (double)(end->tv_sec - start->tv_sec) * 1e9 + (double)(end->tv_nsec - start->tv_nsec);
+}
+
+static inline uint64_t hash_value(uint64_t hash, struct Value *value) {
+    // FNV-1a over the type and the bytes of the value, start from BENCH_HASH_SEED
+    const unsigned char *bytes = (const unsigned char *)&value->int_value.value;
+    size_t len = value->type == VALUE_NULL ? 0 : sizeof(int64_t);
+
+    if (value->type == VALUE_TEXT) {
+        bytes   = (const unsigned char *)value->text_value.text.start;
+        len     = value->text_value.text.len;
+    }
+
+    hash = (hash ^ (uint64_t)value->type) * 1099511628211ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+#endif
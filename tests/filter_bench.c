@@ -0,0 +1,145 @@
+// Filter kernel benchmark, reports the cost of one comparison per row for every kernel level
+//
+// A batch of random integers is compared against a constant with each op, once per level
+// the CPU supports, and the bitmaps are checked against the scalar kernels. Text equality
+// has a single kernel and is timed on its own. Nothing is read from disk, so this measures
+// the kernels alone, the decoding a real scan does first is not included.
+//
+// Build from the repository root:
+// gcc -O2 -Isrc tests/filter_bench.c src/planning/filter_kernels.c src/planning/column_batch.c src/data_parsing/*.c src/btree_cursor.c src/comparisons.c src/common.c src/pager.c src/replacement_policy.c src/utilities/page_table.c src/utilities/io_ring.c -o filter_bench.exe
+//
+// Run:
+// filter_bench.exe
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+#include "planning/column_batch.h"
+#include "planning/filter_kernels.h"
+
+#define BENCH_BATCHES (200000)
+
+static void fill_vector(struct ColumnVector *vector) {
+    // Integers in 0..999 with a NULL every 16 rows, so the type bitmap is not all ones.
+    // texts is filled too, bench_texts retypes the rows once the integer kernels are done.
+    srand(42);
+
+    for (uint32_t i = 0; i < BATCH_SIZE; i++) {
+        vector->types[i]        = i % 16 == 0 ? VALUE_NULL : VALUE_INT;
+        vector->ints[i]         = rand() % 1000;
+        vector->texts[i].start  = i % 2 == 0 ? "vv2" : "vv20";
+        vector->texts[i].len    = i % 2 == 0 ? 3 : 4;
+    }
+}
+
+static uint64_t bitmap_count(const uint64_t *bitmap) {
+    uint64_t count = 0;
+    for (size_t i = 0; i < BITMAP_WORDS; i++) {
+        count += (uint64_t)__builtin_popcountll(bitmap[i]);
+    }
+    return count;
+}
+
+static void bench_ints(const struct FilterKernels *kernels, struct ColumnVector *vector, enum BinaryOp op, const char *op_name) {
+    const struct FilterKernels *scalar = filter_kernels_for_level(KERNEL_SCALAR);
+    uint64_t expected[BITMAP_WORDS];
+    uint64_t bitmap[BITMAP_WORDS];
+    struct timespec start, end;
+
+    // A value from the middle of the column, so = matches some rows
+    int64_t value = vector->ints[BATCH_SIZE / 2];
+    scalar->compare_ints(vector->ints, BATCH_SIZE, op, value, expected);
+
+    timespec_get(&start, TIME_UTC);
+    for (int i = 0; i < BENCH_BATCHES; i++) {
+        // Varying the length keeps the compiler from hoisting the call, and exercises the tails
+        kernels->compare_ints(vector->ints, BATCH_SIZE - (uint32_t)(i & 1), op, value, bitmap);
+    }
+    timespec_get(&end, TIME_UTC);
+
+    kernels->compare_ints(vector->ints, BATCH_SIZE, op, value, bitmap);
+    if (memcmp(bitmap, expected, sizeof bitmap) != 0) {
+        fprintf(stderr, "%s kernels disagree with scalar on %s\n", kernels->name, op_name);
+        exit(1);
+    }
+
+    double rows = (double)BENCH_BATCHES * BATCH_SIZE;
+    printf("%-7s int %-2s %6.3f ns/row, %llu matches per batch\n",
+        kernels->name, op_name, elapsed_ns(&start, &end) / rows, (unsigned long long)bitmap_count(bitmap));
+}
+
+static void bench_types(const struct FilterKernels *kernels, struct ColumnVector *vector) {
+    const struct FilterKernels *scalar = filter_kernels_for_level(KERNEL_SCALAR);
+    uint64_t expected[BITMAP_WORDS];
+    uint64_t bitmap[BITMAP_WORDS];
+    struct timespec start, end;
+
+    scalar->match_types(vector->types, BATCH_SIZE, VALUE_INT, expected);
+
+    timespec_get(&start, TIME_UTC);
+    for (int i = 0; i < BENCH_BATCHES; i++) {
+        kernels->match_types(vector->types, BATCH_SIZE - (uint32_t)(i & 1), VALUE_INT, bitmap);
+    }
+    timespec_get(&end, TIME_UTC);
+
+    kernels->match_types(vector->types, BATCH_SIZE, VALUE_INT, bitmap);
+    if (memcmp(bitmap, expected, sizeof bitmap) != 0) {
+        fprintf(stderr, "%s kernels disagree with scalar on types\n", kernels->name);
+        exit(1);
+    }
+
+    double rows = (double)BENCH_BATCHES * BATCH_SIZE;
+    printf("%-7s type   %6.3f ns/row\n", kernels->name, elapsed_ns(&start, &end) / rows);
+}
+
+static void bench_texts(struct ColumnVector *vector) {
+    struct UnterminatedString value = { .start = "vv2", .len = 3 };
+    uint64_t bitmap[BITMAP_WORDS];
+    struct timespec start, end;
+
+    for (uint32_t i = 0; i < BATCH_SIZE; i++) {
+        vector->types[i] = vector->types[i] == VALUE_NULL ? VALUE_NULL : VALUE_TEXT;
+    }
+
+    timespec_get(&start, TIME_UTC);
+    for (int i = 0; i < BENCH_BATCHES; i++) {
+        text_equal_bitmap(vector, BATCH_SIZE, &value, bitmap);
+    }
+    timespec_get(&end, TIME_UTC);
+
+    double rows = (double)BENCH_BATCHES * BATCH_SIZE;
+    printf("text = %6.3f ns/row, %llu matches per batch\n",
+        elapsed_ns(&start, &end) / rows, (unsigned long long)bitmap_count(bitmap));
+}
+
+int main(void) {
+    struct ColumnVector *vector = calloc(1, sizeof(struct ColumnVector));
+    if (!vector) {
+        fprintf(stderr, "main: vector calloc failed\n");
+        return 1;
+    }
+
+    fill_vector(vector);
+    printf("Best kernels: %s\n", filter_kernels()->name);
+
+    for (int level = KERNEL_SCALAR; level <= KERNEL_AVX2; level++) {
+        const struct FilterKernels *kernels = filter_kernels_for_level((enum KernelLevel)level);
+        if (kernels == NULL) {
+            continue;
+        }
+
+        bench_ints(kernels, vector, BIN_EQUAL, "=");
+        bench_ints(kernels, vector, BIN_LESS, "<");
+        bench_ints(kernels, vector, BIN_GREATER, ">");
+        bench_types(kernels, vector);
+    }
+
+    bench_texts(vector);
+
+    free(vector);
+    return 0;
+}
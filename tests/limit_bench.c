@@ -0,0 +1,109 @@
+// LIMIT benchmark, compares LIMIT ... OFFSET against reading the whole query
+//
+// The query, which has no ORDER BY or LIMIT of its own, is run as it is and with LIMIT n
+// OFFSET m appended. The limited query has to give rows m to m + n of the full one. On a
+// table scan without a WHERE the offset rows are skipped a leaf page at a time, and the
+// scan stops once the last row is out.
+//
+// Page requests, cache hits and misses, are counted for each run. With a maximum given the
+// limited query fails the run when it requests more pages, which catches a scan that reads
+// past the rows the LIMIT wants, as an index scan gathering its whole range would.
+//
+// Build from the repository root:
+// gcc -O2 -Isrc tests/limit_bench.c $(ls src/*.c | grep -v main.c) src/data_parsing/*.c src/planning/*.c src/utilities/*.c -o limit_bench.exe
+//
+// Run:
+// limit_bench.exe big.db "SELECT id, a, b FROM t" 10 1000000
+// limit_bench.exe companies.db "SELECT id, name FROM companies WHERE country >= 'a'" 3 5000 200
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "bench.h"
+#include "pager.h"
+#include "parser.h"
+#include "lexer.h"
+#include "planning/plan.h"
+#include "planning/column_batch.h"
+
+static uint64_t page_requests(struct Pager *pager) {
+    struct PolicyStats stats = pager_stats(pager);
+    return stats.hits + stats.misses;
+}
+
+static uint64_t run_query(struct Pager *pager, const char *query, uint64_t first, uint64_t count, const char *name, uint64_t *requests) {
+    // Hashes rows first to first + count of the query's output
+    struct Parser parser;
+    parser_init(&parser, DEFAULT_ARENA_CAPACITY);
+
+    struct SelectStatement *stmt = parse(&parser, query, init_reserved_words());
+    struct PlanConfig config = plan_default_config();
+    struct Plan *plan = build_plan(pager, stmt, &config);
+    struct ColumnBatch *batch;
+    struct Value value;
+    uint64_t row = 0;
+    uint64_t hash = BENCH_HASH_SEED;
+    struct timespec start, end;
+
+    uint64_t first_request = page_requests(pager);
+    timespec_get(&start, TIME_UTC);
+    while (plan_next_batch(pager, plan, &batch)) {
+        for (uint32_t i = 0; i < batch->selected_count; i++, row++) {
+            if (row < first || row - first >= count) {
+                continue;
+            }
+
+            for (uint32_t c = 0; c < batch->column_count; c++) {
+                column_batch_get_value(batch, c, batch->selection[i], &value);
+                hash = hash_value(hash, &value);
+            }
+        }
+    }
+    timespec_get(&end, TIME_UTC);
+    *requests = page_requests(pager) - first_request;
+
+    printf("%-6s %10llu rows out, %.3f s, %8llu page requests, hash %016llx\n",
+        name, (unsigned long long)row, elapsed_ns(&start, &end) / 1e9, (unsigned long long)*requests, (unsigned long long)hash);
+    return hash;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 5 && argc != 6) {
+        fprintf(stderr, "Usage: limit_bench.exe <database path> <query> <limit> <offset> [max page requests]\n");
+        return 1;
+    }
+
+    uint64_t limit = strtoull(argv[3], NULL, 10);
+    uint64_t offset = strtoull(argv[4], NULL, 10);
+    uint64_t max_requests = argc == 6 ? strtoull(argv[5], NULL, 10) : UINT64_MAX;
+    uint64_t requests;
+
+    char limited[4096];
+    snprintf(limited, sizeof limited, "%s LIMIT %llu OFFSET %llu", argv[2], (unsigned long long)limit, (unsigned long long)offset);
+
+    // Large enough to hold the whole table, so the passes after the first measure execution and not the disk
+    struct PagerConfig config = pager_default_config();
+    config.cache_capacity = 1 << 17;
+
+    struct Pager *pager = pager_open(argv[1], &config);
+
+    run_query(pager, argv[2], offset, limit, "warm", &requests);
+    uint64_t full = run_query(pager, argv[2], offset, limit, "full", &requests);
+    uint64_t limited_hash = run_query(pager, limited, 0, UINT64_MAX, "limit", &requests);
+
+    if (full != limited_hash) {
+        fprintf(stderr, "The limited query gives other rows than the full one\n");
+        return 1;
+    }
+
+    if (requests > max_requests) {
+        fprintf(stderr, "The limited query requested %llu pages, more than %llu\n", (unsigned long long)requests, (unsigned long long)max_requests);
+        return 1;
+    }
+
+    pager_close(pager);
+    free(pager);
+    return 0;
+}
@@ -1,5 +1,6 @@
 # Tests require that sqlite3.exe is on PATH
 
+import os
 import subprocess
 import time
 
@@ -7,6 +8,28 @@ RED = "\033[31m"
 GREEN = "\033[32m"
 RESET = "\033[0m"
 
+# Every query runs through both execution paths, batches are the default
+EXEC_MODES = ["--exec=batch", "--exec=row"]
+
+FIXTURE_DB = "fixture.db"
+
+# Built with sqlite3.exe before the tests run. Every column but the key has NULLs, price holds
+# integers and floats with the same values, and region, quantity is a composite index.
+FIXTURE_SQL = """
+CREATE TABLE orders (id integer primary key, customer text, region text, quantity integer, price, note text);
+CREATE INDEX idx_orders_quantity ON orders (quantity);
+CREATE INDEX idx_orders_region_quantity ON orders (region, quantity);
+WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 5000)
+INSERT INTO orders SELECT
+    i,
+    'customer ' || (i % 37),
+    CASE WHEN i % 5 = 0 THEN NULL ELSE 'region ' || (i % 4) END,
+    CASE WHEN i % 11 = 0 THEN NULL ELSE (i * 7) % 101 END,
+    CASE i % 3 WHEN 0 THEN i % 13 WHEN 1 THEN (i % 13) * 1.0 ELSE (i % 13) + 0.5 END,
+    CASE WHEN i % 7 = 0 THEN NULL ELSE printf('note %04d', (i * 31) % 5000) END
+FROM n;
+"""
+
 TEST_QUERIES = [
     ["companies.db",    ".tables"],
     ["companies.db",    ".dbinfo"],
@@ -16,12 +39,83 @@ TEST_QUERIES = [
     ["companies.db",    "SELECT id, name FROM companies WHERE country = 'eritrea'"],
     ["companies.db",    "SELECT id, name FROM companies WHERE country = 'chad'"],
     ["companies.db",    "SELECT id, name FROM companies WHERE country = 'republic of the congo'"],
+
+    # Index and rowid range scans
+    [FIXTURE_DB,        "SELECT id, quantity FROM orders WHERE quantity < 3"],
+    [FIXTURE_DB,        "SELECT id, quantity FROM orders WHERE quantity >= 99"],
+    [FIXTURE_DB,        "SELECT id, quantity FROM orders WHERE quantity > 40 AND quantity <= 42"],
+    [FIXTURE_DB,        "SELECT id, quantity FROM orders WHERE quantity BETWEEN 10 AND 11"],
+    ["companies.db",    "SELECT id, name FROM companies WHERE country > 'peru'"],
+    [FIXTURE_DB,        "SELECT id FROM orders WHERE id BETWEEN 100 AND 110"],
+
+    # Composite index, an equality prefix then an equality or a range
+    [FIXTURE_DB,        "SELECT id, quantity FROM orders WHERE region = 'region 2' AND quantity = 50"],
+    [FIXTURE_DB,        "SELECT id, quantity FROM orders WHERE region = 'region 1' AND quantity > 97"],
+    [FIXTURE_DB,        "SELECT id, quantity FROM orders WHERE region = 'region 3' AND quantity BETWEEN 20 AND 21"],
+    [FIXTURE_DB,        "SELECT id, region, quantity FROM orders WHERE region = 'region 0' AND quantity < 2"],
+    # GROUP BY on text, integer and composite keys, NULL keys, and 0 and 0.0 in one group. Groups
+    # come out in the order they are first seen, each range is one where that is the key order
+    [FIXTURE_DB,        "SELECT region, count(*), sum(quantity) FROM orders WHERE id >= 15 GROUP BY region"],
+    [FIXTURE_DB,        "SELECT customer, count(*), sum(quantity) FROM orders WHERE customer > 'customer 1' AND customer < 'customer 2' GROUP BY customer"],
+    [FIXTURE_DB,        "SELECT region, quantity, count(*) FROM orders WHERE region > 'a' GROUP BY region, quantity"],
+    [FIXTURE_DB,        "SELECT quantity, count(*) FROM orders WHERE quantity >= 0 GROUP BY quantity"],
+    [FIXTURE_DB,        "SELECT price, count(*), sum(quantity) FROM orders WHERE id BETWEEN 39 AND 52 GROUP BY price"],
+    ["companies.db",    "SELECT country, count(*) FROM companies WHERE country > 'a' GROUP BY country"],
+
+    # Aggregates skip NULLs, and are NULL or 0 over only NULLs and over no rows
+    [FIXTURE_DB,        "SELECT sum(quantity), avg(quantity), min(quantity), max(quantity), count(quantity), count(*) FROM orders"],
+    [FIXTURE_DB,        "SELECT sum(price), min(price), max(price), count(price) FROM orders"],
+    [FIXTURE_DB,        "SELECT min(note), max(note), count(note) FROM orders"],
+    [FIXTURE_DB,        "SELECT sum(quantity), avg(quantity), min(quantity), max(quantity), count(quantity), count(*) FROM orders WHERE id = 11"],
+    [FIXTURE_DB,        "SELECT sum(quantity), avg(quantity), min(note), max(note), count(quantity), count(*) FROM orders WHERE quantity > 200"],
+    [FIXTURE_DB,        "SELECT region, sum(quantity), avg(quantity), min(note), max(note), count(note) FROM orders WHERE id >= 15 GROUP BY region"],
+
+    # ORDER BY ascending, descending and on several keys, the last key makes the order total
+    [FIXTURE_DB,        "SELECT id, quantity FROM orders WHERE id <= 30 ORDER BY quantity, id"],
+    [FIXTURE_DB,        "SELECT id, quantity FROM orders WHERE id <= 30 ORDER BY quantity DESC, id"],
+    [FIXTURE_DB,        "SELECT id, region, quantity FROM orders WHERE id <= 60 ORDER BY region DESC, quantity, id"],
+    [FIXTURE_DB,        "SELECT id, note FROM orders WHERE id <= 40 ORDER BY note, id"],
+    [FIXTURE_DB,        "SELECT id, price FROM orders WHERE id <= 40 ORDER BY price DESC, id"],
+    ["companies.db",    "SELECT id, name, country FROM companies ORDER BY country DESC, id DESC"],
+
+    # ORDER BY ... LIMIT through the top-n heap, with an offset past the end too
+    [FIXTURE_DB,        "SELECT id, quantity FROM orders ORDER BY quantity DESC, id LIMIT 5"],
+    [FIXTURE_DB,        "SELECT id, note FROM orders ORDER BY note, id LIMIT 4 OFFSET 10"],
+    [FIXTURE_DB,        "SELECT id, note FROM orders ORDER BY note DESC, id LIMIT 4 OFFSET 4280"],
+    [FIXTURE_DB,        "SELECT id, region FROM orders ORDER BY region, id DESC LIMIT 6 OFFSET 995"],
+    [FIXTURE_DB,        "SELECT id, quantity FROM orders ORDER BY quantity, id LIMIT 3 OFFSET 6000"],
+
+    # LIMIT and OFFSET without an ORDER BY, over full, index and filtered scans
+    [FIXTURE_DB,        "SELECT id, customer FROM orders LIMIT 5"],
+    [FIXTURE_DB,        "SELECT id, customer FROM orders LIMIT 3 OFFSET 4998"],
+    [FIXTURE_DB,        "SELECT id, customer FROM orders LIMIT 3 OFFSET 5000"],
+    [FIXTURE_DB,        "SELECT id, customer FROM orders LIMIT 3 OFFSET 9000"],
+    [FIXTURE_DB,        "SELECT id FROM orders LIMIT 0"],
+    [FIXTURE_DB,        "SELECT id, quantity FROM orders WHERE quantity > 90 LIMIT 4 OFFSET 7"],
+    [FIXTURE_DB,        "SELECT id, region FROM orders WHERE region = 'region 1' AND note > 'note 4' LIMIT 3 OFFSET 20"],
+    ["companies.db",    "SELECT id, name FROM companies WHERE country = 'eritrea' LIMIT 5 OFFSET 2"],
+
+    # GROUP BY over whole tables, ordered by the keys
+    [FIXTURE_DB,        "SELECT region, count(*) FROM orders GROUP BY region ORDER BY region"],
+    [FIXTURE_DB,        "SELECT customer, count(*), sum(quantity) FROM orders GROUP BY customer ORDER BY customer"],
+    [FIXTURE_DB,        "SELECT region, customer, count(*) FROM orders GROUP BY region, customer ORDER BY region, customer"],
+    [FIXTURE_DB,        "SELECT price, count(*) FROM orders GROUP BY price ORDER BY price"],
+    [FIXTURE_DB,        "SELECT region, sum(quantity), avg(quantity), min(note), max(note), count(note) FROM orders GROUP BY region ORDER BY region"],
+    ["companies.db",    "SELECT country, count(*) FROM companies GROUP BY country ORDER BY country"],
 ]
 
+def build_fixture():
+    if os.path.exists(FIXTURE_DB):
+        os.remove(FIXTURE_DB)
+
+    subprocess.run(["sqlite3.exe", FIXTURE_DB], input = FIXTURE_SQL.encode(), check = True)
+
+
 def print_result(
         result_one: subprocess.CompletedProcess,
         result_two: subprocess.CompletedProcess,
         test_num: int,
+        exec_mode: str,
         db_name: str,
         query_string: str,
         our_engine_elapsed_time: float,
@@ -29,33 +123,36 @@ def print_result(
         ):
     
     if result_one.stdout == result_two.stdout:
-        print(f"{GREEN}Test {test_num} succeeded{RESET}. Time taken: {our_engine_elapsed_time:.4g}ms, SQLite time taken: {sqlite_elapsed_time:.4g}ms")
+        print(f"{GREEN}Test {test_num} {exec_mode} succeeded{RESET}. Time taken: {our_engine_elapsed_time:.4g}ms, SQLite time taken: {sqlite_elapsed_time:.4g}ms")
     else:
-        print(f"{RED}Test {test_num} failed{RESET}. DB Name: {db_name}, Query: {query_string}")
+        print(f"{RED}Test {test_num} {exec_mode} failed{RESET}. DB Name: {db_name}, Query: {query_string}")
 
 
 def run_tests():
-    print(f"Running {len(TEST_QUERIES)} tests")
+    print(f"Running {len(TEST_QUERIES)} tests, each with {' and '.join(EXEC_MODES)}")
     for test_num, (db_name, query) in enumerate(TEST_QUERIES, start = 1):
         sqlite_start_time = time.monotonic()
         sqlite = subprocess.run(["sqlite3.exe", db_name, query], capture_output = True)
         sqlite_end_time = time.monotonic()
 
-        our_engine_start_time = time.monotonic()
-        our_engine = subprocess.run(["sql.exe", db_name, query], capture_output = True)
-        our_engine_end_time = time.monotonic()
+        for exec_mode in EXEC_MODES:
+            our_engine_start_time = time.monotonic()
+            our_engine = subprocess.run(["sql.exe", exec_mode, db_name, query], capture_output = True)
+            our_engine_end_time = time.monotonic()
 
-        print_result(
-            sqlite,
-            our_engine,
-            test_num,
-            db_name,
-            query,
-            our_engine_end_time - our_engine_start_time,
-            sqlite_end_time - sqlite_start_time
-            )
+            print_result(
+                sqlite,
+                our_engine,
+                test_num,
+                exec_mode,
+                db_name,
+                query,
+                our_engine_end_time - our_engine_start_time,
+                sqlite_end_time - sqlite_start_time
+                )
 
 def main():
+    build_fixture()
     run_tests()
     return 0
 
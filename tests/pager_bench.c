@@ -0,0 +1,136 @@
+// Pager microbenchmark
+//
+// Measures get_page hit latency for growing cache sizes. Every page that fits in
+// the cache is loaded once, then random pages from that set are requested.
+// Use a database with at least 100k pages to see the largest cache size filled.
+//
+// Then runs a mixed workload for each replacement policy: lookups into a small hot
+// set of pages (standing in for B-tree interior pages) interleaved with sequential
+// scans larger than the cache, and reports the hit rate of the lookups.
+//
+// Build from the repository root:
+// gcc -O2 -Isrc tests/pager_bench.c src/pager.c src/replacement_policy.c src/utilities/page_table.c src/utilities/io_ring.c src/data_parsing/byte_reader.c src/data_parsing/page_parsing.c -o pager_bench.exe
+//
+// Run:
+// pager_bench.exe companies.db
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "bench.h"
+#include "pager.h"
+
+#define HIT_ITERATIONS (2000000)
+
+#define MIXED_CACHE_SIZE    (1024)
+#define MIXED_HOT_PAGES     (64)
+#define MIXED_LOOKUPS       (10000)
+#define MIXED_ROUNDS        (10)
+
+static const uint32_t CACHE_SIZES[] = { 16, 256, 4096, 65536, 100000 };
+
+static uint32_t next_random(uint32_t *state) {
+    // xorshift32
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static void bench_hits(const char *database_file_path, uint32_t cache_size) {
+    struct PagerConfig config = pager_default_config();
+    config.cache_capacity = cache_size;
+
+    struct Pager *pager = pager_open(database_file_path, &config);
+
+    uint32_t page_count = pager->page_count < cache_size ? pager->page_count : cache_size;
+
+    // Warm the cache with every page we are going to request
+    for (uint32_t page_number = 1; page_number <= page_count; page_number++) {
+        pager_release_page(get_page(pager, page_number));
+    }
+
+    uint32_t state = 2463534242u;
+    uint64_t checksum = 0;
+    struct timespec start, end;
+
+    timespec_get(&start, TIME_UTC);
+    for (uint32_t i = 0; i < HIT_ITERATIONS; i++) {
+        uint32_t page_number = 1 + next_random(&state) % page_count;
+        struct Page *page = get_page(pager, page_number);
+        checksum += page->data[0];
+        pager_release_page(page);
+    }
+    timespec_get(&end, TIME_UTC);
+
+    printf("cache size: %6u, cached pages: %6u, hit latency: %6.1f ns (checksum %llu)\n",
+        cache_size,
+        page_count,
+        elapsed_ns(&start, &end) / HIT_ITERATIONS,
+        (unsigned long long)checksum);
+
+    pager_close(pager);
+    free(pager);
+}
+
+static void bench_mixed(const char *database_file_path, enum ReplacementPolicyType policy) {
+    struct PagerConfig config = pager_default_config();
+    config.cache_capacity   = MIXED_CACHE_SIZE;
+    config.policy           = policy;
+
+    struct Pager *pager = pager_open(database_file_path, &config);
+
+    uint32_t scan_pages = pager->page_count < MIXED_CACHE_SIZE * 4 ? pager->page_count : MIXED_CACHE_SIZE * 4;
+    uint32_t hot_stride = pager->page_count / MIXED_HOT_PAGES > 0 ? pager->page_count / MIXED_HOT_PAGES : 1;
+
+    uint32_t state = 2463534242u;
+    uint64_t lookup_hits = 0;
+    uint64_t lookup_misses = 0;
+
+    for (uint32_t round = 0; round < MIXED_ROUNDS; round++) {
+        struct PolicyStats before = pager_stats(pager);
+
+        for (uint32_t i = 0; i < MIXED_LOOKUPS; i++) {
+            uint32_t page_number = 1 + (next_random(&state) % MIXED_HOT_PAGES) * hot_stride;
+            pager_release_page(get_page(pager, page_number));
+        }
+
+        struct PolicyStats after = pager_stats(pager);
+        lookup_hits     += after.hits - before.hits;
+        lookup_misses   += after.misses - before.misses;
+
+        for (uint32_t page_number = 1; page_number <= scan_pages; page_number++) {
+            pager_release_page(get_page(pager, page_number));
+        }
+    }
+
+    printf("policy: %-5s, lookup hits: %8llu, lookup misses: %6llu, lookup hit rate: %6.2f%%\n",
+        pager->partitions[0].replacement.policy->name,
+        (unsigned long long)lookup_hits,
+        (unsigned long long)lookup_misses,
+        100.0 * (double)lookup_hits / (double)(lookup_hits + lookup_misses));
+
+    pager_close(pager);
+    free(pager);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: pager_bench.exe <database path>\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < sizeof(CACHE_SIZES) / sizeof(CACHE_SIZES[0]); i++) {
+        bench_hits(argv[1], CACHE_SIZES[i]);
+    }
+
+    bench_mixed(argv[1], POLICY_LRU);
+    bench_mixed(argv[1], POLICY_CLOCK);
+    bench_mixed(argv[1], POLICY_2Q);
+
+    return 0;
+}
@@ -0,0 +1,249 @@
+// Concurrent pager stress test and throughput benchmark
+//
+// The stress test shares one small cache between several threads that request random
+// pages, keeping a parent page pinned while reading a child like a tree walk does. Every
+// page handed out is checked against a checksum taken with a plain read of the file,
+// so a page evicted or overwritten while pinned shows up as a mismatch.
+//
+// The benchmark then measures get_page hit throughput for a growing number of threads
+// sharing a cache that holds the whole working set.
+//
+// Build from the repository root:
+// gcc -O2 -Isrc tests/pager_threads.c src/pager.c src/replacement_policy.c src/utilities/page_table.c src/utilities/io_ring.c src/data_parsing/byte_reader.c src/data_parsing/page_parsing.c -o pager_threads.exe
+//
+// Run:
+// pager_threads.exe companies.db
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <threads.h>
+#include <time.h>
+
+#include "bench.h"
+#include "pager.h"
+
+#define STRESS_THREADS          (8)
+#define STRESS_LOOKUPS          (50000)
+#define STRESS_CACHE_SIZE       (256)
+#define STRESS_PREFETCH_EVERY   (64)
+
+#define BENCH_LOOKUPS           (2000000)
+#define BENCH_WORKING_SET       (4096)
+#define BENCH_MAX_THREADS       (16)
+
+struct StressWorker {
+    struct Pager        *pager;
+    const uint64_t      *checksums;
+    uint32_t            seed;
+    atomic_uint_least64_t *mismatches;
+};
+
+struct BenchWorker {
+    struct Pager    *pager;
+    uint32_t        page_count;
+    uint32_t        seed;
+    uint64_t        checksum;
+};
+
+static uint32_t next_random(uint32_t *state) {
+    // xorshift32
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+static uint64_t page_checksum(const uint8_t *data, uint32_t page_size) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t i = 0; i < page_size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static uint64_t *read_checksums(const char *database_file_path, uint32_t page_size, uint32_t page_count) {
+    FILE *file = fopen(database_file_path, "rb");
+    uint64_t *checksums = malloc(page_count * sizeof(uint64_t));
+    uint8_t *buffer = malloc(page_size);
+
+    if (!file || !checksums || !buffer) {
+        fprintf(stderr, "read_checksums: failed to open %s\n", database_file_path);
+        exit(1);
+    }
+
+    for (uint32_t i = 0; i < page_count; i++) {
+        if (fread(buffer, 1, page_size, file) != page_size) {
+            fprintf(stderr, "read_checksums: fread of page %u failed\n", i + 1);
+            exit(1);
+        }
+        checksums[i] = page_checksum(buffer, page_size);
+    }
+
+    free(buffer);
+    fclose(file);
+    return checksums;
+}
+
+static int stress_worker(void *arg) {
+    struct StressWorker *worker = arg;
+    struct Pager *pager = worker->pager;
+    uint32_t state = worker->seed;
+
+    for (uint32_t i = 0; i < STRESS_LOOKUPS; i++) {
+        uint32_t parent_number = 1 + next_random(&state) % pager->page_count;
+        uint32_t child_number = 1 + next_random(&state) % pager->page_count;
+
+        if (i % STRESS_PREFETCH_EVERY == 0) {
+            uint32_t ahead[4] = { child_number, child_number % pager->page_count + 1, parent_number, 1 };
+            pager_prefetch_pages(pager, ahead, 4);
+        }
+
+        struct Page *parent = get_page(pager, parent_number);
+        struct Page *child = get_page(pager, child_number);
+
+        if (parent->page_no != parent_number || page_checksum(parent->data, pager->page_size) != worker->checksums[parent_number - 1]) {
+            atomic_fetch_add(worker->mismatches, 1);
+        }
+
+        if (child->page_no != child_number || page_checksum(child->data, pager->page_size) != worker->checksums[child_number - 1]) {
+            atomic_fetch_add(worker->mismatches, 1);
+        }
+
+        pager_release_page(child);
+        pager_release_page(parent);
+    }
+
+    return 0;
+}
+
+static bool run_stress(const char *database_file_path, enum PagerIo io, enum ReplacementPolicyType policy) {
+    struct PagerConfig config = pager_default_config();
+    config.cache_capacity   = STRESS_CACHE_SIZE;
+    config.io               = io;
+    config.policy           = policy;
+
+    struct Pager *pager = pager_open(database_file_path, &config);
+    uint64_t *checksums = read_checksums(database_file_path, pager->page_size, pager->page_count);
+
+    atomic_uint_least64_t mismatches;
+    atomic_init(&mismatches, 0);
+
+    thrd_t threads[STRESS_THREADS];
+    struct StressWorker workers[STRESS_THREADS];
+
+    for (uint32_t i = 0; i < STRESS_THREADS; i++) {
+        workers[i] = (struct StressWorker){ .pager = pager, .checksums = checksums, .seed = 2463534242u + i * 7919u, .mismatches = &mismatches };
+        if (thrd_create(&threads[i], stress_worker, &workers[i]) != thrd_success) {
+            fprintf(stderr, "run_stress: thrd_create failed\n");
+            exit(1);
+        }
+    }
+
+    for (uint32_t i = 0; i < STRESS_THREADS; i++) {
+        thrd_join(threads[i], NULL);
+    }
+
+    struct PolicyStats stats = pager_stats(pager);
+    uint64_t mismatch_count = atomic_load(&mismatches);
+
+    printf("stress: %s, %s, %u threads, %u partitions, %llu requests, %llu evictions, %llu mismatches\n",
+        pager->async_io ? "io_uring" : "sync",
+        pager->partitions[0].replacement.policy->name,
+        STRESS_THREADS,
+        pager->partition_count,
+        (unsigned long long)(stats.hits + stats.misses),
+        (unsigned long long)stats.evictions,
+        (unsigned long long)mismatch_count);
+
+    free(checksums);
+    pager_close(pager);
+    free(pager);
+
+    return mismatch_count == 0;
+}
+
+static int bench_worker(void *arg) {
+    struct BenchWorker *worker = arg;
+    uint32_t state = worker->seed;
+
+    for (uint32_t i = 0; i < BENCH_LOOKUPS; i++) {
+        struct Page *page = get_page(worker->pager, 1 + next_random(&state) % worker->page_count);
+        worker->checksum += page->data[0];
+        pager_release_page(page);
+    }
+
+    return 0;
+}
+
+static void bench_threads(const char *database_file_path, uint32_t thread_count) {
+    struct PagerConfig config = pager_default_config();
+    config.cache_capacity = BENCH_WORKING_SET;
+
+    struct Pager *pager = pager_open(database_file_path, &config);
+    uint32_t page_count = pager->page_count < BENCH_WORKING_SET ? pager->page_count : BENCH_WORKING_SET;
+
+    // Warm the cache so every request is a hit
+    for (uint32_t page_number = 1; page_number <= page_count; page_number++) {
+        pager_release_page(get_page(pager, page_number));
+    }
+
+    thrd_t threads[BENCH_MAX_THREADS];
+    struct BenchWorker workers[BENCH_MAX_THREADS];
+    struct timespec start, end;
+
+    timespec_get(&start, TIME_UTC);
+    for (uint32_t i = 0; i < thread_count; i++) {
+        workers[i] = (struct BenchWorker){ .pager = pager, .page_count = page_count, .seed = 2463534242u + i * 7919u, .checksum = 0 };
+        if (thrd_create(&threads[i], bench_worker, &workers[i]) != thrd_success) {
+            fprintf(stderr, "bench_threads: thrd_create failed\n");
+            exit(1);
+        }
+    }
+
+    uint64_t checksum = 0;
+    for (uint32_t i = 0; i < thread_count; i++) {
+        thrd_join(threads[i], NULL);
+        checksum += workers[i].checksum;
+    }
+    timespec_get(&end, TIME_UTC);
+
+    double lookups = (double)BENCH_LOOKUPS * thread_count;
+    printf("threads: %2u, partitions: %2u, throughput: %7.2f M lookups/s (checksum %llu)\n",
+        thread_count,
+        pager->partition_count,
+        lookups / elapsed_ns(&start, &end) * 1e3,
+        (unsigned long long)checksum);
+
+    pager_close(pager);
+    free(pager);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: pager_threads.exe <database path>\n");
+        return 1;
+    }
+
+    bool passed = true;
+    passed &= run_stress(argv[1], PAGER_IO_SYNC, POLICY_LRU);
+    passed &= run_stress(argv[1], PAGER_IO_SYNC, POLICY_CLOCK);
+    passed &= run_stress(argv[1], PAGER_IO_SYNC, POLICY_2Q);
+    passed &= run_stress(argv[1], PAGER_IO_URING, POLICY_LRU);
+
+    if (!passed) {
+        fprintf(stderr, "Stress test failed, pages changed while pinned\n");
+        return 1;
+    }
+
+    for (uint32_t thread_count = 1; thread_count <= BENCH_MAX_THREADS; thread_count *= 2) {
+        bench_threads(argv[1], thread_count);
+    }
+
+    return 0;
+}
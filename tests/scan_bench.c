@@ -0,0 +1,149 @@
+// Full table scan benchmark, reports the cost of producing one row
+//
+// Both scans move a BTreeCursor over the table. The first decodes every row the way rows
+// were decoded before the cursor, through a freshly allocated struct Record, and frees it
+// again. The second decodes into a reused RowBuffer the way table scans do now, so apart
+// from the buffer growing on the first rows it does not allocate. The third passes a column
+// mask holding only the first column, every other column is skipped without decoding.
+//
+// Build from the repository root:
+// gcc -O2 -Isrc tests/scan_bench.c src/btree_cursor.c src/comparisons.c src/common.c src/pager.c src/replacement_policy.c src/utilities/page_table.c src/utilities/io_ring.c src/data_parsing/*.c -o scan_bench.exe
+//
+// Run with the root page and column count of a table, e.g. from SELECT rootpage FROM sqlite_master:
+// scan_bench.exe big.db 2 3
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "bench.h"
+#include "pager.h"
+#include "btree_cursor.h"
+#include "data_parsing/record_parsing.h"
+#include "data_parsing/row_parsing.h"
+
+#define BENCH_PASSES (3)
+
+static uint64_t row_checksum(struct Row *row) {
+    uint64_t checksum = row->rowid;
+    for (uint64_t i = 0; i < row->column_count; i++) {
+        checksum += row->values[i].type == VALUE_TEXT ? row->values[i].text_value.text.len : (uint64_t)row->values[i].int_value.value;
+    }
+    return checksum;
+}
+
+static void bench_record_scan(struct Pager *pager, uint32_t root_page) {
+    struct BTreeCursor cursor;
+    btree_cursor_init(&cursor, pager, root_page);
+    cursor.readahead = true;
+
+    uint64_t rows = 0;
+    uint64_t checksum = 0;
+    struct timespec start, end;
+
+    timespec_get(&start, TIME_UTC);
+    for (bool found = btree_cursor_first(&cursor); found; found = btree_cursor_next(&cursor)) {
+        struct Cell cell;
+        struct Record record;
+        struct Row row;
+        struct PageHeader *header = &cursor.frames[cursor.depth - 1].view.header;
+
+        read_cell_and_record(pager, header, &cell, cursor.cell.cell_offset, &record);
+        read_row_from_record(&record, &row, &cell);
+        checksum += row_checksum(&row);
+        free_row(&row);
+        free_record(&record);
+        rows++;
+    }
+    timespec_get(&end, TIME_UTC);
+
+    printf("record per row:     %llu rows, %7.1f ns/row (checksum %llu)\n",
+        (unsigned long long)rows, elapsed_ns(&start, &end) / (double)rows, (unsigned long long)checksum);
+
+    btree_cursor_close(&cursor);
+}
+
+static void bench_row_buffer_scan(struct Pager *pager, uint32_t root_page) {
+    struct BTreeCursor cursor;
+    struct RowBuffer buffer;
+    btree_cursor_init(&cursor, pager, root_page);
+    row_buffer_init(&buffer);
+    cursor.readahead = true;
+
+    uint64_t rows = 0;
+    uint64_t checksum = 0;
+    struct timespec start, end;
+
+    timespec_get(&start, TIME_UTC);
+    for (bool found = btree_cursor_first(&cursor); found; found = btree_cursor_next(&cursor)) {
+        struct Row row;
+        btree_cursor_read_row(&cursor, &buffer, NULL, &row);
+        checksum += row_checksum(&row);
+        rows++;
+    }
+    timespec_get(&end, TIME_UTC);
+
+    printf("reused row buffer:  %llu rows, %7.1f ns/row (checksum %llu)\n",
+        (unsigned long long)rows, elapsed_ns(&start, &end) / (double)rows, (unsigned long long)checksum);
+
+    row_buffer_free(&buffer);
+    btree_cursor_close(&cursor);
+}
+
+static void bench_masked_scan(struct Pager *pager, uint32_t root_page, uint64_t column_count) {
+    // Decodes only the first column, the way a scan does when the query reads one column
+    struct BTreeCursor cursor;
+    struct RowBuffer buffer;
+    struct ColumnMask mask;
+    btree_cursor_init(&cursor, pager, root_page);
+    row_buffer_init(&buffer);
+    column_mask_init(&mask, column_count);
+    column_mask_set(&mask, 0);
+    cursor.readahead = true;
+
+    uint64_t rows = 0;
+    uint64_t checksum = 0;
+    struct timespec start, end;
+
+    timespec_get(&start, TIME_UTC);
+    for (bool found = btree_cursor_first(&cursor); found; found = btree_cursor_next(&cursor)) {
+        struct Row row;
+        btree_cursor_read_row(&cursor, &buffer, &mask, &row);
+        checksum += row_checksum(&row);
+        rows++;
+    }
+    timespec_get(&end, TIME_UTC);
+
+    printf("first column only:  %llu rows, %7.1f ns/row (checksum %llu)\n",
+        (unsigned long long)rows, elapsed_ns(&start, &end) / (double)rows, (unsigned long long)checksum);
+
+    column_mask_free(&mask);
+    row_buffer_free(&buffer);
+    btree_cursor_close(&cursor);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 4) {
+        fprintf(stderr, "Usage: scan_bench.exe <database path> <table root page> <table column count>\n");
+        return 1;
+    }
+
+    // Large enough to hold the whole table, so the passes after the first measure the scan and not the disk
+    struct PagerConfig config = pager_default_config();
+    config.cache_capacity = 1 << 17;
+
+    struct Pager *pager = pager_open(argv[1], &config);
+    uint32_t root_page = (uint32_t)strtoul(argv[2], NULL, 10);
+    uint64_t column_count = strtoull(argv[3], NULL, 10);
+
+    for (int pass = 0; pass < BENCH_PASSES; pass++) {
+        bench_record_scan(pager, root_page);
+        bench_row_buffer_scan(pager, root_page);
+        bench_masked_scan(pager, root_page, column_count);
+    }
+
+    pager_close(pager);
+    free(pager);
+    return 0;
+}
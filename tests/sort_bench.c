@@ -0,0 +1,94 @@
+// ORDER BY benchmark, reports rows per second for one query at several sort memory budgets
+//
+// The query is run once with the default budget, where a table of a few hundred MiB sorts
+// in memory, and once per smaller budget, where the sort spills runs to temporary files
+// and merges them. Rows are hashed in the order they come out, every budget has to give
+// the same hash.
+//
+// Build from the repository root:
+// gcc -O2 -Isrc tests/sort_bench.c $(ls src/*.c | grep -v main.c) src/data_parsing/*.c src/planning/*.c src/utilities/*.c -o sort_bench.exe
+//
+// Run:
+// sort_bench.exe big.db "SELECT id, b FROM t ORDER BY b, id" 1 8
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "bench.h"
+#include "pager.h"
+#include "parser.h"
+#include "lexer.h"
+#include "planning/plan.h"
+#include "planning/column_batch.h"
+
+static uint64_t bench_sort(struct Pager *pager, const char *query, size_t sort_memory, const char *name) {
+    struct Parser parser;
+    parser_init(&parser, DEFAULT_ARENA_CAPACITY);
+
+    struct SelectStatement *stmt = parse(&parser, query, init_reserved_words());
+    struct PlanConfig config = plan_default_config();
+    config.sort_memory = sort_memory;
+
+    struct Plan *plan = build_plan(pager, stmt, &config);
+    struct ColumnBatch *batch;
+    struct Value value;
+    uint64_t rows = 0;
+    uint64_t hash = BENCH_HASH_SEED;
+    struct timespec start, end;
+
+    timespec_get(&start, TIME_UTC);
+    while (plan_next_batch(pager, plan, &batch)) {
+        for (uint32_t i = 0; i < batch->selected_count; i++) {
+            for (uint32_t c = 0; c < batch->column_count; c++) {
+                column_batch_get_value(batch, c, batch->selection[i], &value);
+                hash = hash_value(hash, &value);
+            }
+        }
+        rows += batch->selected_count;
+    }
+    timespec_get(&end, TIME_UTC);
+
+    double seconds = elapsed_ns(&start, &end) / 1e9;
+    printf("%-10s %10llu rows, %12.0f rows/s (%.3f s), hash %016llx\n",
+        name, (unsigned long long)rows, (double)rows / seconds, seconds, (unsigned long long)hash);
+    return hash;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: sort_bench.exe <database path> <query> [budget MiB]...\n");
+        return 1;
+    }
+
+    // Large enough to hold the whole table, so the sort is measured and not the disk
+    struct PagerConfig config = pager_default_config();
+    config.cache_capacity = 1 << 17;
+
+    struct Pager *pager = pager_open(argv[1], &config);
+
+    // A first run warms the page cache
+    bench_sort(pager, argv[2], DEFAULT_SORT_MEMORY, "warm up");
+    uint64_t expected = bench_sort(pager, argv[2], DEFAULT_SORT_MEMORY, "default");
+
+    for (int arg = 3; arg < argc; arg++) {
+        size_t megabytes = strtoul(argv[arg], NULL, 10);
+        if (megabytes == 0) {
+            fprintf(stderr, "Invalid budget %s, expected a size in MiB\n", argv[arg]);
+            return 1;
+        }
+
+        char name[32];
+        snprintf(name, sizeof name, "%zu MiB", megabytes);
+
+        if (bench_sort(pager, argv[2], megabytes * 1024 * 1024, name) != expected) {
+            fprintf(stderr, "A %zu MiB budget sorts differently from the default\n", megabytes);
+            return 1;
+        }
+    }
+
+    pager_close(pager);
+    free(pager);
+    return 0;
+}
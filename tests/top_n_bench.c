@@ -0,0 +1,89 @@
+// Top-N benchmark, compares ORDER BY ... LIMIT against a full sort of the same query
+//
+// The query, which has to end in its ORDER BY, is run as it is through the sort and with
+// LIMIT n OFFSET m appended through the top-n heap. The rows the heap gives have to be
+// rows m to m + n of the sorted ones, in the same order.
+//
+// Build from the repository root:
+// gcc -O2 -Isrc tests/top_n_bench.c $(ls src/*.c | grep -v main.c) src/data_parsing/*.c src/planning/*.c src/utilities/*.c -o top_n_bench.exe
+//
+// Run:
+// top_n_bench.exe big.db "SELECT id, a FROM t ORDER BY a DESC" 10 0
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "bench.h"
+#include "pager.h"
+#include "parser.h"
+#include "lexer.h"
+#include "planning/plan.h"
+#include "planning/column_batch.h"
+
+static uint64_t run_query(struct Pager *pager, const char *query, uint64_t first, uint64_t count, const char *name) {
+    // Hashes rows first to first + count of the query's output
+    struct Parser parser;
+    parser_init(&parser, DEFAULT_ARENA_CAPACITY);
+
+    struct SelectStatement *stmt = parse(&parser, query, init_reserved_words());
+    struct PlanConfig config = plan_default_config();
+    struct Plan *plan = build_plan(pager, stmt, &config);
+    struct ColumnBatch *batch;
+    struct Value value;
+    uint64_t row = 0;
+    uint64_t hash = BENCH_HASH_SEED;
+    struct timespec start, end;
+
+    timespec_get(&start, TIME_UTC);
+    while (plan_next_batch(pager, plan, &batch)) {
+        for (uint32_t i = 0; i < batch->selected_count; i++, row++) {
+            if (row < first || row - first >= count) {
+                continue;
+            }
+
+            for (uint32_t c = 0; c < batch->column_count; c++) {
+                column_batch_get_value(batch, c, batch->selection[i], &value);
+                hash = hash_value(hash, &value);
+            }
+        }
+    }
+    timespec_get(&end, TIME_UTC);
+
+    printf("%-6s %10llu rows out, %.3f s, hash %016llx\n",
+        name, (unsigned long long)row, elapsed_ns(&start, &end) / 1e9, (unsigned long long)hash);
+    return hash;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 5) {
+        fprintf(stderr, "Usage: top_n_bench.exe <database path> <query with ORDER BY> <limit> <offset>\n");
+        return 1;
+    }
+
+    uint64_t limit = strtoull(argv[3], NULL, 10);
+    uint64_t offset = strtoull(argv[4], NULL, 10);
+
+    char limited[4096];
+    snprintf(limited, sizeof limited, "%s LIMIT %llu OFFSET %llu", argv[2], (unsigned long long)limit, (unsigned long long)offset);
+
+    // Large enough to hold the whole table, so the passes after the first measure execution and not the disk
+    struct PagerConfig config = pager_default_config();
+    config.cache_capacity = 1 << 17;
+
+    struct Pager *pager = pager_open(argv[1], &config);
+
+    run_query(pager, argv[2], offset, limit, "warm");
+    uint64_t sorted = run_query(pager, argv[2], offset, limit, "sort");
+    uint64_t top_n = run_query(pager, limited, 0, UINT64_MAX, "top n");
+
+    if (sorted != top_n) {
+        fprintf(stderr, "The top-n heap and the sort disagree\n");
+        return 1;
+    }
+
+    pager_close(pager);
+    free(pager);
+    return 0;
+}